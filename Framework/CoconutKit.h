@@ -17,7 +17,10 @@
 #import "HLSContainerStack.h"
 #import "HLSCoreError.h"
 #import "HLSCursor.h"
+#import "HLSDeduplicatingFileManager.h"
+#import "HLSDigest.h"
 #import "HLSFakeConnection.h"
+#import "HLSFileItem.h"
 #import "HLSFileManager.h"
 #import "HLSFileURLConnection.h"
 #import "HLSGeometry.h"
@@ -27,6 +30,8 @@
 #import "HLSLayerAnimation.h"
 #import "HLSLayerAnimationStep.h"
 #import "HLSLogger.h"
+#import "HLSLoggerDecoder.h"
+#import "HLSLoggerFileReader.h"
 #import "HLSManagedObjectCopying.h"
 #import "HLSModelManager.h"
 #import "HLSNibView.h"
@@ -46,6 +51,8 @@
 #import "HLSSubtitleTableViewCell.h"
 #import "HLSTableViewCell.h"
 #import "HLSTableViewController.h"
+#import "HLSTieredFileManager.h"
+#import "HLSTracing.h"
 #import "HLSTransformer.h"
 #import "HLSTransition.h"
 #import "HLSURLConnection.h"
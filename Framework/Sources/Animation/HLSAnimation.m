@@ -10,6 +10,7 @@
 #import "HLSAssert.h"
 #import "HLSLayerAnimationStep.h"
 #import "HLSLogger.h"
+#import "HLSTracing.h"
 #import "HLSTransformer.h"
 #import "HLSUserInterfaceLock.h"
 #import "HLSMAZeroingWeakRef.h"
@@ -284,6 +285,8 @@ static NSMutableArray *s_backgroundAnimations = nil;
 
 - (void)playAnimationStep:(HLSAnimationStep *)animationStep animated:(BOOL)animated
 {
+    HLSTraceAsyncBegin("HLSAnimationStep", animationStep);
+    
     // Instantaneously play all animation steps which complete before the start time. The value of _remainingTimeBeforeStart
     // is updated before the animation is played (so that it can be used as a criterium to guess whether we are playing
     // animation steps instantaneously to reach the start time)
@@ -496,6 +499,8 @@ static NSMutableArray *s_backgroundAnimations = nil;
 
 - (void)animationStepDidStop:(HLSAnimationStep *)animationStep animated:(BOOL)animated finished:(BOOL)finished
 {
+    HLSTraceAsyncEnd("HLSAnimationStep", animationStep);
+    
     // Still send all delegate notifications if terminating and if not playing animation steps instantaneously
     // when a start time has been set
     if (! self.cancelling && _remainingTimeBeforeStart == 0.) {
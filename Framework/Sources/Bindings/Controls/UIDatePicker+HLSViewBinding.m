@@ -26,10 +26,10 @@ static void swizzle_setDate_animated(UIDatePicker *self, SEL _cmd, NSDate *date,
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
-    HLSSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
-    HLSSwizzleSelector(self, @selector(setDate:), swizzle_setDate, &s_setDate);
-    HLSSwizzleSelector(self, @selector(setDate:animated:), swizzle_setDate_animated, &s_setDate_animated);
+    HLSRegisterSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
+    HLSRegisterSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
+    HLSRegisterSwizzleSelector(self, @selector(setDate:), swizzle_setDate, &s_setDate);
+    HLSRegisterSwizzleSelector(self, @selector(setDate:animated:), swizzle_setDate_animated, &s_setDate_animated);
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
@@ -6,10 +6,7 @@
 
 #import "UILabel+HLSViewBinding.h"
 
-#import <objc/runtime.h>
-
-// Associated object keys
-static void *s_bindPlaceholderKey = &s_bindPlaceholderKey;
+#import "HLSObjectState.h"
 
 @implementation UILabel (HLSViewBindingImplementation)
 
@@ -17,12 +14,12 @@ static void *s_bindPlaceholderKey = &s_bindPlaceholderKey;
 
 - (NSString *)bindPlaceholder
 {
-    return objc_getAssociatedObject(self, s_bindPlaceholderKey);
+    return HLSObjectStateForObject(self).bindPlaceholder;
 }
 
 - (void)setBindPlaceholder:(NSString *)bindPlaceholder
 {
-    objc_setAssociatedObject(self, s_bindPlaceholderKey, bindPlaceholder, OBJC_ASSOCIATION_COPY);
+    HLSObjectStateCreateForObject(self).bindPlaceholder = bindPlaceholder;
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
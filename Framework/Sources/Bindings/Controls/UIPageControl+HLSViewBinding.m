@@ -24,9 +24,9 @@ static void swizzle_setCurrentPage(UIPageControl *self, SEL _cmd, NSInteger curr
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
-    HLSSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
-    HLSSwizzleSelector(self, @selector(setCurrentPage:), swizzle_setCurrentPage, &s_setCurrentPage);
+    HLSRegisterSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
+    HLSRegisterSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
+    HLSRegisterSwizzleSelector(self, @selector(setCurrentPage:), swizzle_setCurrentPage, &s_setCurrentPage);
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
@@ -21,7 +21,7 @@ static void swizzle_setValue_animated(UISlider *self, SEL _cmd, float value, BOO
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(setValue:animated:), swizzle_setValue_animated, &s_setValue_animated);
+    HLSRegisterSwizzleSelector(self, @selector(setValue:animated:), swizzle_setValue_animated, &s_setValue_animated);
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
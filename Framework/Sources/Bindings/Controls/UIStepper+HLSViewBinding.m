@@ -20,7 +20,7 @@ static void swizzle_setValue(UIStepper *self, SEL _cmd, double value);
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(setValue:), swizzle_setValue, &s_setValue);
+    HLSRegisterSwizzleSelector(self, @selector(setValue:), swizzle_setValue, &s_setValue);
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
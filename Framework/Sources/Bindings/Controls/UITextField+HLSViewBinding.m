@@ -28,15 +28,15 @@ static void swizzle_didMoveToWindow(UITextField *self, SEL _cmd);
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
-    HLSSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
-    HLSSwizzleSelector(self, sel_getUid("dealloc"), swizzle_dealloc, &s_dealloc);
-    HLSSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
+    HLSRegisterSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
+    HLSRegisterSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
+    HLSRegisterSwizzleSelector(self, sel_getUid("dealloc"), swizzle_dealloc, &s_dealloc);
+    HLSRegisterSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
     
     // iOS 12: UITextField now implements -didMoveToWindow, without calling the parent implementation. Swizzle to fix
     // so that bindings at the UIView level can work.
     if (@available(iOS 12, *)) {
-        HLSSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
+        HLSRegisterSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
     }
 }
 
@@ -26,10 +26,10 @@ static void swizzle_setText(UITextField *self, SEL _cmd, NSString *text);
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
-    HLSSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
-    HLSSwizzleSelector(self, sel_getUid("dealloc"), swizzle_dealloc, &s_dealloc);
-    HLSSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
+    HLSRegisterSwizzleSelector(self, @selector(initWithFrame:), swizzle_initWithFrame, &s_initWithFrame);
+    HLSRegisterSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
+    HLSRegisterSwizzleSelector(self, sel_getUid("dealloc"), swizzle_dealloc, &s_dealloc);
+    HLSRegisterSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
 }
 
 #pragma mark HLSViewBindingImplementation protocol implementation
@@ -10,6 +10,7 @@
 #import "HLSLogger.h"
 #import "HLSMAKVONotificationCenter.h"
 #import "HLSRuntime.h"
+#import "HLSTracing.h"
 #import "HLSTransformer.h"
 #import "HLSViewBindingError.h"
 #import "NSArray+HLSExtensions.h"
@@ -193,6 +194,8 @@ typedef NS_OPTIONS(NSInteger, HLSViewBindingStatus) {
         return;
     }
     
+    HLSTraceInterval("HLSViewBindingInformation.updateView");
+    
     // Lazily check and fill binding information
     [self verify];
     
@@ -329,6 +332,8 @@ typedef NS_OPTIONS(NSInteger, HLSViewBindingStatus) {
         return YES;
     }
     
+    HLSTraceInterval("HLSViewBindingInformation.updateModel");
+    
     @try {
         self.updatingModel = YES;
         
@@ -7,6 +7,7 @@
 #import "UIView+HLSViewBinding.h"
 
 #import "HLSLogger.h"
+#import "HLSObjectState.h"
 #import "HLSRuntime.h"
 #import "HLSViewBindingDebugOverlayViewController.h"
 #import "HLSViewBindingInformation.h"
@@ -14,13 +15,6 @@
 #import "NSError+HLSExtensions.h"
 #import "UIView+HLSExtensions.h"
 
-// Keys for associated objects
-static void *s_bindKeyPath = &s_bindKeyPath;
-static void *s_bindTransformerKey = &s_bindTransformerKey;
-static void *s_bindUpdateAnimatedKey = &s_bindUpdateAnimatedKey;
-static void *s_bindInputCheckedKey = &s_bindInputCheckedKey;
-static void *s_bindingInformationKey = &s_bindingInformationKey;
-
 // Original implementation of the methods we swizzle
 static void (*s_didMoveToWindow)(id, SEL) = NULL;
 
@@ -45,7 +39,7 @@ static void swizzle_didMoveToWindow(UIView *self, SEL _cmd);
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
+    HLSRegisterSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
 }
 
 + (void)showBindingsDebugOverlay
@@ -57,22 +51,22 @@ static void swizzle_didMoveToWindow(UIView *self, SEL _cmd);
 
 - (BOOL)isBindUpdateAnimated
 {
-    return [hls_getAssociatedObject(self, s_bindUpdateAnimatedKey) boolValue];
+    return HLSObjectStateForObject(self).bindUpdateAnimated;
 }
 
 - (void)setBindUpdateAnimated:(BOOL)bindUpdateAnimated
 {
-    hls_setAssociatedObject(self, s_bindUpdateAnimatedKey, @(bindUpdateAnimated), HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).bindUpdateAnimated = bindUpdateAnimated;
 }
 
 - (BOOL)isBindInputChecked
 {
-    return [hls_getAssociatedObject(self, s_bindInputCheckedKey) boolValue];
+    return HLSObjectStateForObject(self).bindInputChecked;
 }
 
 - (void)setBindInputChecked:(BOOL)bindInputChecked
 {
-    hls_setAssociatedObject(self, s_bindInputCheckedKey, @(bindInputChecked), HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).bindInputChecked = bindInputChecked;
 }
 
 - (BOOL)isBindingSupported
@@ -105,32 +99,32 @@ static void swizzle_didMoveToWindow(UIView *self, SEL _cmd);
 
 - (NSString *)bindKeyPath
 {
-    return hls_getAssociatedObject(self, s_bindKeyPath);
+    return HLSObjectStateForObject(self).bindKeyPath;
 }
 
 - (void)setBindKeyPath:(NSString *)bindKeyPath
 {
-    hls_setAssociatedObject(self, s_bindKeyPath, bindKeyPath, HLS_ASSOCIATION_COPY_NONATOMIC);
+    HLSObjectStateCreateForObject(self).bindKeyPath = bindKeyPath;
 }
 
 - (NSString *)bindTransformer
 {
-    return hls_getAssociatedObject(self, s_bindTransformerKey);
+    return HLSObjectStateForObject(self).bindTransformer;
 }
 
 - (void)setBindTransformer:(NSString *)bindTransformer
 {
-    hls_setAssociatedObject(self, s_bindTransformerKey, bindTransformer, HLS_ASSOCIATION_COPY_NONATOMIC);
+    HLSObjectStateCreateForObject(self).bindTransformer = bindTransformer;
 }
 
 - (HLSViewBindingInformation *)bindingInformation
 {
-    return hls_getAssociatedObject(self, s_bindingInformationKey);
+    return HLSObjectStateForObject(self).bindingInformation;
 }
 
 - (void)setBindingInformation:(HLSViewBindingInformation *)bindingInformation
 {
-    hls_setAssociatedObject(self, s_bindingInformationKey, bindingInformation, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).bindingInformation = bindingInformation;
 }
 
 #pragma mark Bindings
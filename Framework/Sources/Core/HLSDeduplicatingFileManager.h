@@ -0,0 +1,61 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManager.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A file manager storing file contents by content, so that identical contents written under several paths are stored
+ * only once:
+ *   - File contents (blobs) are stored in a blob file manager (usually an HLSStandardFileManager or an
+ *     HLSInMemoryFileManager), under a name derived from their SHA-256 digest. Blobs are reference-counted and
+ *     removed when no file references them anymore
+ *   - The directory hierarchy and the digest of each file are kept in an index, which is loaded when the file manager
+ *     is created and saved to the blob file manager asynchronously after each change. Call -synchronize to save it
+ *     immediately
+ *
+ * Copying a file or a directory only updates the index and never copies any data, whatever the size of the files
+ * involved
+ *
+ * The blob file manager must be dedicated to a single deduplicating file manager and must not be altered directly.
+ * The file manager can be safely used from several threads at the same time
+ */
+@interface HLSDeduplicatingFileManager : HLSFileManager
+
+/**
+ * Create a deduplicating file manager storing its data in the specified file manager. If the blob file manager
+ * already contains data saved by a deduplicating file manager, this data is restored
+ */
+- (instancetype)initWithBlobFileManager:(HLSFileManager *)blobFileManager NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The file manager in which blobs are stored
+ */
+@property (nonatomic, readonly) HLSFileManager *blobFileManager;
+
+/**
+ * The number of distinct blobs currently stored, and the number of bytes they occupy
+ */
+@property (nonatomic, readonly) NSUInteger blobCount;
+@property (nonatomic, readonly) unsigned long long blobByteCount;
+
+/**
+ * Synchronously save the index to the blob file manager
+ */
+- (void)synchronize;
+
+@end
+
+@interface HLSDeduplicatingFileManager (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
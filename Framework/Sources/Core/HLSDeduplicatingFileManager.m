@@ -0,0 +1,797 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSDeduplicatingFileManager.h"
+
+#import "HLSInMemoryFlatStorage.h"
+#import "HLSInMemoryOutputStream.h"
+#import "HLSLogger.h"
+#import "HLSRuntime.h"
+#import "NSBundle+HLSExtensions.h"
+#import "NSData+HLSExtensions.h"
+#import "NSError+HLSExtensions.h"
+
+#import <pthread.h>
+#import <UIKit/UIKit.h>
+
+static NSString * const HLSDeduplicatingIndexPath = @"/Index.plist";
+static NSString * const HLSDeduplicatingBlobsPath = @"/Blobs";
+
+static NSString * const HLSDeduplicatingIndexDirectoriesKey = @"directories";
+static NSString * const HLSDeduplicatingIndexFilesKey = @"files";
+static NSString * const HLSDeduplicatingIndexBlobsKey = @"blobs";
+
+// Keys for associated objects
+static void *s_blobPinKey = &s_blobPinKey;
+
+static NSString *HLSDeduplicatingBlobPath(NSString *hash)
+{
+    return [HLSDeduplicatingBlobsPath stringByAppendingPathComponent:hash];
+}
+
+/**
+ * Keep a blob pinned as long as the object is alive (e.g. attached to a stream reading it)
+ */
+@interface HLSDeduplicatingBlobPin : NSObject
+
+- (instancetype)initWithFileManager:(HLSDeduplicatingFileManager *)fileManager hash:(NSString *)hash;
+
+@end
+
+@interface HLSDeduplicatingFileManager () {
+@private
+    pthread_mutex_t _lock;
+    unsigned long long _blobByteCount;
+}
+
+@property (nonatomic) HLSFileManager *blobFileManager;
+@property (nonatomic) id<HLSInMemoryStorage> storage;                               // Stores the directory / file hierarchy
+@property (nonatomic) NSMutableDictionary<NSString *, NSString *> *hashes;          // Digest of the contents of each file
+@property (nonatomic) NSCountedSet<NSString *> *blobReferences;                     // Number of files referencing each blob
+@property (nonatomic) NSMutableDictionary<NSString *, NSNumber *> *blobSizes;       // Size of each blob
+@property (nonatomic, getter=isIndexSaveScheduled) BOOL indexSaveScheduled;
+@property (nonatomic) dispatch_queue_t indexQueue;                                  // Serial queue on which the index is saved
+
+- (void)pinBlobWithHash:(NSString *)hash;
+- (void)unpinBlobWithHash:(NSString *)hash;
+
+@end
+
+@implementation HLSDeduplicatingFileManager
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithBlobFileManager:(HLSFileManager *)blobFileManager
+{
+    NSParameterAssert(blobFileManager);
+
+    if (self = [super init]) {
+        self.blobFileManager = blobFileManager;
+
+        pthread_mutex_init(&_lock, NULL);
+
+        self.storage = [[HLSInMemoryFlatStorage alloc] init];
+        self.hashes = [NSMutableDictionary dictionary];
+        self.blobReferences = [NSCountedSet set];
+        self.blobSizes = [NSMutableDictionary dictionary];
+        self.indexQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSDeduplicatingFileManager.index", DISPATCH_QUEUE_SERIAL);
+
+        NSError *error = nil;
+        if (! [blobFileManager createDirectoryAtPath:HLSDeduplicatingBlobsPath withIntermediateDirectories:YES error:&error]) {
+            HLSLoggerError(@"Could not create the blob directory. Reason: %@", error);
+            return nil;
+        }
+
+        [self loadIndex];
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+
+    pthread_mutex_destroy(&_lock);
+}
+
+#pragma mark Accessors and mutators
+
+- (NSUInteger)blobCount
+{
+    pthread_mutex_lock(&_lock);
+    NSUInteger blobCount = self.blobSizes.count;
+    pthread_mutex_unlock(&_lock);
+    return blobCount;
+}
+
+- (unsigned long long)blobByteCount
+{
+    pthread_mutex_lock(&_lock);
+    unsigned long long blobByteCount = _blobByteCount;
+    pthread_mutex_unlock(&_lock);
+    return blobByteCount;
+}
+
+#pragma mark Content management (the lock must be held when calling these methods)
+
+- (BOOL)checkPath:(NSString *)path error:(NSError *__autoreleasing *)pError
+{
+    if (! [path hasPrefix:@"/"]) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadInvalidFileNameError
+                          localizedDescription:CoconutKitLocalizedString(@"Invalid file path", nil)];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+- (BOOL)itemExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    if (! [self checkPath:path error:NULL]) {
+        return NO;
+    }
+
+    return [self.storage itemExistsAtPath:path isDirectory:pIsDirectory];
+}
+
+- (BOOL)checkParentDirectoryForPath:(NSString *)path error:(NSError *__autoreleasing *)pError
+{
+    BOOL isDirectory = NO;
+    NSString *parentPath = path.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtPath:parentPath isDirectory:&isDirectory] || ! isDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), parentPath]];
+        }
+        return NO;
+    }
+    return YES;
+}
+
+/**
+ * Check that a copy or move can be performed between the specified locations
+ */
+- (BOOL)checkSourcePath:(NSString *)sourcePath destinationPath:(NSString *)destinationPath error:(NSError *__autoreleasing *)pError
+{
+    if (! [self checkPath:sourcePath error:pError] || ! [self checkPath:destinationPath error:pError]) {
+        return NO;
+    }
+
+    // Prevent recursive copy or move
+    if ([destinationPath hasPrefix:sourcePath]) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadInvalidFileNameError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination cannot be contained in the source", nil)];
+        }
+        return NO;
+    }
+
+    if (! [self itemExistsAtPath:sourcePath isDirectory:NULL]) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"The source file or directory does not exist", nil)];
+        }
+        return NO;
+    }
+
+    // The destination directory must exist
+    BOOL isDestinationParentDirectory = NO;
+    NSString *destinationParentPath = destinationPath.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtPath:destinationParentPath isDirectory:&isDestinationParentDirectory] || ! isDestinationParentDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination directory does not exist", nil)];
+        }
+        return NO;
+    }
+
+    if ([self itemExistsAtPath:destinationPath isDirectory:NULL]) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+- (NSString *)hashAtPath:(NSString *)path
+{
+    NSString *fileKey = [self checkPath:path error:NULL] ? [self.storage fileKeyAtPath:path] : nil;
+    return fileKey ? self.hashes[fileKey] : nil;
+}
+
+/**
+ * Files do not store their contents directly, but reference a blob by digest. Blobs are removed from the blob file
+ * manager when they are not referenced anymore
+ */
+- (void)retainBlobWithHash:(NSString *)hash size:(unsigned long long)size forFileKey:(NSString *)fileKey
+{
+    self.hashes[fileKey] = hash;
+
+    if ([self.blobReferences countForObject:hash] == 0) {
+        self.blobSizes[hash] = @(size);
+        _blobByteCount += size;
+    }
+    [self.blobReferences addObject:hash];
+}
+
+- (void)releaseBlobForFileKey:(NSString *)fileKey
+{
+    NSString *hash = self.hashes[fileKey];
+    if (! hash) {
+        return;
+    }
+
+    [self.hashes removeObjectForKey:fileKey];
+    [self releaseBlobWithHash:hash];
+}
+
+- (void)releaseBlobWithHash:(NSString *)hash
+{
+    [self.blobReferences removeObject:hash];
+
+    if ([self.blobReferences countForObject:hash] == 0) {
+        _blobByteCount -= self.blobSizes[hash].unsignedLongLongValue;
+        [self.blobSizes removeObjectForKey:hash];
+
+        NSError *error = nil;
+        if (! [self.blobFileManager removeItemAtPath:HLSDeduplicatingBlobPath(hash) error:&error]) {
+            HLSLoggerWarn(@"Could not remove blob %@. Reason: %@", hash, error);
+        }
+    }
+}
+
+#pragma mark Blob pinning
+
+/**
+ * Blobs are read without holding the lock. A blob being read is pinned so that it cannot be removed meanwhile, even
+ * if the files referencing it are overwritten or removed. Return the hash of the pinned blob, nil if no file exists
+ * at the specified path
+ */
+- (NSString *)pinBlobAtPath:(NSString *)path
+{
+    pthread_mutex_lock(&_lock);
+    NSString *hash = [self hashAtPath:path];
+    if (hash) {
+        [self.blobReferences addObject:hash];
+    }
+    pthread_mutex_unlock(&_lock);
+    return hash;
+}
+
+- (void)pinBlobWithHash:(NSString *)hash
+{
+    pthread_mutex_lock(&_lock);
+    [self.blobReferences addObject:hash];
+    pthread_mutex_unlock(&_lock);
+}
+
+- (void)unpinBlobWithHash:(NSString *)hash
+{
+    pthread_mutex_lock(&_lock);
+    [self releaseBlobWithHash:hash];
+    pthread_mutex_unlock(&_lock);
+}
+
+#pragma mark Index management
+
+/**
+ * Restore the index saved in the blob file manager. Since the index is saved asynchronously, it might not match the
+ * blobs actually stored. Files whose blob is missing are discarded, and blobs which are not referenced are removed
+ */
+- (void)loadIndex
+{
+    NSData *indexData = [self.blobFileManager contentsOfFileAtPath:HLSDeduplicatingIndexPath error:NULL];
+    NSDictionary *index = indexData ? [NSPropertyListSerialization propertyListWithData:indexData options:NSPropertyListImmutable format:NULL error:NULL] : nil;
+    if (indexData && ! [self isValidIndex:index]) {
+        HLSLoggerWarn(@"The index is invalid and has been discarded");
+        index = nil;
+    }
+
+    NSSet<NSString *> *storedHashes = [NSSet setWithArray:[self.blobFileManager contentsOfDirectoryAtPath:HLSDeduplicatingBlobsPath error:NULL] ?: @[]];
+
+    NSArray<NSString *> *directoryPaths = index[HLSDeduplicatingIndexDirectoriesKey];
+    for (NSString *directoryPath in directoryPaths) {
+        [self.storage createDirectoryAtPath:directoryPath];
+    }
+
+    NSDictionary<NSString *, NSString *> *files = index[HLSDeduplicatingIndexFilesKey];
+    NSDictionary<NSString *, NSNumber *> *blobSizes = index[HLSDeduplicatingIndexBlobsKey];
+    [files enumerateKeysAndObjectsUsingBlock:^(NSString *path, NSString *hash, BOOL *pStop) {
+        NSNumber *size = blobSizes[hash];
+        if (! size || ! [storedHashes containsObject:hash]) {
+            HLSLoggerWarn(@"The contents of %@ are missing. The file has been discarded", path);
+            return;
+        }
+
+        if (! [self.storage createDirectoryAtPath:path.stringByDeletingLastPathComponent]) {
+            return;
+        }
+
+        NSString *fileKey = [NSUUID UUID].UUIDString;
+        [self.storage setFileKey:fileKey atPath:path];
+        [self retainBlobWithHash:hash size:size.unsignedLongLongValue forFileKey:fileKey];
+    }];
+
+    for (NSString *hash in storedHashes) {
+        if ([self.blobReferences countForObject:hash] == 0) {
+            [self.blobFileManager removeItemAtPath:HLSDeduplicatingBlobPath(hash) error:NULL];
+        }
+    }
+}
+
+- (BOOL)isValidIndex:(id)index
+{
+    if (! [index isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+
+    NSArray *directoryPaths = index[HLSDeduplicatingIndexDirectoriesKey];
+    if (directoryPaths && ! [directoryPaths isKindOfClass:[NSArray class]]) {
+        return NO;
+    }
+    for (id directoryPath in directoryPaths) {
+        if (! [directoryPath isKindOfClass:[NSString class]] || ! [directoryPath hasPrefix:@"/"]) {
+            return NO;
+        }
+    }
+
+    NSDictionary *files = index[HLSDeduplicatingIndexFilesKey];
+    if (files && ! [files isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+    for (id path in files) {
+        if (! [path isKindOfClass:[NSString class]] || ! [path hasPrefix:@"/"] || ! [files[path] isKindOfClass:[NSString class]]) {
+            return NO;
+        }
+    }
+
+    NSDictionary *blobSizes = index[HLSDeduplicatingIndexBlobsKey];
+    if (blobSizes && ! [blobSizes isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+    for (id hash in blobSizes) {
+        if (! [hash isKindOfClass:[NSString class]] || ! [blobSizes[hash] isKindOfClass:[NSNumber class]]) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+/**
+ * Schedule the index to be saved if not already scheduled. Successive changes are therefore saved at once. The lock
+ * must be held
+ */
+- (void)scheduleIndexSave
+{
+    if (self.indexSaveScheduled) {
+        return;
+    }
+
+    self.indexSaveScheduled = YES;
+    dispatch_async(self.indexQueue, ^{
+        [self saveIndex];
+    });
+}
+
+/**
+ * Save a snapshot of the index (must be called on the index queue)
+ */
+- (void)saveIndex
+{
+    NSMutableArray<NSString *> *directoryPaths = [NSMutableArray array];
+    NSMutableDictionary<NSString *, NSString *> *files = [NSMutableDictionary dictionary];
+
+    pthread_mutex_lock(&_lock);
+    self.indexSaveScheduled = NO;
+    [self.storage enumerateItemsAtPath:@"/" maximumDepth:0 usingBlock:^(NSString *itemPath, NSString *fileKey, NSUInteger depth) {
+        if (fileKey) {
+            files[itemPath] = self.hashes[fileKey];
+        }
+        else {
+            [directoryPaths addObject:itemPath];
+        }
+    }];
+    NSDictionary<NSString *, NSNumber *> *blobSizes = [self.blobSizes copy];
+    pthread_mutex_unlock(&_lock);
+
+    NSDictionary *index = @{ HLSDeduplicatingIndexDirectoriesKey : directoryPaths,
+                             HLSDeduplicatingIndexFilesKey : files,
+                             HLSDeduplicatingIndexBlobsKey : blobSizes };
+
+    NSError *error = nil;
+    NSData *indexData = [NSPropertyListSerialization dataWithPropertyList:index format:NSPropertyListBinaryFormat_v1_0 options:0 error:&error];
+    if (! indexData || ! [self.blobFileManager createFileAtPath:HLSDeduplicatingIndexPath contents:indexData error:&error]) {
+        HLSLoggerError(@"Could not save the index. Reason: %@", error);
+    }
+}
+
+- (void)synchronize
+{
+    dispatch_sync(self.indexQueue, ^{});
+}
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    NSString *hash = [self pinBlobAtPath:path];
+
+    if (! hash) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"File not found", nil)];
+        }
+        return nil;
+    }
+
+    NSData *contents = [self.blobFileManager contentsOfFileAtPath:HLSDeduplicatingBlobPath(hash) error:pError];
+    [self unpinBlobWithHash:hash];
+    return contents;
+}
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(out NSError *__autoreleasing *)pError
+{
+    NSString *hash = [self pinBlobAtPath:path];
+
+    if (! hash) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"File not found", nil)];
+        }
+        return nil;
+    }
+
+    NSData *contents = [self.blobFileManager contentsOfFileAtPath:HLSDeduplicatingBlobPath(hash) range:range error:pError];
+    [self unpinBlobWithHash:hash];
+    return contents;
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(out NSError *__autoreleasing *)pError
+{
+    if (! contents) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteUnknownError
+                          localizedDescription:CoconutKitLocalizedString(@"No data has been provided", nil)];
+        }
+        return NO;
+    }
+
+    // The digest is the most expensive part of the process, and does not require the lock
+    NSString *hash = contents.sha256hash;
+
+    pthread_mutex_lock(&_lock);
+
+    if (! [self checkPath:path error:pError] || ! [self checkParentDirectoryForPath:path error:pError]) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+
+    // Directories cannot be replaced with files
+    BOOL isDirectory = NO;
+    if ([self.storage itemExistsAtPath:path isDirectory:&isDirectory] && isDirectory) {
+        pthread_mutex_unlock(&_lock);
+
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
+        }
+        return NO;
+    }
+
+    // Contents are only stored if not already available
+    if ([self.blobReferences countForObject:hash] == 0
+            && ! [self.blobFileManager createFileAtPath:HLSDeduplicatingBlobPath(hash) contents:contents error:pError]) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+
+    // Retain before releasing the replaced file, which might share the same blob
+    NSString *fileKey = [NSUUID UUID].UUIDString;
+    [self retainBlobWithHash:hash size:contents.length forFileKey:fileKey];
+    NSString *replacedFileKey = [self.storage setFileKey:fileKey atPath:path];
+    if (replacedFileKey) {
+        [self releaseBlobForFileKey:replacedFileKey];
+    }
+
+    [self scheduleIndexSave];
+
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(out NSError *__autoreleasing *)pError
+{
+    pthread_mutex_lock(&_lock);
+
+    if (! [self checkPath:path error:pError]
+            || (! withIntermediateDirectories && ! [self checkParentDirectoryForPath:path error:pError])) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+
+    // If the directory already exists, it is not replaced, and the method succeeds
+    if (! [self.storage createDirectoryAtPath:path]) {
+        pthread_mutex_unlock(&_lock);
+
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"Invalid file path", nil)];
+        }
+        return NO;
+    }
+
+    [self scheduleIndexSave];
+
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+- (NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    pthread_mutex_lock(&_lock);
+    NSArray<NSString *> *contents = [self checkPath:path error:NULL] ? [self.storage contentsOfDirectoryAtPath:path] : nil;
+    pthread_mutex_unlock(&_lock);
+
+    if (! contents) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), path]];
+        }
+        return nil;
+    }
+
+    return contents;
+}
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
+{
+    NSParameterAssert(block);
+
+    // Sizes are known from the index, no blob needs to be accessed
+    NSMutableArray<HLSFileItem *> *items = [NSMutableArray array];
+
+    pthread_mutex_lock(&_lock);
+    BOOL enumerated = [self checkPath:path error:NULL] && [self.storage enumerateItemsAtPath:path maximumDepth:maximumDepth usingBlock:^(NSString *itemPath, NSString *fileKey, NSUInteger depth) {
+        if (fileKey) {
+            NSString *hash = self.hashes[fileKey];
+            [items addObject:[[HLSFileItem alloc] initWithPath:itemPath directory:NO size:self.blobSizes[hash].unsignedLongLongValue modificationDate:nil depth:depth]];
+        }
+        else {
+            [items addObject:[[HLSFileItem alloc] initWithPath:itemPath directory:YES size:0 modificationDate:nil depth:depth]];
+        }
+    }];
+    pthread_mutex_unlock(&_lock);
+
+    if (! enumerated) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), path]];
+        }
+        return NO;
+    }
+
+    BOOL stop = NO;
+    for (HLSFileItem *item in items) {
+        block(item, &stop);
+        if (stop) {
+            break;
+        }
+    }
+    return YES;
+}
+
+- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(out BOOL *)pIsDirectory
+{
+    pthread_mutex_lock(&_lock);
+    BOOL exists = [self itemExistsAtPath:path isDirectory:pIsDirectory];
+    pthread_mutex_unlock(&_lock);
+    return exists;
+}
+
+- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    pthread_mutex_lock(&_lock);
+
+    if (! [self checkSourcePath:sourcePath destinationPath:destinationPath error:pError]) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+
+    // Copies reference the same blobs. Only the index is updated
+    [self.storage copyItemAtPath:sourcePath toPath:destinationPath withFileKeyBlock:^NSString *(NSString *fileKey) {
+        NSString *hash = self.hashes[fileKey];
+        if (! hash) {
+            return nil;
+        }
+
+        NSString *destinationFileKey = [NSUUID UUID].UUIDString;
+        [self retainBlobWithHash:hash size:self.blobSizes[hash].unsignedLongLongValue forFileKey:destinationFileKey];
+        return destinationFileKey;
+    }];
+
+    [self scheduleIndexSave];
+
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    pthread_mutex_lock(&_lock);
+
+    if (! [self checkSourcePath:sourcePath destinationPath:destinationPath error:pError]) {
+        pthread_mutex_unlock(&_lock);
+        return NO;
+    }
+
+    [self.storage moveItemAtPath:sourcePath toPath:destinationPath];
+    [self scheduleIndexSave];
+
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+- (BOOL)removeItemAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    pthread_mutex_lock(&_lock);
+
+    if (! [self itemExistsAtPath:path isDirectory:NULL]) {
+        pthread_mutex_unlock(&_lock);
+
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"File or directory not found", nil)];
+        }
+        return NO;
+    }
+
+    // Never deletes the root, rather deletes all its contents
+    [self.storage removeItemAtPath:path withFileKeyBlock:^(NSString *fileKey) {
+        [self releaseBlobForFileKey:fileKey];
+    }];
+    [self scheduleIndexSave];
+
+    pthread_mutex_unlock(&_lock);
+    return YES;
+}
+
+#pragma mark HLSFileManagerStreamSupport protocol implementation
+
+- (NSInputStream *)inputStreamWithFileAtPath:(NSString *)path
+{
+    NSString *hash = [self pinBlobAtPath:path];
+    if (! hash) {
+        return nil;
+    }
+
+    // The blob stays pinned as long as the stream is alive
+    HLSDeduplicatingBlobPin *blobPin = [[HLSDeduplicatingBlobPin alloc] initWithFileManager:self hash:hash];
+    [self unpinBlobWithHash:hash];
+
+    NSInputStream *inputStream = nil;
+    if (self.blobFileManager.providingInputStreams) {
+        inputStream = [self.blobFileManager inputStreamWithFileAtPath:HLSDeduplicatingBlobPath(hash)];
+        if (inputStream) {
+            hls_setAssociatedObject(inputStream, s_blobPinKey, blobPin, HLS_ASSOCIATION_STRONG);
+        }
+    }
+    else {
+        NSData *data = [self.blobFileManager contentsOfFileAtPath:HLSDeduplicatingBlobPath(hash) error:NULL];
+        inputStream = data ? [NSInputStream inputStreamWithData:data] : nil;
+    }
+    return inputStream;
+}
+
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append
+{
+    pthread_mutex_lock(&_lock);
+    BOOL isDirectory = NO;
+    BOOL exists = [self itemExistsAtPath:path isDirectory:&isDirectory];
+    BOOL valid = [self checkPath:path error:NULL] && [self checkParentDirectoryForPath:path error:NULL] && ! (exists && isDirectory);
+    pthread_mutex_unlock(&_lock);
+
+    if (! valid) {
+        return nil;
+    }
+
+    // The digest of the contents is only known once complete. Data is therefore committed when the stream is closed
+    NSData *initialData = (append && exists) ? [self contentsOfFileAtPath:path error:NULL] : nil;
+    return [[HLSInMemoryOutputStream alloc] initWithData:initialData commitBlock:^(NSData *data) {
+        NSError *error = nil;
+        if (! [self createFileAtPath:path contents:data error:&error]) {
+            HLSLoggerWarn(@"Could not commit output stream data to %@. Reason: %@", path, error);
+        }
+    }];
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    [self synchronize];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    pthread_mutex_lock(&_lock);
+    NSString *storageDescription = [self.storage description];
+    NSUInteger blobCount = self.blobSizes.count;
+    pthread_mutex_unlock(&_lock);
+
+    return [NSString stringWithFormat:@"<%@: %p; blobFileManager: %@; blobCount: %@; storage: %@>",
+            [self class],
+            self,
+            self.blobFileManager,
+            @(blobCount),
+            storageDescription];
+}
+
+@end
+
+@implementation HLSDeduplicatingBlobPin {
+@private
+    HLSDeduplicatingFileManager *_fileManager;
+    NSString *_hash;
+}
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithFileManager:(HLSDeduplicatingFileManager *)fileManager hash:(NSString *)hash
+{
+    if (self = [super init]) {
+        _fileManager = fileManager;
+        _hash = [hash copy];
+
+        [fileManager pinBlobWithHash:hash];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fileManager unpinBlobWithHash:_hash];
+}
+
+@end
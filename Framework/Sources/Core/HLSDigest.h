@@ -0,0 +1,90 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManager.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Available digest algorithms
+ */
+typedef NS_ENUM(NSInteger, HLSDigestAlgorithm) {
+    HLSDigestAlgorithmEnumBegin = 0,
+    HLSDigestAlgorithmMD2 = HLSDigestAlgorithmEnumBegin,
+    HLSDigestAlgorithmMD4,
+    HLSDigestAlgorithmMD5,
+    HLSDigestAlgorithmSHA1,
+    HLSDigestAlgorithmSHA224,
+    HLSDigestAlgorithmSHA256,
+    HLSDigestAlgorithmSHA384,
+    HLSDigestAlgorithmSHA512,
+    HLSDigestAlgorithmEnumEnd,
+    HLSDigestAlgorithmEnumSize = HLSDigestAlgorithmEnumEnd - HLSDigestAlgorithmEnumBegin
+};
+
+/**
+ * Return the lowercase hexadecimal representation of the specified bytes
+ */
+OBJC_EXPORT NSString *HLSHexadecimalStringFromBytes(const void *bytes, NSUInteger length);
+
+/**
+ * Incremental digest calculation. Data is fed in chunks, which makes it possible to hash data of any size in
+ * constant memory. The digest of the data fed so far can be retrieved at any time
+ *
+ * Digest objects are not thread-safe
+ */
+@interface HLSDigest : NSObject
+
+/**
+ * Calculate the digest of the remaining contents of a stream, read in chunks. The stream is opened if needed, and
+ * closed if it was opened by the method. Return nil and an error if the stream could not be read
+ */
++ (nullable NSString *)hexadecimalDigestForInputStream:(NSInputStream *)inputStream
+                                             algorithm:(HLSDigestAlgorithm)algorithm
+                                                 error:(out NSError *__autoreleasing *)pError;
+
+/**
+ * Calculate the digest of a file managed by a file manager, read in chunks. Return nil and an error if the file could
+ * not be read
+ */
++ (nullable NSString *)hexadecimalDigestForFileAtPath:(NSString *)path
+                                        inFileManager:(HLSFileManager *)fileManager
+                                            algorithm:(HLSDigestAlgorithm)algorithm
+                                                error:(out NSError *__autoreleasing *)pError;
+
+/**
+ * Create a digest object for the specified algorithm
+ */
+- (instancetype)initWithAlgorithm:(HLSDigestAlgorithm)algorithm NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The algorithm used
+ */
+@property (nonatomic, readonly) HLSDigestAlgorithm algorithm;
+
+/**
+ * Feed data
+ */
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length;
+- (void)updateWithData:(NSData *)data;
+
+/**
+ * The digest of the data fed so far, either raw or as a lowercase hexadecimal string. More data can be fed afterwards
+ */
+@property (nonatomic, readonly) NSData *digest;
+@property (nonatomic, readonly, copy) NSString *hexadecimalDigest;
+
+@end
+
+@interface HLSDigest (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,373 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSDigest.h"
+
+#import "NSBundle+HLSExtensions.h"
+#import "NSError+HLSExtensions.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static const NSUInteger HLSDigestChunkSize = 256 * 1024;
+
+NSString *HLSHexadecimalStringFromBytes(const void *bytes, NSUInteger length)
+{
+    static const char s_hexadecimalDigits[] = "0123456789abcdef";
+
+    if (length == 0) {
+        return @"";
+    }
+
+    // Two digits per byte, looked up directly instead of being formatted
+    char *characters = malloc(2 * length);
+    const uint8_t *byteValues = bytes;
+    for (NSUInteger i = 0; i < length; ++i) {
+        characters[2 * i] = s_hexadecimalDigits[byteValues[i] >> 4];
+        characters[2 * i + 1] = s_hexadecimalDigits[byteValues[i] & 0x0f];
+    }
+    return [[NSString alloc] initWithBytesNoCopy:characters length:2 * length encoding:NSASCIIStringEncoding freeWhenDone:YES];
+}
+
+typedef union {
+    CC_MD2_CTX md2;
+    CC_MD4_CTX md4;
+    CC_MD5_CTX md5;
+    CC_SHA1_CTX sha1;
+    CC_SHA256_CTX sha256;                   // Also used for SHA-224
+    CC_SHA512_CTX sha512;                   // Also used for SHA-384
+} HLSDigestContext;
+
+@interface HLSDigest () {
+@private
+    HLSDigestContext _context;
+}
+
+@property (nonatomic) HLSDigestAlgorithm algorithm;
+
+@end
+
+@implementation HLSDigest
+
+#pragma mark Class methods
+
++ (NSString *)hexadecimalDigestForInputStream:(NSInputStream *)inputStream
+                                    algorithm:(HLSDigestAlgorithm)algorithm
+                                        error:(out NSError *__autoreleasing *)pError
+{
+    NSParameterAssert(inputStream);
+
+    BOOL opened = NO;
+    if (inputStream.streamStatus == NSStreamStatusNotOpen) {
+        [inputStream open];
+        opened = YES;
+    }
+
+    HLSDigest *digest = [[HLSDigest alloc] initWithAlgorithm:algorithm];
+
+    uint8_t *buffer = malloc(HLSDigestChunkSize);
+    NSInteger length = 0;
+    while ((length = [inputStream read:buffer maxLength:HLSDigestChunkSize]) > 0) {
+        [digest updateWithBytes:buffer length:length];
+    }
+    free(buffer);
+
+    NSError *streamError = (length < 0) ? inputStream.streamError : nil;
+    if (opened) {
+        [inputStream close];
+    }
+
+    if (length < 0) {
+        if (pError) {
+            *pError = streamError ?: [NSError errorWithDomain:NSCocoaErrorDomain
+                                                         code:NSFileReadUnknownError
+                                         localizedDescription:CoconutKitLocalizedString(@"The stream could not be read", nil)];
+        }
+        return nil;
+    }
+
+    return digest.hexadecimalDigest;
+}
+
++ (NSString *)hexadecimalDigestForFileAtPath:(NSString *)path
+                               inFileManager:(HLSFileManager *)fileManager
+                                   algorithm:(HLSDigestAlgorithm)algorithm
+                                       error:(out NSError *__autoreleasing *)pError
+{
+    NSParameterAssert(path);
+    NSParameterAssert(fileManager);
+
+    if (fileManager.providingInputStreams) {
+        BOOL isDirectory = NO;
+        NSInputStream *inputStream = ([fileManager fileExistsAtPath:path isDirectory:&isDirectory] && ! isDirectory) ? [fileManager inputStreamWithFileAtPath:path] : nil;
+        if (! inputStream) {
+            if (pError) {
+                *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                              code:NSFileNoSuchFileError
+                              localizedDescription:CoconutKitLocalizedString(@"File not found", nil)];
+            }
+            return nil;
+        }
+
+        return [self hexadecimalDigestForInputStream:inputStream algorithm:algorithm error:pError];
+    }
+
+    // The default implementation of range reads loads the whole file each time. Read it once in this case
+    HLSDigest *digest = [[HLSDigest alloc] initWithAlgorithm:algorithm];
+    SEL rangeSelector = @selector(contentsOfFileAtPath:range:error:);
+    if ([fileManager methodForSelector:rangeSelector] == [HLSFileManager instanceMethodForSelector:rangeSelector]) {
+        NSData *contents = [fileManager contentsOfFileAtPath:path error:pError];
+        if (! contents) {
+            return nil;
+        }
+
+        [digest updateWithData:contents];
+        return digest.hexadecimalDigest;
+    }
+
+    // Otherwise read the file chunk by chunk. The last chunk is shorter
+    NSUInteger location = 0;
+    while (YES) {
+        NSData *chunk = [fileManager contentsOfFileAtPath:path range:NSMakeRange(location, HLSDigestChunkSize) error:pError];
+        if (! chunk) {
+            return nil;
+        }
+
+        [digest updateWithData:chunk];
+        location += chunk.length;
+
+        if (chunk.length < HLSDigestChunkSize) {
+            break;
+        }
+    }
+    return digest.hexadecimalDigest;
+}
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithAlgorithm:(HLSDigestAlgorithm)algorithm
+{
+    NSParameterAssert(algorithm >= HLSDigestAlgorithmEnumBegin && algorithm < HLSDigestAlgorithmEnumEnd);
+
+    if (self = [super init]) {
+        self.algorithm = algorithm;
+
+        switch (algorithm) {
+            case HLSDigestAlgorithmMD2: {
+                CC_MD2_Init(&_context.md2);
+                break;
+            }
+
+            case HLSDigestAlgorithmMD4: {
+                CC_MD4_Init(&_context.md4);
+                break;
+            }
+
+            case HLSDigestAlgorithmMD5: {
+                CC_MD5_Init(&_context.md5);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA1: {
+                CC_SHA1_Init(&_context.sha1);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA224: {
+                CC_SHA224_Init(&_context.sha256);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA256: {
+                CC_SHA256_Init(&_context.sha256);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA384: {
+                CC_SHA384_Init(&_context.sha512);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA512: {
+                CC_SHA512_Init(&_context.sha512);
+                break;
+            }
+
+            default: {
+                return nil;
+                break;
+            }
+        }
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Updates
+
+- (void)updateWithBytes:(const void *)bytes length:(NSUInteger)length
+{
+    // CommonCrypto lengths are 32-bit
+    const uint8_t *chunkBytes = bytes;
+    while (length != 0) {
+        CC_LONG chunkLength = (CC_LONG)MIN(length, (NSUInteger)UINT32_MAX);
+
+        switch (self.algorithm) {
+            case HLSDigestAlgorithmMD2: {
+                CC_MD2_Update(&_context.md2, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmMD4: {
+                CC_MD4_Update(&_context.md4, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmMD5: {
+                CC_MD5_Update(&_context.md5, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA1: {
+                CC_SHA1_Update(&_context.sha1, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA224: {
+                CC_SHA224_Update(&_context.sha256, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA256: {
+                CC_SHA256_Update(&_context.sha256, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA384: {
+                CC_SHA384_Update(&_context.sha512, chunkBytes, chunkLength);
+                break;
+            }
+
+            case HLSDigestAlgorithmSHA512: {
+                CC_SHA512_Update(&_context.sha512, chunkBytes, chunkLength);
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+
+        chunkBytes += chunkLength;
+        length -= chunkLength;
+    }
+}
+
+- (void)updateWithData:(NSData *)data
+{
+    // Non-contiguous data is fed one region at a time
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *pStop) {
+        [self updateWithBytes:bytes length:byteRange.length];
+    }];
+}
+
+#pragma mark Accessors and mutators
+
+- (NSData *)digest
+{
+    // Finalize a copy of the context, so that more data can be fed afterwards
+    HLSDigestContext context = _context;
+
+    switch (self.algorithm) {
+        case HLSDigestAlgorithmMD2: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_MD2_DIGEST_LENGTH];
+            CC_MD2_Final(digest.mutableBytes, &context.md2);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmMD4: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_MD4_DIGEST_LENGTH];
+            CC_MD4_Final(digest.mutableBytes, &context.md4);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmMD5: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_MD5_DIGEST_LENGTH];
+            CC_MD5_Final(digest.mutableBytes, &context.md5);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmSHA1: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA1_DIGEST_LENGTH];
+            CC_SHA1_Final(digest.mutableBytes, &context.sha1);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmSHA224: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA224_DIGEST_LENGTH];
+            CC_SHA224_Final(digest.mutableBytes, &context.sha256);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmSHA256: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA256_DIGEST_LENGTH];
+            CC_SHA256_Final(digest.mutableBytes, &context.sha256);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmSHA384: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA384_DIGEST_LENGTH];
+            CC_SHA384_Final(digest.mutableBytes, &context.sha512);
+            return [digest copy];
+            break;
+        }
+
+        case HLSDigestAlgorithmSHA512: {
+            NSMutableData *digest = [NSMutableData dataWithLength:CC_SHA512_DIGEST_LENGTH];
+            CC_SHA512_Final(digest.mutableBytes, &context.sha512);
+            return [digest copy];
+            break;
+        }
+
+        default: {
+            return [NSData data];
+            break;
+        }
+    }
+}
+
+- (NSString *)hexadecimalDigest
+{
+    NSData *digest = self.digest;
+    return HLSHexadecimalStringFromBytes(digest.bytes, digest.length);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; algorithm: %@; hexadecimalDigest: %@>",
+            [self class],
+            self,
+            @(self.algorithm),
+            self.hexadecimalDigest];
+}
+
+@end
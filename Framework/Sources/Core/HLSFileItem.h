@@ -0,0 +1,44 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Information about a file or directory, as returned when enumerating the contents of an HLSFileManager
+ */
+@interface HLSFileItem : NSObject
+
+/**
+ * Create an item. The path is relative to the file manager root and must begin with a /. The depth is the level
+ * of the item relative to the enumerated directory (1 for its direct contents)
+ */
+- (instancetype)initWithPath:(NSString *)path
+                   directory:(BOOL)directory
+                        size:(unsigned long long)size
+            modificationDate:(nullable NSDate *)modificationDate
+                       depth:(NSUInteger)depth NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Item information. The size of a directory is always 0. The modification date is nil if not available
+ */
+@property (nonatomic, readonly, copy) NSString *path;
+@property (nonatomic, readonly, copy) NSString *name;
+@property (nonatomic, readonly, getter=isDirectory) BOOL directory;
+@property (nonatomic, readonly) unsigned long long size;
+@property (nonatomic, readonly, nullable) NSDate *modificationDate;
+@property (nonatomic, readonly) NSUInteger depth;
+
+@end
+
+@interface HLSFileItem (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,74 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileItem.h"
+
+#import "HLSTransformer.h"
+
+@interface HLSFileItem ()
+
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, getter=isDirectory) BOOL directory;
+@property (nonatomic) unsigned long long size;
+@property (nonatomic) NSDate *modificationDate;
+@property (nonatomic) NSUInteger depth;
+
+@end
+
+@implementation HLSFileItem
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithPath:(NSString *)path
+                   directory:(BOOL)directory
+                        size:(unsigned long long)size
+            modificationDate:(NSDate *)modificationDate
+                       depth:(NSUInteger)depth
+{
+    NSParameterAssert(path);
+
+    if (self = [super init]) {
+        self.path = path;
+        self.directory = directory;
+        self.size = directory ? 0 : size;
+        self.modificationDate = modificationDate;
+        self.depth = depth;
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Accessors and mutators
+
+- (NSString *)name
+{
+    return self.path.lastPathComponent;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; path: %@; directory: %@; size: %llu; modificationDate: %@; depth: %lu>",
+            [self class],
+            self,
+            self.path,
+            HLSStringFromBool(self.directory),
+            self.size,
+            self.modificationDate,
+            (unsigned long)self.depth];
+}
+
+@end
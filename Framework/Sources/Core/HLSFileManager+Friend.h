@@ -0,0 +1,23 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManager.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Functions meant to be used by file manager implementations and their private helper classes
+ */
+
+/**
+ * Return the normalized version of an absolute path (no trailing or duplicate slashes), nil if the path is not absolute.
+ * Most paths are already normalized, in which case the path itself is returned without any allocation
+ */
+OBJC_EXPORT NSString * _Nullable HLSFileManagerNormalizedPath(NSString *path);
+
+NS_ASSUME_NONNULL_END
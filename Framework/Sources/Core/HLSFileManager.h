@@ -4,6 +4,8 @@
 //  License information is available from the LICENSE file.
 //
 
+#import "HLSFileItem.h"
+
 #import <Foundation/Foundation.h>
 
 NS_ASSUME_NONNULL_BEGIN
@@ -41,6 +43,21 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError;
 
+/**
+ * Enumerate the contents of the specified directory in a single pass, providing the information about each item to
+ * the block (a directory is always enumerated before its contents). Set *pStop to YES to stop the enumeration. If
+ * maximumDepth is 1, only the directory contents are enumerated, 0 means no limit. If the path is incorrect or does
+ * not correspond to a directory, the method must return NO and an error, otherwise YES and no error
+ *
+ * HLSFileManager provides a default implementation built on top of the other methods of this protocol. Subclasses
+ * should override it with a more efficient implementation. In particular, unless the file manager provides URLs, the
+ * default implementation can only get the size of a file by reading its whole contents
+ */
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block;
+
 /**
  * Return YES iff the file or folder exists at the specified path (and whether it is a directory or not; you can pass NULL if you do not
  * need this information). If the path is invalid or if the file does not exist, the method must return NO and leave the boolean received
@@ -128,6 +145,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)fileExistsAtPath:(NSString *)path;
 
+/**
+ * Return the bytes of the file at the given location within the specified range. If the range extends past the end
+ * of the file, the bytes up to the end of the file are returned. If the path is incorrect, if the file does not exist
+ * or if the range begins past the end of the file, the method returns nil and an error
+ *
+ * The default implementation extracts the range from the whole file contents. Subclasses can override this method
+ * to avoid loading the whole file
+ */
+- (nullable NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(out NSError *__autoreleasing *)pError;
+
 /**
  * Return YES iff the corresponding stream type is supported. Check before calling methods from the HLSFileManagerStreamSupport
  * protocol
@@ -6,8 +6,28 @@
 
 #import "HLSFileManager.h"
 
+#import "HLSFileManager+Friend.h"
 #import "HLSLogger.h"
 #import "HLSRuntime.h"
+#import "NSBundle+HLSExtensions.h"
+#import "NSError+HLSExtensions.h"
+
+NSString *HLSFileManagerNormalizedPath(NSString *path)
+{
+    NSCParameterAssert(path);
+    
+    if (! [path hasPrefix:@"/"]) {
+        return nil;
+    }
+    
+    NSUInteger length = path.length;
+    if (length > 1 && ([path characterAtIndex:length - 1] == '/' || [path rangeOfString:@"//"].location != NSNotFound)) {
+        return [NSString pathWithComponents:path.pathComponents];
+    }
+    else {
+        return path;
+    }
+}
 
 @implementation HLSFileManager
 
@@ -42,6 +62,71 @@
     return [self respondsToSelector:@selector(URLForFileAtPath:)];
 }
 
+#pragma mark Default implementations
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
+{
+    NSParameterAssert(block);
+    
+    NSArray<NSString *> *contents = [self contentsOfDirectoryAtPath:path error:pError];
+    if (! contents) {
+        return NO;
+    }
+    
+    BOOL stop = NO;
+    [self enumerateContents:contents atPath:path depth:1 maximumDepth:maximumDepth stop:&stop usingBlock:block];
+    return YES;
+}
+
+- (void)enumerateContents:(NSArray<NSString *> *)contents
+                   atPath:(NSString *)path
+                    depth:(NSUInteger)depth
+             maximumDepth:(NSUInteger)maximumDepth
+                     stop:(BOOL *)pStop
+               usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
+{
+    for (NSString *name in contents) {
+        NSString *itemPath = [path stringByAppendingPathComponent:name];
+        
+        BOOL isDirectory = NO;
+        if (! [self fileExistsAtPath:itemPath isDirectory:&isDirectory]) {
+            continue;
+        }
+        
+        unsigned long long size = isDirectory ? 0 : [self sizeOfFileAtPath:itemPath];
+        HLSFileItem *item = [[HLSFileItem alloc] initWithPath:itemPath directory:isDirectory size:size modificationDate:nil depth:depth];
+        block(item, pStop);
+        if (*pStop) {
+            return;
+        }
+        
+        if (isDirectory && (maximumDepth == 0 || depth < maximumDepth)) {
+            NSArray<NSString *> *subcontents = [self contentsOfDirectoryAtPath:itemPath error:NULL];
+            [self enumerateContents:subcontents atPath:itemPath depth:depth + 1 maximumDepth:maximumDepth stop:pStop usingBlock:block];
+            if (*pStop) {
+                return;
+            }
+        }
+    }
+}
+
+// Read the whole file only if its size cannot be obtained from its URL
+- (unsigned long long)sizeOfFileAtPath:(NSString *)path
+{
+    if (self.providingURLs) {
+        NSURL *fileURL = [(id<HLSFileManagerURLSupport>)self URLForFileAtPath:path];
+        NSNumber *fileSize = nil;
+        if ([fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:NULL] && fileSize) {
+            return fileSize.unsignedLongLongValue;
+        }
+    }
+    
+    return [self contentsOfFileAtPath:path error:NULL].length;
+}
+
 #pragma mark Convenience methods
 
 - (BOOL)fileExistsAtPath:(NSString *)path
@@ -49,4 +134,23 @@
     return [self fileExistsAtPath:path isDirectory:NULL];
 }
 
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(out NSError *__autoreleasing *)pError
+{
+    NSData *contents = [self contentsOfFileAtPath:path error:pError];
+    if (! contents) {
+        return nil;
+    }
+    
+    if (range.location > contents.length) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadUnknownError
+                          localizedDescription:CoconutKitLocalizedString(@"Invalid byte range", nil)];
+        }
+        return nil;
+    }
+    
+    return [contents subdataWithRange:NSMakeRange(range.location, MIN(range.length, contents.length - range.location))];
+}
+
 @end
@@ -11,25 +11,24 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  * Private class containing the information of an entry within the cache managed by HLSInMemoryFileManager
  *
- * This additional bookkeeping is required because the cache can cleanup objects when it grows too large. In such
- * cases, the internal file hierarchy dictionary maintained by the file manager needs to be updated to reflect which
- * object has been discarded
+ * A cache entry is a content block which can be shared by several files (copies share their content until they are
+ * overwritten), so that its cost is only counted once. The entry key is required because the cache can cleanup objects
+ * when it grows too large. In such cases, the internal file hierarchy maintained by the file manager storage needs to
+ * be updated to reflect which files have been discarded
  */
 @interface HLSInMemoryCacheEntry : NSObject
 
 /**
- * Create a cache entry. The name points at an object contained within the parentItems file dictionary
+ * Create a cache entry for the specified data, with a unique key
  */
-- (instancetype)initWithParentItems:(NSMutableDictionary<NSString *, id> *)parentItems
-                               name:(NSString *)name
-                               data:(NSData *)data NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithData:(NSData *)data NS_DESIGNATED_INITIALIZER;
 
 /**
  * Access entry information
  */
-@property (nonatomic, readonly) NSMutableDictionary<NSString *, id> *parentItems;
-@property (nonatomic, readonly, copy) NSString *name;
+@property (nonatomic, readonly, copy) NSString *key;
 @property (nonatomic, readonly) NSData *data;
+@property (nonatomic, readonly) NSDate *creationDate;
 
 @property (nonatomic, readonly) NSUInteger cost;
 
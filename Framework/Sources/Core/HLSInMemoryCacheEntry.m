@@ -8,9 +8,9 @@
 
 @interface HLSInMemoryCacheEntry ()
 
-@property (nonatomic) NSMutableDictionary<NSString *, id> *parentItems;
-@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSString *key;
 @property (nonatomic) NSData *data;
+@property (nonatomic) NSDate *creationDate;
 
 @end
 
@@ -18,18 +18,14 @@
 
 #pragma mark Object creation and destruction
 
-- (instancetype)initWithParentItems:(NSMutableDictionary<NSString *, id> *)parentItems
-                               name:(NSString *)name
-                               data:(NSData *)data
+- (instancetype)initWithData:(NSData *)data
 {
-    NSParameterAssert(parentItems);
-    NSParameterAssert(name);
     NSParameterAssert(data);
     
     if (self = [super init]) {
-        self.parentItems = parentItems;
-        self.name = name;
+        self.key = [NSUUID UUID].UUIDString;
         self.data = data;
+        self.creationDate = [NSDate date];
     }
     return self;
 }
@@ -55,11 +51,10 @@
 
 - (NSString *)description
 {
-    return [NSString stringWithFormat:@"<%@: %p; name: %@; parentItems: %p; cost: %lu>",
+    return [NSString stringWithFormat:@"<%@: %p; key: %@; cost: %lu>",
             [self class],
             self,
-            self.name,
-            self.parentItems,
+            self.key,
             (unsigned long)self.cost];
 }
 
@@ -0,0 +1,27 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryFileManager.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Interface meant to be used by friend classes of HLSInMemoryFileManager (= classes which must have access to private
+ * implementation details)
+ */
+@interface HLSInMemoryFileManager (Friend)
+
+/**
+ * Block until all evictions which have already occurred have been applied to the file hierarchy (and reported to the
+ * delegate). Must not be called from a delegate method
+ */
+- (void)waitUntilEvictionsAreProcessed;
+
+@end
+
+NS_ASSUME_NONNULL_END
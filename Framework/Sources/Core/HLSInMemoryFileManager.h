@@ -10,15 +10,55 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@protocol HLSInMemoryFileManagerDelegate;
+
+/**
+ * Available storage modes for the file and directory hierarchy
+ */
+typedef NS_ENUM(NSInteger, HLSInMemoryFileManagerStorageMode) {
+    HLSInMemoryFileManagerStorageModeEnumBegin = 0,
+    HLSInMemoryFileManagerStorageModeHierarchical = HLSInMemoryFileManagerStorageModeEnumBegin,        // Default: Nested dictionaries, paths are resolved one component
+                                                                                                        // at a time. Lookup cost grows with the hierarchy depth
+    HLSInMemoryFileManagerStorageModeFlat,                                                              // All items are indexed by full path, and each directory indexes its
+                                                                                                        // children. Constant lookup cost, whatever the hierarchy depth, but
+                                                                                                        // moving a directory requires its whole content to be reindexed
+    HLSInMemoryFileManagerStorageModeEnumEnd,
+    HLSInMemoryFileManagerStorageModeEnumSize = HLSInMemoryFileManagerStorageModeEnumEnd - HLSInMemoryFileManagerStorageModeEnumBegin
+};
+
 /**
  * A file manager implementation storing data in memory. If the application receives a memory warning, this data
  * cache is automatically cleared
+ *
+ * The file manager can be safely used from several threads at the same time. Read operations can be performed
+ * concurrently, only operations altering the file hierarchy are serialized
  */
 @interface HLSInMemoryFileManager : HLSFileManager <NSCacheDelegate>
 
+/**
+ * Create a file manager using the specified storage mode. Deep hierarchies should use HLSInMemoryFileManagerStorageModeFlat
+ */
+- (instancetype)initWithStorageMode:(HLSInMemoryFileManagerStorageMode)storageMode NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Create a file manager using HLSInMemoryFileManagerStorageModeHierarchical
+ */
+- (instancetype)init;
+
+/**
+ * The storage mode which has been set at creation time
+ */
+@property (nonatomic, readonly) HLSInMemoryFileManagerStorageMode storageMode;
+
+/**
+ * The file manager delegate, notified when files are evicted from the cache
+ */
+@property (atomic, weak, nullable) id<HLSInMemoryFileManagerDelegate> delegate;
+
 /**
  * Size of the data cache, in bytes, above which the cache might be cleaned (refer to the -[NSCache setTotalCostLimit:] 
- * method documentation for more information). When data is added to the cache, its size in bytes is used as cost
+ * method documentation for more information). When data is added to the cache, its size in bytes is used as cost.
+ * Copied files share their data with the original until they are overwritten, and therefore do not add any cost
  *
  * Default value is 0 (no limit)
  */
@@ -26,4 +66,19 @@ NS_ASSUME_NONNULL_BEGIN
 
 @end
 
+@protocol HLSInMemoryFileManagerDelegate <NSObject>
+@optional
+
+/**
+ * Called when a file is about to be removed because its data has been evicted from the cache (cost limit reached
+ * or memory warning), not when it is removed or replaced explicitly. Files sharing the same data are reported
+ * individually
+ *
+ * This method can be called from any thread, while the file hierarchy is locked. Implementations must therefore
+ * be quick and must not call the file manager back
+ */
+- (void)inMemoryFileManager:(HLSInMemoryFileManager *)fileManager willEvictFileAtPath:(NSString *)path contents:(NSData *)contents;
+
+@end
+
 NS_ASSUME_NONNULL_END
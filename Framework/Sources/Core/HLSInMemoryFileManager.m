@@ -7,18 +7,32 @@
 #import "HLSInMemoryFileManager.h"
 
 #import "HLSInMemoryCacheEntry.h"
+#import "HLSInMemoryFileManager+Friend.h"
+#import "HLSInMemoryFlatStorage.h"
+#import "HLSInMemoryHierarchicalStorage.h"
+#import "HLSInMemoryOutputStream.h"
 #import "HLSLogger.h"
 #import "NSArray+HLSExtensions.h"
 #import "NSBundle+HLSExtensions.h"
 #import "NSError+HLSExtensions.h"
 #import "NSString+HLSExtensions.h"
 
+#import <pthread.h>
+#import <stdatomic.h>
 #import <UIKit/UIKit.h>
 
-@interface HLSInMemoryFileManager ()
+@interface HLSInMemoryFileManager () {
+@private
+    pthread_rwlock_t _lock;                                                     // Protects the storage
+    _Atomic(pthread_t) _writingThread;                                          // Thread currently holding the lock for writing, if any
+}
 
-@property (nonatomic) NSMutableDictionary<NSString *, id> *rootItems;           // Stores the directory / file hierarchy
+@property (nonatomic) HLSInMemoryFileManagerStorageMode storageMode;
+@property (nonatomic) id<HLSInMemoryStorage> storage;                           // Stores the directory / file hierarchy
 @property (nonatomic) NSCache *cache;                                           // Store data
+@property (nonatomic) NSMutableDictionary<NSString *, NSString *> *entryKeys;   // Key of the cache entry containing the data of each file
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableSet<NSString *> *> *fileKeys; // Keys of the files sharing each cache entry
+@property (nonatomic) dispatch_queue_t evictionQueue;                           // Serial queue on which evictions are applied to the storage
 
 @end
 
@@ -26,13 +40,36 @@
 
 #pragma mark Object creation and destruction
 
-- (instancetype)init
+- (instancetype)initWithStorageMode:(HLSInMemoryFileManagerStorageMode)storageMode
 {
     if (self = [super init]) {
-        self.rootItems = [NSMutableDictionary dictionaryWithObject:[NSMutableDictionary dictionary] forKey:@"/"];
+        self.storageMode = storageMode;
+
+        switch (storageMode) {
+            case HLSInMemoryFileManagerStorageModeFlat: {
+                self.storage = [[HLSInMemoryFlatStorage alloc] init];
+                break;
+            }
+
+            case HLSInMemoryFileManagerStorageModeHierarchical: {
+                self.storage = [[HLSInMemoryHierarchicalStorage alloc] init];
+                break;
+            }
+
+            default: {
+                HLSLoggerError(@"Unknown storage mode");
+                return nil;
+            }
+        }
+
+        pthread_rwlock_init(&_lock, NULL);
+        
         self.cache = [[NSCache alloc] init];
         self.cache.delegate = self;
-        
+        self.entryKeys = [NSMutableDictionary dictionary];
+        self.fileKeys = [NSMutableDictionary dictionary];
+        self.evictionQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSInMemoryFileManager.eviction", DISPATCH_QUEUE_SERIAL);
+
         [[NSNotificationCenter defaultCenter] addObserver:self
                                                  selector:@selector(didReceiveMemoryWarning:)
                                                      name:UIApplicationDidReceiveMemoryWarningNotification
@@ -41,9 +78,16 @@
     return self;
 }
 
+- (instancetype)init
+{
+    return [self initWithStorageMode:HLSInMemoryFileManagerStorageModeHierarchical];
+}
+
 - (void)dealloc
 {
     [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
+    pthread_rwlock_destroy(&_lock);
 }
 
 #pragma mark Accessors and mutators
@@ -58,16 +102,39 @@
     self.cache.totalCostLimit = byteCostLimit;
 }
 
-#pragma mark Content management
+#pragma mark Locking
 
 /**
- * We use dictionaries to store directory structure and file names. A dictionary key is the name of a file or of a folder.
- * For folders, the corresponding value is a dictionary (which might be empty if the directory is empty). For files, the
- * value is a unique string identifier, pointing at the corresponding NSCache data entry
- *
- * Intermediate directories are created if they do not exist. If data is nil, a folder is added, otherwise a file
+ * Storage accesses are protected by a readers-writer lock. Cache accesses need no protection since NSCache is itself
+ * thread-safe
  */
-- (BOOL)addObjectAtPath:(NSString *)path withData:(NSData *)data error:(NSError *__autoreleasing *)pError
+- (void)lockForReading
+{
+    pthread_rwlock_rdlock(&_lock);
+}
+
+- (void)lockForWriting
+{
+    pthread_rwlock_wrlock(&_lock);
+    atomic_store(&_writingThread, pthread_self());
+}
+
+- (void)unlock
+{
+    if (pthread_equal(atomic_load(&_writingThread), pthread_self())) {
+        atomic_store(&_writingThread, NULL);
+    }
+    pthread_rwlock_unlock(&_lock);
+}
+
+- (BOOL)isLockedForWritingByCurrentThread
+{
+    return pthread_equal(atomic_load(&_writingThread), pthread_self());
+}
+
+#pragma mark Content management (the lock must be held when calling these methods)
+
+- (BOOL)checkPath:(NSString *)path error:(NSError *__autoreleasing *)pError
 {
     if (! [path hasPrefix:@"/"]) {
         if (pError) {
@@ -77,136 +144,73 @@
         }
         return NO;
     }
+    return YES;
+}
+
+- (BOOL)itemExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    if (! [self checkPath:path error:NULL]) {
+        return NO;
+    }
     
-    return [self addObjectAtPath:path toItems:self.rootItems withData:data error:pError];
+    return [self.storage itemExistsAtPath:path isDirectory:pIsDirectory];
 }
 
-- (BOOL)addObjectAtPath:(NSString *)path toItems:(NSMutableDictionary<NSString *, id> *)items withData:(NSData *)data error:(NSError *__autoreleasing *)pError
+- (BOOL)checkParentDirectoryForPath:(NSString *)path error:(NSError *__autoreleasing *)pError
 {
-    NSArray<NSString *> *pathComponents = path.pathComponents;
-    if (pathComponents.count == 0) {
+    BOOL isDirectory = NO;
+    NSString *parentPath = path.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtPath:parentPath isDirectory:&isDirectory] || ! isDirectory) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"Invalid path", nil)];
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), parentPath]];
         }
         return NO;
     }
-    
-    if (pathComponents.count == 1) {
-        NSString *objectName = pathComponents.firstObject;
-        
-        // File. If the file already exists, it will be replaced
-        if (data) {
-            NSString *oldUUID = items[objectName];
-            if (oldUUID) {
-                [self.cache removeObjectForKey:oldUUID];
-            }
-            
-            HLSInMemoryCacheEntry *cacheEntry = [[HLSInMemoryCacheEntry alloc] initWithParentItems:items
-                                                                                              name:objectName
-                                                                                              data:data];
-            
-            NSString *UUID = [NSUUID UUID].UUIDString;
-            items[objectName] = UUID;
-            [self.cache setObject:cacheEntry forKey:UUID cost:cacheEntry.cost];
-        }
-        // Folder. If the folder already exists, it is not replaced, and the method succeeds
-        else {
-            if (! items[objectName]) {
-                items[objectName] = [NSMutableDictionary dictionary];
-            }
-        }
-        
-        return YES;
-    }
-    else {
-        NSString *firstPathComponent = pathComponents.firstObject;
-        
-        // Create intermediate directories if needed
-        NSMutableDictionary<NSString *, id> *subitems = items[firstPathComponent];
-        if (! subitems) {
-            subitems = [NSMutableDictionary dictionary];
-            items[firstPathComponent] = subitems;
-        }
-        
-        // Go down one level deeper
-        NSArray<NSString *> *subpathComponents = [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)];
-        NSString *subpath = [NSString pathWithComponents:subpathComponents];
-        return [self addObjectAtPath:subpath toItems:subitems withData:data error:pError];
-    }
+    return YES;
 }
 
 /**
- * Copy the object from sourceItems having the specified name, to the destination dictionary. Fails if the source
- * is not found or if the destination already exists
+ * Check that a copy or move can be performed between the specified locations
  */
-- (BOOL)copyObjectWithName:(NSString *)sourceObjectName
-                   inItems:(NSDictionary<NSString *, id> *)sourceItems
-          toObjectWithName:(NSString *)destinationObjectName
-                   inItems:(NSMutableDictionary<NSString *, id> *)destinationItems
-                     error:(NSError *__autoreleasing *)pError
-{
-    // Retrieve the source content
-    id sourceContent = sourceItems[sourceObjectName];
-    if (! sourceContent) {
+- (BOOL)checkSourcePath:(NSString *)sourcePath destinationPath:(NSString *)destinationPath error:(NSError *__autoreleasing *)pError
+{
+    // Prevent recursive copy or move
+    if ([destinationPath hasPrefix:sourcePath]) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"File or directory not found", nil)];
+                                          code:NSFileReadInvalidFileNameError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination cannot be contained in the source", nil)];
         }
         return NO;
     }
     
-    if (destinationItems[destinationObjectName]) {
+    // The directory in which the source element is located must exist
+    BOOL isSourceParentDirectory = NO;
+    NSString *sourceParentPath = sourcePath.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtPath:sourceParentPath isDirectory:&isSourceParentDirectory] || ! isSourceParentDirectory) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileWriteFileExistsError
-                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"The source file or directory does not exist", nil)];
         }
         return NO;
     }
     
-    // Folder
-    if ([sourceContent isKindOfClass:[NSDictionary class]]) {
-        NSMutableDictionary<NSString *, id> *destinationSubitems = [NSMutableDictionary dictionary];
-        destinationItems[destinationObjectName] = destinationSubitems;
-        
-        for (NSString *subname in [sourceContent allKeys]) {
-            if (! [self copyObjectWithName:subname inItems:sourceContent toObjectWithName:subname inItems:destinationSubitems error:pError]) {
-                // FIXME: Should handle rollback more appropriately in case of failure!
-                return NO;
-            }
+    // The destination directory must exist
+    BOOL isDestinationParentDirectory = NO;
+    NSString *destinationParentPath = destinationPath.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtPath:destinationParentPath isDirectory:&isDestinationParentDirectory] || ! isDestinationParentDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination directory does not exist", nil)];
         }
-                
-        return YES;
-    }
-    // File UUID
-    else {
-        HLSInMemoryCacheEntry *sourceCacheEntry = [self.cache objectForKey:sourceContent];
-        
-        // Perform a deep copy of the source data
-        HLSInMemoryCacheEntry *destinationCacheEntry = [[HLSInMemoryCacheEntry alloc] initWithParentItems:destinationItems
-                                                                                                     name:destinationObjectName
-                                                                                                     data:[sourceCacheEntry.data copy]];
-        
-        NSString *UUID = [NSUUID UUID].UUIDString;
-        destinationItems[destinationObjectName] = UUID;
-        [self.cache setObject:destinationCacheEntry forKey:UUID cost:destinationCacheEntry.cost];
+        return NO;
     }
     
-    return YES;
-}
-
-- (BOOL)moveObjectWithName:(NSString *)sourceObjectName
-                   inItems:(NSMutableDictionary<NSString *, id> *)sourceItems
-          toObjectWithName:(NSString *)destinationObjectName
-                   inItems:(NSMutableDictionary<NSString *, id> *)destinationItems
-                     error:(NSError *__autoreleasing *)pError
-{
-    // Retrieve the source content
-    id sourceContent = sourceItems[sourceObjectName];
-    if (! sourceContent) {
+    if (! [self itemExistsAtPath:sourcePath isDirectory:NULL]) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
@@ -215,7 +219,7 @@
         return NO;
     }
     
-    if (destinationItems[destinationObjectName]) {
+    if ([self itemExistsAtPath:destinationPath isDirectory:NULL]) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileWriteFileExistsError
@@ -224,77 +228,123 @@
         return NO;
     }
     
-    // Unlink from source and link to destination folder. Very cheap
-    destinationItems[destinationObjectName] = sourceContent;
-    [sourceItems removeObjectForKey:sourceObjectName];
-    
     return YES;
 }
 
 /**
- * Return either a dictionary (folder) or a string identifier pointing to a cache entry (file)
+ * Files do not store their data directly, but reference a cache entry. Several files can share the same entry, which
+ * is removed from the cache when it is not referenced anymore. Copies are therefore cheap, and overwriting a copy
+ * only affects the copy itself (since the overwritten file then references a new entry)
  */
-- (id)contentAtPath:(NSString *)path forItems:(NSDictionary<NSString *, id> *)items
+- (void)retainCacheEntry:(HLSInMemoryCacheEntry *)cacheEntry forFileKey:(NSString *)fileKey
 {
-    NSArray<NSString *> *pathComponents = path.pathComponents;
-    if (pathComponents.count == 0) {
-        return nil;
+    self.entryKeys[fileKey] = cacheEntry.key;
+    
+    NSMutableSet<NSString *> *fileKeys = self.fileKeys[cacheEntry.key];
+    if (! fileKeys) {
+        fileKeys = [NSMutableSet set];
+        self.fileKeys[cacheEntry.key] = fileKeys;
+    }
+    [fileKeys addObject:fileKey];
+}
+
+- (void)releaseCacheEntryForFileKey:(NSString *)fileKey
+{
+    NSString *entryKey = self.entryKeys[fileKey];
+    if (! entryKey) {
+        return;
     }
     
-    NSString *firstPathComponent = pathComponents.firstObject;
-    id subitems = items[firstPathComponent];
+    [self.entryKeys removeObjectForKey:fileKey];
     
-    if (pathComponents.count == 1) {
-        return subitems;
+    NSMutableSet<NSString *> *fileKeys = self.fileKeys[entryKey];
+    [fileKeys removeObject:fileKey];
+    if (fileKeys.count == 0) {
+        [self.fileKeys removeObjectForKey:entryKey];
+        [self.cache removeObjectForKey:entryKey];
     }
-    else {
-        NSArray<NSString *> *subpathComponents = [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)];
-        NSString *subpath = [NSString pathWithComponents:subpathComponents];
-        return [self contentAtPath:subpath forItems:subitems];
-    }  
 }
 
-- (BOOL)removeItemWithName:(NSString *)name inItems:(NSMutableDictionary<NSString *, id> *)items error:(NSError *__autoreleasing *)pError
+/**
+ * Remove all files referencing an entry which has been evicted, notifying the delegate if data is provided
+ */
+- (void)removeFilesForCacheEntryKey:(NSString *)entryKey data:(NSData *)data
 {
-    id content = items[name];
-    if (! content) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"File or directory not found", nil)];
+    id<HLSInMemoryFileManagerDelegate> delegate = data ? self.delegate : nil;
+    BOOL notifyingDelegate = [delegate respondsToSelector:@selector(inMemoryFileManager:willEvictFileAtPath:contents:)];
+    
+    NSSet<NSString *> *fileKeys = self.fileKeys[entryKey];
+    for (NSString *fileKey in fileKeys) {
+        if (notifyingDelegate) {
+            NSString *path = [self.storage pathForFileKey:fileKey];
+            if (path) {
+                [delegate inMemoryFileManager:self willEvictFileAtPath:path contents:data];
+            }
         }
+        
+        [self.storage removeFileWithKey:fileKey];
+        [self.entryKeys removeObjectForKey:fileKey];
+    }
+    [self.fileKeys removeObjectForKey:entryKey];
+}
+
+- (BOOL)addFileAtPath:(NSString *)path contents:(NSData *)contents error:(NSError *__autoreleasing *)pError
+{
+    if (! [self checkPath:path error:pError]) {
         return NO;
     }
     
-    // Directory
-    if ([content isKindOfClass:[NSDictionary class]]) {
-        // Recursively remove content
-        NSArray<NSString *> *subnames = [content allKeys];
-        for (NSString *subname in subnames) {
-            [self removeItemWithName:subname inItems:content error:NULL];
+    // Must fail if the parent directory does not exist
+    if (! [self checkParentDirectoryForPath:path error:pError]) {
+        return NO;
+    }
+    
+    // Directories cannot be replaced with files
+    BOOL isDirectory = NO;
+    if ([self.storage itemExistsAtPath:path isDirectory:&isDirectory] && isDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
         }
+        return NO;
     }
-    // File
-    else {
-        [self.cache removeObjectForKey:content];
+    
+    // If the file already exists, it will be replaced
+    NSString *fileKey = [NSUUID UUID].UUIDString;
+    NSString *replacedFileKey = [self.storage setFileKey:fileKey atPath:path];
+    if (replacedFileKey) {
+        [self releaseCacheEntryForFileKey:replacedFileKey];
     }
     
-    [items removeObjectForKey:name];
+    HLSInMemoryCacheEntry *cacheEntry = [[HLSInMemoryCacheEntry alloc] initWithData:contents];
+    [self retainCacheEntry:cacheEntry forFileKey:fileKey];
+    [self.cache setObject:cacheEntry forKey:cacheEntry.key cost:cacheEntry.cost];
     return YES;
 }
 
-- (BOOL)checkParentDirectoryForPath:(NSString *)path error:(NSError *__autoreleasing *)pError
+- (BOOL)addDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(NSError *__autoreleasing *)pError
 {
-    BOOL isDirectory = NO;
-    NSString *parentPath = path.stringByDeletingLastPathComponent;    
-    if (! [self fileExistsAtPath:parentPath isDirectory:&isDirectory] || ! isDirectory) {
+    if (! [self checkPath:path error:pError]) {
+        return NO;
+    }
+    
+    if (! withIntermediateDirectories) {
+        if (! [self checkParentDirectoryForPath:path error:pError]) {
+            return NO;
+        }
+    }
+    
+    // If the directory already exists, it is not replaced, and the method succeeds
+    if (! [self.storage createDirectoryAtPath:path]) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), parentPath]];
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"Invalid file path", nil)];
         }
         return NO;
     }
+    
     return YES;
 }
 
@@ -302,8 +352,14 @@
 
 - (NSData *)contentsOfFileAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
 {
-    id content = [self contentAtPath:path forItems:self.rootItems];
-    if (! content || ! [content isKindOfClass:[NSString class]]) {
+    [self lockForReading];
+    NSString *fileKey = [self checkPath:path error:NULL] ? [self.storage fileKeyAtPath:path] : nil;
+    NSString *entryKey = fileKey ? self.entryKeys[fileKey] : nil;
+    [self unlock];
+    
+    // The cache entry might have been evicted in the meantime
+    HLSInMemoryCacheEntry *cacheEntry = entryKey ? [self.cache objectForKey:entryKey] : nil;
+    if (! cacheEntry) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
@@ -312,7 +368,6 @@
         return nil;
     }
     
-    HLSInMemoryCacheEntry *cacheEntry = [self.cache objectForKey:content];
     return cacheEntry.data;
 }
 
@@ -327,29 +382,27 @@
         return NO;
     }
     
-    // Must fail if the parent directory does not exist
-    if (! [self checkParentDirectoryForPath:path error:pError]) {
-        return NO;
-    }
-    
-    return [self addObjectAtPath:path withData:contents error:pError];
+    [self lockForWriting];
+    BOOL created = [self addFileAtPath:path contents:contents error:pError];
+    [self unlock];
+    return created;
 }
 
 - (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(out NSError *__autoreleasing *)pError
 {
-    if (! withIntermediateDirectories) {
-        if (! [self checkParentDirectoryForPath:path error:pError]) {
-            return NO;
-        }
-    }
-    
-    return [self addObjectAtPath:path withData:nil error:pError];
+    [self lockForWriting];
+    BOOL created = [self addDirectoryAtPath:path withIntermediateDirectories:withIntermediateDirectories error:pError];
+    [self unlock];
+    return created;
 }
 
 - (NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
 {
-    id subitems = [self contentAtPath:path forItems:self.rootItems];
-    if (! [subitems isKindOfClass:[NSDictionary class]]) {
+    [self lockForReading];
+    NSArray<NSString *> *contents = [self checkPath:path error:NULL] ? [self.storage contentsOfDirectoryAtPath:path] : nil;
+    [self unlock];
+    
+    if (! contents) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
@@ -358,110 +411,113 @@
         return nil;
     }
     
-    return [subitems allKeys];
+    return contents;
 }
 
-- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(out BOOL *)pIsDirectory
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
 {
-    id subitems = [self contentAtPath:path forItems:self.rootItems];
-    if (! subitems) {
-        return NO;
-    }
+    NSParameterAssert(block);
     
-    if (pIsDirectory) {
-        *pIsDirectory = [subitems isKindOfClass:[NSDictionary class]];
-    }
+    // Items are collected in a single pass over the hierarchy, and delivered once the lock has been released so that
+    // the block can safely call the file manager. Files sharing data have the date at which the data was written
+    NSMutableArray<HLSFileItem *> *items = [NSMutableArray array];
     
-    return YES;
-}
-
-- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
-{
-    // Prevent recursive copy
-    if ([destinationPath hasPrefix:sourcePath]) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileReadInvalidFileNameError
-                          localizedDescription:CoconutKitLocalizedString(@"The destination cannot be contained in the source", nil)];
+    [self lockForReading];
+    BOOL enumerated = [self checkPath:path error:NULL] && [self.storage enumerateItemsAtPath:path maximumDepth:maximumDepth usingBlock:^(NSString *itemPath, NSString *fileKey, NSUInteger depth) {
+        if (fileKey) {
+            NSString *entryKey = self.entryKeys[fileKey];
+            HLSInMemoryCacheEntry *cacheEntry = entryKey ? [self.cache objectForKey:entryKey] : nil;
+            if (! cacheEntry) {
+                return;
+            }
+            
+            [items addObject:[[HLSFileItem alloc] initWithPath:itemPath directory:NO size:cacheEntry.data.length modificationDate:cacheEntry.creationDate depth:depth]];
         }
-        return NO;
-    }
+        else {
+            [items addObject:[[HLSFileItem alloc] initWithPath:itemPath directory:YES size:0 modificationDate:nil depth:depth]];
+        }
+    }];
+    [self unlock];
     
-    // Get the directory in which the element to copy is located
-    id sourceContent = [self contentAtPath:sourcePath.stringByDeletingLastPathComponent forItems:self.rootItems];
-    if (! [sourceContent isKindOfClass:[NSDictionary class]]) {
+    if (! enumerated) {
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"The source file or directory does not exist", nil)];
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), path]];
         }
         return NO;
     }
     
-    // Get the destination directory contents
-    id destinationContent = [self contentAtPath:destinationPath.stringByDeletingLastPathComponent forItems:self.rootItems];
-    if (! [destinationContent isKindOfClass:[NSDictionary class]]) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"The destination directory does not exist", nil)];
+    BOOL stop = NO;
+    for (HLSFileItem *item in items) {
+        block(item, &stop);
+        if (stop) {
+            break;
         }
-        return NO;
     }
-    
-    return [self copyObjectWithName:sourcePath.lastPathComponent
-                            inItems:sourceContent
-                   toObjectWithName:destinationPath.lastPathComponent
-                            inItems:destinationContent
-                              error:pError];
+    return YES;
 }
 
-- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(out BOOL *)pIsDirectory
 {
-    // Prevent recursive move
-    if ([destinationPath hasPrefix:sourcePath]) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileReadInvalidFileNameError
-                          localizedDescription:CoconutKitLocalizedString(@"The destination cannot be contained in the source", nil)];
-        }
-        return NO;
-    }
+    [self lockForReading];
+    BOOL exists = [self itemExistsAtPath:path isDirectory:pIsDirectory];
+    [self unlock];
+    return exists;
+}
+
+- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    [self lockForWriting];
     
-    // Get the directory in which the element to move is located
-    id sourceContent = [self contentAtPath:sourcePath.stringByDeletingLastPathComponent forItems:self.rootItems];
-    if (! [sourceContent isKindOfClass:[NSDictionary class]]) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"The source file or directory does not exist", nil)];
-        }
+    if (! [self checkSourcePath:sourcePath destinationPath:destinationPath error:pError]) {
+        [self unlock];
         return NO;
     }
     
-    // Get the destination directory contents
-    id destinationContent = [self contentAtPath:destinationPath.stringByDeletingLastPathComponent forItems:self.rootItems];
-    if (! [destinationContent isKindOfClass:[NSDictionary class]]) {
-        if (pError) {
-            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
-                                          code:NSFileNoSuchFileError
-                          localizedDescription:CoconutKitLocalizedString(@"The destination directory does not exist", nil)];
+    // Copies share the source cache entry. No data is copied, and the cache cost is unchanged
+    [self.storage copyItemAtPath:sourcePath toPath:destinationPath withFileKeyBlock:^NSString *(NSString *fileKey) {
+        NSString *entryKey = self.entryKeys[fileKey];
+        HLSInMemoryCacheEntry *cacheEntry = entryKey ? [self.cache objectForKey:entryKey] : nil;
+        if (! cacheEntry) {
+            return nil;
         }
+        
+        NSString *destinationFileKey = [NSUUID UUID].UUIDString;
+        [self retainCacheEntry:cacheEntry forFileKey:destinationFileKey];
+        return destinationFileKey;
+    }];
+    
+    [self unlock];
+    return YES;
+}
+
+- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    [self lockForWriting];
+    
+    if (! [self checkSourcePath:sourcePath destinationPath:destinationPath error:pError]) {
+        [self unlock];
         return NO;
     }
     
-    return  [self moveObjectWithName:sourcePath.lastPathComponent
-                             inItems:sourceContent
-                    toObjectWithName:destinationPath.lastPathComponent
-                             inItems:destinationContent
-                               error:pError];
+    // Unlink from source and link to destination folder
+    [self.storage moveItemAtPath:sourcePath toPath:destinationPath];
+    
+    [self unlock];
+    return YES;
 }
 
 - (BOOL)removeItemAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
 {
-    // Get the directory in which the element to delete is located
-    id content = [self contentAtPath:path.stringByDeletingLastPathComponent forItems:self.rootItems];
-    if (! [content isKindOfClass:[NSDictionary class]]) {
+    [self lockForWriting];
+    
+    if (! [self itemExistsAtPath:path isDirectory:NULL]) {
+        [self unlock];
+        
         if (pError) {
             *pError = [NSError errorWithDomain:NSCocoaErrorDomain
                                           code:NSFileNoSuchFileError
@@ -470,29 +526,79 @@
         return NO;
     }
     
-    // Never delete the root, rather delete all its contents
-    NSArray<NSString *> *pathComponents = path.pathComponents;
-    if (pathComponents.count == 1 && [pathComponents.firstObject isEqualToString:@"/"]) {
-        for (NSString *name in [content allKeys]) {
-            if (! [self removeItemWithName:name inItems:content error:NULL]) {
-                HLSLoggerWarn(@"Could not remove %@", name);
-            }
-        }
-        return YES;
+    // Never deletes the root, rather deletes all its contents
+    [self.storage removeItemAtPath:path withFileKeyBlock:^(NSString *fileKey) {
+        [self releaseCacheEntryForFileKey:fileKey];
+    }];
+    
+    [self unlock];
+    return YES;
+}
+
+#pragma mark HLSFileManagerStreamSupport protocol implementation
+
+- (NSInputStream *)inputStreamWithFileAtPath:(NSString *)path
+{
+    // The stream reads the cached bytes directly. Since cached data is immutable, it is never copied
+    NSData *data = [self contentsOfFileAtPath:path error:NULL];
+    if (! data) {
+        return nil;
     }
-    else {
-        NSString *name = path.lastPathComponent;
-        return [self removeItemWithName:name inItems:content error:pError];
+    
+    return [NSInputStream inputStreamWithData:data];
+}
+
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append
+{
+    [self lockForReading];
+    BOOL isDirectory = NO;
+    BOOL exists = [self itemExistsAtPath:path isDirectory:&isDirectory];
+    BOOL valid = [self checkPath:path error:NULL] && [self checkParentDirectoryForPath:path error:NULL] && ! (exists && isDirectory);
+    [self unlock];
+    
+    if (! valid) {
+        return nil;
     }
+    
+    // When appending, the stream starts with the file contents available at creation time
+    NSData *initialData = (append && exists) ? [self contentsOfFileAtPath:path error:NULL] : nil;
+    return [[HLSInMemoryOutputStream alloc] initWithData:initialData commitBlock:^(NSData *data) {
+        NSError *error = nil;
+        if (! [self createFileAtPath:path contents:data error:&error]) {
+            HLSLoggerWarn(@"Could not commit output stream data to %@. Reason: %@", path, error);
+        }
+    }];
 }
 
 #pragma mark NSCacheDelegate protocol implementation
 
 - (void)cache:(NSCache *)cache willEvictObject:(id)object
 {
-    // Remove the corresponding entry from the rootItems dictionary hierarchy
+    // Remove the corresponding entry from the file hierarchy. If the eviction results from a mutation made by the
+    // current thread, the lock is already held and the storage can be updated directly. Otherwise the cache might
+    // be calling us while holding its own internal lock, and we must not block on ours to avoid deadlocks. Readers
+    // already deal with keys whose cache entry has vanished, the storage update can therefore be safely deferred.
+    // Data is only kept alive until then if the delegate needs it
     HLSInMemoryCacheEntry *cacheEntry = object;
-    [cacheEntry.parentItems removeObjectForKey:cacheEntry.name];
+    NSData *data = self.delegate ? cacheEntry.data : nil;
+    if ([self isLockedForWritingByCurrentThread]) {
+        [self removeFilesForCacheEntryKey:cacheEntry.key data:data];
+    }
+    else {
+        NSString *entryKey = cacheEntry.key;
+        dispatch_async(self.evictionQueue, ^{
+            [self lockForWriting];
+            [self removeFilesForCacheEntryKey:entryKey data:data];
+            [self unlock];
+        });
+    }
+}
+
+#pragma mark Eviction management
+
+- (void)waitUntilEvictionsAreProcessed
+{
+    dispatch_sync(self.evictionQueue, ^{});
 }
 
 #pragma mark Notification callbacks
@@ -506,10 +612,14 @@
 
 - (NSString *)description
 {
-    return [NSString stringWithFormat:@"<%@: %p; rootItems: %@; cache: %@>",
+    [self lockForReading];
+    NSString *storageDescription = [self.storage description];
+    [self unlock];
+    
+    return [NSString stringWithFormat:@"<%@: %p; storage: %@; cache: %@>",
             [self class],
             self,
-            self.rootItems,
+            storageDescription,
             self.cache];
 }
 
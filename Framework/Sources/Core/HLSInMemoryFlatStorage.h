@@ -0,0 +1,22 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryStorage.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private storage for HLSInMemoryFileManager, indexing all files and directories by their full normalized path. Each
+ * directory additionally indexes its children by name. Existence checks, reads and writes are therefore performed
+ * with a single hash lookup, whatever the depth of the hierarchy
+ */
+@interface HLSInMemoryFlatStorage : NSObject <HLSInMemoryStorage>
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,326 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryFlatStorage.h"
+
+#import "HLSFileManager+Friend.h"
+
+/**
+ * A file (if it has a file key) or a directory (otherwise) within the storage
+ */
+@interface HLSInMemoryNode : NSObject
+
+- (instancetype)initWithFileKey:(NSString *)fileKey;
+
+@property (nonatomic, copy) NSString *path;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSString *fileKey;
+@property (nonatomic, weak) HLSInMemoryNode *parentNode;
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, HLSInMemoryNode *> *childNodes;        // Child index (directories only)
+
+@property (nonatomic, readonly, getter=isDirectory) BOOL directory;
+
+@end
+
+@interface HLSInMemoryFlatStorage ()
+
+@property (nonatomic) NSMutableDictionary<NSString *, HLSInMemoryNode *> *nodes;            // Index of all items, by normalized path
+@property (nonatomic) NSMutableDictionary<NSString *, HLSInMemoryNode *> *fileNodes;        // Index of all files, by file key
+
+@end
+
+@implementation HLSInMemoryFlatStorage
+
+#pragma mark Object creation and destruction
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        HLSInMemoryNode *rootNode = [[HLSInMemoryNode alloc] initWithFileKey:nil];
+        rootNode.path = @"/";
+        rootNode.name = @"/";
+
+        self.nodes = [NSMutableDictionary dictionaryWithObject:rootNode forKey:@"/"];
+        self.fileNodes = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark Index management
+
+- (HLSInMemoryNode *)nodeAtPath:(NSString *)path
+{
+    return self.nodes[HLSFileManagerNormalizedPath(path)];
+}
+
+- (void)linkNode:(HLSInMemoryNode *)node withPath:(NSString *)path toParentNode:(HLSInMemoryNode *)parentNode
+{
+    node.path = path;
+    node.name = path.lastPathComponent;
+    node.parentNode = parentNode;
+
+    parentNode.childNodes[node.name] = node;
+    self.nodes[path] = node;
+    if (node.fileKey) {
+        self.fileNodes[node.fileKey] = node;
+    }
+}
+
+/**
+ * Remove a node and its descendants from the indexes
+ */
+- (void)unlinkNode:(HLSInMemoryNode *)node withFileKeyBlock:(void (^)(NSString *fileKey))fileKeyBlock
+{
+    for (HLSInMemoryNode *childNode in node.childNodes.allValues) {
+        [self unlinkNode:childNode withFileKeyBlock:fileKeyBlock];
+    }
+
+    [node.parentNode.childNodes removeObjectForKey:node.name];
+    [self.nodes removeObjectForKey:node.path];
+
+    if (node.fileKey) {
+        [self.fileNodes removeObjectForKey:node.fileKey];
+        if (fileKeyBlock) {
+            fileKeyBlock(node.fileKey);
+        }
+    }
+}
+
+/**
+ * Return the directory node at the specified normalized path, creating it (and intermediate directories) if needed.
+ * Return nil if a file is found along the way
+ */
+- (HLSInMemoryNode *)directoryNodeAtNormalizedPath:(NSString *)path
+{
+    HLSInMemoryNode *node = self.nodes[path];
+    if (node) {
+        return node.directory ? node : nil;
+    }
+
+    HLSInMemoryNode *parentNode = [self directoryNodeAtNormalizedPath:path.stringByDeletingLastPathComponent];
+    if (! parentNode) {
+        return nil;
+    }
+
+    node = [[HLSInMemoryNode alloc] initWithFileKey:nil];
+    [self linkNode:node withPath:path toParentNode:parentNode];
+    return node;
+}
+
+- (void)copyNode:(HLSInMemoryNode *)sourceNode
+          toPath:(NSString *)destinationPath
+    inParentNode:(HLSInMemoryNode *)destinationParentNode
+withFileKeyBlock:(NSString * (^)(NSString *fileKey))fileKeyBlock
+{
+    if (sourceNode.directory) {
+        HLSInMemoryNode *destinationNode = [[HLSInMemoryNode alloc] initWithFileKey:nil];
+        [self linkNode:destinationNode withPath:destinationPath toParentNode:destinationParentNode];
+
+        for (HLSInMemoryNode *sourceChildNode in sourceNode.childNodes.allValues) {
+            [self copyNode:sourceChildNode
+                    toPath:[destinationPath stringByAppendingPathComponent:sourceChildNode.name]
+              inParentNode:destinationNode
+          withFileKeyBlock:fileKeyBlock];
+        }
+    }
+    else {
+        NSString *fileKey = fileKeyBlock(sourceNode.fileKey);
+        if (fileKey) {
+            HLSInMemoryNode *destinationNode = [[HLSInMemoryNode alloc] initWithFileKey:fileKey];
+            [self linkNode:destinationNode withPath:destinationPath toParentNode:destinationParentNode];
+        }
+    }
+}
+
+- (void)enumerateChildNodesOfNode:(HLSInMemoryNode *)node
+                            depth:(NSUInteger)depth
+                     maximumDepth:(NSUInteger)maximumDepth
+                       usingBlock:(void (^)(NSString *itemPath, NSString *fileKey, NSUInteger depth))block
+{
+    for (HLSInMemoryNode *childNode in node.childNodes.allValues) {
+        block(childNode.path, childNode.fileKey, depth);
+        if (childNode.directory && (maximumDepth == 0 || depth < maximumDepth)) {
+            [self enumerateChildNodesOfNode:childNode depth:depth + 1 maximumDepth:maximumDepth usingBlock:block];
+        }
+    }
+}
+
+/**
+ * Update the path index for a node and its descendants
+ */
+- (void)relinkNode:(HLSInMemoryNode *)node withPath:(NSString *)path toParentNode:(HLSInMemoryNode *)parentNode
+{
+    [self.nodes removeObjectForKey:node.path];
+    [self linkNode:node withPath:path toParentNode:parentNode];
+
+    for (HLSInMemoryNode *childNode in node.childNodes.allValues) {
+        [self relinkNode:childNode withPath:[path stringByAppendingPathComponent:childNode.name] toParentNode:node];
+    }
+}
+
+#pragma mark HLSInMemoryStorage protocol implementation
+
+- (BOOL)itemExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    HLSInMemoryNode *node = [self nodeAtPath:path];
+    if (! node) {
+        return NO;
+    }
+
+    if (pIsDirectory) {
+        *pIsDirectory = node.directory;
+    }
+    return YES;
+}
+
+- (NSString *)fileKeyAtPath:(NSString *)path
+{
+    return [self nodeAtPath:path].fileKey;
+}
+
+- (NSString *)pathForFileKey:(NSString *)fileKey
+{
+    return self.fileNodes[fileKey].path;
+}
+
+- (NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path
+{
+    HLSInMemoryNode *node = [self nodeAtPath:path];
+    return node.directory ? node.childNodes.allKeys : nil;
+}
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                  usingBlock:(void (^)(NSString *itemPath, NSString *fileKey, NSUInteger depth))block
+{
+    NSParameterAssert(block);
+
+    HLSInMemoryNode *node = [self nodeAtPath:path];
+    if (! node.directory) {
+        return NO;
+    }
+
+    [self enumerateChildNodesOfNode:node depth:1 maximumDepth:maximumDepth usingBlock:block];
+    return YES;
+}
+
+- (NSString *)setFileKey:(NSString *)fileKey atPath:(NSString *)path
+{
+    NSParameterAssert(fileKey);
+
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+
+    // Replace the content of an existing file
+    HLSInMemoryNode *node = self.nodes[normalizedPath];
+    if (node) {
+        NSString *replacedFileKey = node.fileKey;
+        [self.fileNodes removeObjectForKey:replacedFileKey];
+
+        node.fileKey = fileKey;
+        self.fileNodes[fileKey] = node;
+        return replacedFileKey;
+    }
+
+    HLSInMemoryNode *parentNode = self.nodes[normalizedPath.stringByDeletingLastPathComponent];
+    node = [[HLSInMemoryNode alloc] initWithFileKey:fileKey];
+    [self linkNode:node withPath:normalizedPath toParentNode:parentNode];
+    return nil;
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path
+{
+    return [self directoryNodeAtNormalizedPath:HLSFileManagerNormalizedPath(path)] != nil;
+}
+
+- (void)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath withFileKeyBlock:(NSString * (^)(NSString *fileKey))fileKeyBlock
+{
+    NSParameterAssert(fileKeyBlock);
+
+    HLSInMemoryNode *sourceNode = [self nodeAtPath:sourcePath];
+    NSString *normalizedDestinationPath = HLSFileManagerNormalizedPath(destinationPath);
+    HLSInMemoryNode *destinationParentNode = self.nodes[normalizedDestinationPath.stringByDeletingLastPathComponent];
+    [self copyNode:sourceNode toPath:normalizedDestinationPath inParentNode:destinationParentNode withFileKeyBlock:fileKeyBlock];
+}
+
+- (void)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath
+{
+    HLSInMemoryNode *node = [self nodeAtPath:sourcePath];
+    [node.parentNode.childNodes removeObjectForKey:node.name];
+
+    NSString *normalizedDestinationPath = HLSFileManagerNormalizedPath(destinationPath);
+    HLSInMemoryNode *destinationParentNode = self.nodes[normalizedDestinationPath.stringByDeletingLastPathComponent];
+    [self relinkNode:node withPath:normalizedDestinationPath toParentNode:destinationParentNode];
+}
+
+- (void)removeItemAtPath:(NSString *)path withFileKeyBlock:(void (^)(NSString *fileKey))fileKeyBlock
+{
+    HLSInMemoryNode *node = [self nodeAtPath:path];
+
+    // Never delete the root, rather delete all its contents
+    if (! node.parentNode) {
+        for (HLSInMemoryNode *childNode in node.childNodes.allValues) {
+            [self unlinkNode:childNode withFileKeyBlock:fileKeyBlock];
+        }
+    }
+    else {
+        [self unlinkNode:node withFileKeyBlock:fileKeyBlock];
+    }
+}
+
+- (void)removeFileWithKey:(NSString *)fileKey
+{
+    HLSInMemoryNode *node = self.fileNodes[fileKey];
+    if (node) {
+        [self unlinkNode:node withFileKeyBlock:nil];
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; paths: %@>",
+            [self class],
+            self,
+            self.nodes.allKeys];
+}
+
+@end
+
+@implementation HLSInMemoryNode
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithFileKey:(NSString *)fileKey
+{
+    if (self = [super init]) {
+        self.fileKey = fileKey;
+        if (! fileKey) {
+            _childNodes = [NSMutableDictionary dictionary];
+        }
+    }
+    return self;
+}
+
+#pragma mark Accessors and mutators
+
+- (BOOL)isDirectory
+{
+    return self.fileKey == nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; path: %@; fileKey: %@>",
+            [self class],
+            self,
+            self.path,
+            self.fileKey];
+}
+
+@end
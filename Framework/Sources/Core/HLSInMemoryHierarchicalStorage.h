@@ -0,0 +1,21 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryStorage.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private storage for HLSInMemoryFileManager, mirroring the file hierarchy with nested dictionaries. Paths are resolved
+ * by walking down the hierarchy one component at a time
+ */
+@interface HLSInMemoryHierarchicalStorage : NSObject <HLSInMemoryStorage>
+
+@end
+
+NS_ASSUME_NONNULL_END
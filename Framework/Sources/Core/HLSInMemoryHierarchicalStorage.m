@@ -0,0 +1,350 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryHierarchicalStorage.h"
+
+@interface HLSInMemoryHierarchicalStorage ()
+
+@property (nonatomic) NSMutableDictionary<NSString *, id> *rootItems;                                               // Stores the directory / file hierarchy
+@property (nonatomic) NSMutableDictionary<NSString *, NSMutableDictionary<NSString *, id> *> *parentItemsForFileKeys;   // Parent directory of each file
+
+@end
+
+@implementation HLSInMemoryHierarchicalStorage
+
+#pragma mark Object creation and destruction
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        self.rootItems = [NSMutableDictionary dictionaryWithObject:[NSMutableDictionary dictionary] forKey:@"/"];
+        self.parentItemsForFileKeys = [NSMutableDictionary dictionary];
+    }
+    return self;
+}
+
+#pragma mark Content management
+
+/**
+ * We use dictionaries to store directory structure and file names. A dictionary key is the name of a file or of a folder.
+ * For folders, the corresponding value is a dictionary (which might be empty if the directory is empty). For files, the
+ * value is a unique string identifier, pointing at the corresponding NSCache data entry
+ *
+ * Intermediate directories are created if they do not exist. If fileKey is nil, a folder is added, otherwise a file
+ */
+- (BOOL)addObjectAtPath:(NSString *)path
+                toItems:(NSMutableDictionary<NSString *, id> *)items
+            withFileKey:(NSString *)fileKey
+        replacedFileKey:(NSString *__autoreleasing *)pReplacedFileKey
+{
+    NSArray<NSString *> *pathComponents = path.pathComponents;
+    if (pathComponents.count == 0) {
+        return NO;
+    }
+
+    if (pathComponents.count == 1) {
+        NSString *objectName = pathComponents.firstObject;
+
+        // File. If the file already exists, it will be replaced
+        if (fileKey) {
+            NSString *oldFileKey = items[objectName];
+            if (oldFileKey) {
+                [self.parentItemsForFileKeys removeObjectForKey:oldFileKey];
+                if (pReplacedFileKey) {
+                    *pReplacedFileKey = oldFileKey;
+                }
+            }
+
+            items[objectName] = fileKey;
+            self.parentItemsForFileKeys[fileKey] = items;
+        }
+        // Folder. If the folder already exists, it is not replaced, and the method succeeds
+        else {
+            if (! items[objectName]) {
+                items[objectName] = [NSMutableDictionary dictionary];
+            }
+        }
+
+        return YES;
+    }
+    else {
+        NSString *firstPathComponent = pathComponents.firstObject;
+
+        // Create intermediate directories if needed
+        id subitems = items[firstPathComponent];
+        if (! subitems) {
+            subitems = [NSMutableDictionary dictionary];
+            items[firstPathComponent] = subitems;
+        }
+        else if (! [subitems isKindOfClass:[NSDictionary class]]) {
+            return NO;
+        }
+
+        // Go down one level deeper
+        NSArray<NSString *> *subpathComponents = [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)];
+        NSString *subpath = [NSString pathWithComponents:subpathComponents];
+        return [self addObjectAtPath:subpath toItems:subitems withFileKey:fileKey replacedFileKey:pReplacedFileKey];
+    }
+}
+
+/**
+ * Return either a dictionary (folder) or a string identifier pointing to a cache entry (file)
+ */
+- (id)contentAtPath:(NSString *)path forItems:(NSDictionary<NSString *, id> *)items
+{
+    NSArray<NSString *> *pathComponents = path.pathComponents;
+    if (pathComponents.count == 0) {
+        return nil;
+    }
+
+    NSString *firstPathComponent = pathComponents.firstObject;
+    id subitems = items[firstPathComponent];
+
+    if (pathComponents.count == 1) {
+        return subitems;
+    }
+    else if (! [subitems isKindOfClass:[NSDictionary class]]) {
+        return nil;
+    }
+    else {
+        NSArray<NSString *> *subpathComponents = [pathComponents subarrayWithRange:NSMakeRange(1, pathComponents.count - 1)];
+        NSString *subpath = [NSString pathWithComponents:subpathComponents];
+        return [self contentAtPath:subpath forItems:subitems];
+    }
+}
+
+/**
+ * Return the path of the specified items dictionary, searched recursively from the given items (located at the given
+ * path). Return nil if not found
+ */
+- (NSString *)pathForItems:(NSDictionary<NSString *, id> *)items inItems:(NSDictionary<NSString *, id> *)currentItems atPath:(NSString *)path
+{
+    if (currentItems == items) {
+        return path;
+    }
+    
+    for (NSString *name in currentItems) {
+        id subitems = currentItems[name];
+        if (! [subitems isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        
+        NSString *subpath = [self pathForItems:items inItems:subitems atPath:[path stringByAppendingPathComponent:name]];
+        if (subpath) {
+            return subpath;
+        }
+    }
+    return nil;
+}
+
+- (void)enumerateItems:(NSDictionary<NSString *, id> *)items
+                atPath:(NSString *)path
+                 depth:(NSUInteger)depth
+          maximumDepth:(NSUInteger)maximumDepth
+            usingBlock:(void (^)(NSString *itemPath, NSString *fileKey, NSUInteger depth))block
+{
+    for (NSString *name in items) {
+        id content = items[name];
+        NSString *itemPath = [path stringByAppendingPathComponent:name];
+        
+        if ([content isKindOfClass:[NSDictionary class]]) {
+            block(itemPath, nil, depth);
+            if (maximumDepth == 0 || depth < maximumDepth) {
+                [self enumerateItems:content atPath:itemPath depth:depth + 1 maximumDepth:maximumDepth usingBlock:block];
+            }
+        }
+        else {
+            block(itemPath, content, depth);
+        }
+    }
+}
+
+- (void)copyObjectWithName:(NSString *)sourceObjectName
+                   inItems:(NSDictionary<NSString *, id> *)sourceItems
+          toObjectWithName:(NSString *)destinationObjectName
+                   inItems:(NSMutableDictionary<NSString *, id> *)destinationItems
+          withFileKeyBlock:(NSString * (^)(NSString *fileKey))fileKeyBlock
+{
+    id sourceContent = sourceItems[sourceObjectName];
+
+    // Folder
+    if ([sourceContent isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary<NSString *, id> *destinationSubitems = [NSMutableDictionary dictionary];
+        destinationItems[destinationObjectName] = destinationSubitems;
+
+        for (NSString *subname in [sourceContent allKeys]) {
+            [self copyObjectWithName:subname inItems:sourceContent toObjectWithName:subname inItems:destinationSubitems withFileKeyBlock:fileKeyBlock];
+        }
+    }
+    // File key
+    else if (sourceContent) {
+        NSString *fileKey = fileKeyBlock(sourceContent);
+        if (fileKey) {
+            destinationItems[destinationObjectName] = fileKey;
+            self.parentItemsForFileKeys[fileKey] = destinationItems;
+        }
+    }
+}
+
+- (void)removeItemWithName:(NSString *)name inItems:(NSMutableDictionary<NSString *, id> *)items withFileKeyBlock:(void (^)(NSString *fileKey))fileKeyBlock
+{
+    id content = items[name];
+
+    // Directory
+    if ([content isKindOfClass:[NSDictionary class]]) {
+        // Recursively remove content
+        NSArray<NSString *> *subnames = [content allKeys];
+        for (NSString *subname in subnames) {
+            [self removeItemWithName:subname inItems:content withFileKeyBlock:fileKeyBlock];
+        }
+    }
+    // File
+    else if (content) {
+        [self.parentItemsForFileKeys removeObjectForKey:content];
+        if (fileKeyBlock) {
+            fileKeyBlock(content);
+        }
+    }
+
+    [items removeObjectForKey:name];
+}
+
+#pragma mark HLSInMemoryStorage protocol implementation
+
+- (BOOL)itemExistsAtPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    id content = [self contentAtPath:path forItems:self.rootItems];
+    if (! content) {
+        return NO;
+    }
+
+    if (pIsDirectory) {
+        *pIsDirectory = [content isKindOfClass:[NSDictionary class]];
+    }
+    return YES;
+}
+
+- (NSString *)fileKeyAtPath:(NSString *)path
+{
+    id content = [self contentAtPath:path forItems:self.rootItems];
+    return [content isKindOfClass:[NSString class]] ? content : nil;
+}
+
+- (NSString *)pathForFileKey:(NSString *)fileKey
+{
+    NSDictionary<NSString *, id> *parentItems = self.parentItemsForFileKeys[fileKey];
+    if (! parentItems) {
+        return nil;
+    }
+    
+    // Directories do not know their location. Requires a search through the hierarchy
+    NSString *parentPath = [self pathForItems:parentItems inItems:self.rootItems[@"/"] atPath:@"/"];
+    NSString *name = [parentItems allKeysForObject:fileKey].firstObject;
+    return (parentPath && name) ? [parentPath stringByAppendingPathComponent:name] : nil;
+}
+
+- (NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path
+{
+    id content = [self contentAtPath:path forItems:self.rootItems];
+    return [content isKindOfClass:[NSDictionary class]] ? [content allKeys] : nil;
+}
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                  usingBlock:(void (^)(NSString *itemPath, NSString *fileKey, NSUInteger depth))block
+{
+    NSParameterAssert(block);
+
+    id content = [self contentAtPath:path forItems:self.rootItems];
+    if (! [content isKindOfClass:[NSDictionary class]]) {
+        return NO;
+    }
+
+    [self enumerateItems:content atPath:path depth:1 maximumDepth:maximumDepth usingBlock:block];
+    return YES;
+}
+
+- (NSString *)setFileKey:(NSString *)fileKey atPath:(NSString *)path
+{
+    NSParameterAssert(fileKey);
+
+    NSString *replacedFileKey = nil;
+    [self addObjectAtPath:path toItems:self.rootItems withFileKey:fileKey replacedFileKey:&replacedFileKey];
+    return replacedFileKey;
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path
+{
+    return [self addObjectAtPath:path toItems:self.rootItems withFileKey:nil replacedFileKey:NULL];
+}
+
+- (void)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath withFileKeyBlock:(NSString * (^)(NSString *fileKey))fileKeyBlock
+{
+    NSParameterAssert(fileKeyBlock);
+
+    NSDictionary<NSString *, id> *sourceItems = [self contentAtPath:sourcePath.stringByDeletingLastPathComponent forItems:self.rootItems];
+    NSMutableDictionary<NSString *, id> *destinationItems = [self contentAtPath:destinationPath.stringByDeletingLastPathComponent forItems:self.rootItems];
+    [self copyObjectWithName:sourcePath.lastPathComponent
+                     inItems:sourceItems
+            toObjectWithName:destinationPath.lastPathComponent
+                     inItems:destinationItems
+            withFileKeyBlock:fileKeyBlock];
+}
+
+- (void)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath
+{
+    NSMutableDictionary<NSString *, id> *sourceItems = [self contentAtPath:sourcePath.stringByDeletingLastPathComponent forItems:self.rootItems];
+    NSMutableDictionary<NSString *, id> *destinationItems = [self contentAtPath:destinationPath.stringByDeletingLastPathComponent forItems:self.rootItems];
+
+    // Unlink from source and link to destination folder. Very cheap
+    NSString *sourceObjectName = sourcePath.lastPathComponent;
+    id sourceContent = sourceItems[sourceObjectName];
+    destinationItems[destinationPath.lastPathComponent] = sourceContent;
+    [sourceItems removeObjectForKey:sourceObjectName];
+
+    if ([sourceContent isKindOfClass:[NSString class]]) {
+        self.parentItemsForFileKeys[sourceContent] = destinationItems;
+    }
+}
+
+- (void)removeItemAtPath:(NSString *)path withFileKeyBlock:(void (^)(NSString *fileKey))fileKeyBlock
+{
+    // Never delete the root, rather delete all its contents
+    NSArray<NSString *> *pathComponents = path.pathComponents;
+    if (pathComponents.count == 1 && [pathComponents.firstObject isEqualToString:@"/"]) {
+        NSMutableDictionary<NSString *, id> *items = self.rootItems[@"/"];
+        for (NSString *name in [items allKeys]) {
+            [self removeItemWithName:name inItems:items withFileKeyBlock:fileKeyBlock];
+        }
+    }
+    else {
+        NSMutableDictionary<NSString *, id> *items = [self contentAtPath:path.stringByDeletingLastPathComponent forItems:self.rootItems];
+        [self removeItemWithName:path.lastPathComponent inItems:items withFileKeyBlock:fileKeyBlock];
+    }
+}
+
+- (void)removeFileWithKey:(NSString *)fileKey
+{
+    NSMutableDictionary<NSString *, id> *parentItems = self.parentItemsForFileKeys[fileKey];
+    if (! parentItems) {
+        return;
+    }
+
+    [parentItems removeObjectsForKeys:[parentItems allKeysForObject:fileKey]];
+    [self.parentItemsForFileKeys removeObjectForKey:fileKey];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; rootItems: %@>",
+            [self class],
+            self,
+            self.rootItems];
+}
+
+@end
@@ -0,0 +1,27 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private output stream used by HLSInMemoryFileManager. Written bytes are appended to a growable buffer, which is
+ * handed over (without any copy) to the commit block when the stream is closed
+ *
+ * Writes never block, the stream therefore always has space available. If the stream is scheduled in a run loop,
+ * the corresponding events are delivered to its delegate
+ */
+@interface HLSInMemoryOutputStream : NSOutputStream
+
+/**
+ * Create an output stream. If data is provided, written bytes are appended to it
+ */
+- (instancetype)initWithData:(nullable NSData *)data commitBlock:(void (^)(NSData *data))commitBlock;
+
+@end
+
+NS_ASSUME_NONNULL_END
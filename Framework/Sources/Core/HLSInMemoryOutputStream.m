@@ -0,0 +1,200 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSInMemoryOutputStream.h"
+
+@interface HLSInMemoryOutputStream () {
+@private
+    uint8_t *_bytes;
+    NSUInteger _length;
+    NSUInteger _capacity;
+}
+
+@property (nonatomic, copy) void (^commitBlock)(NSData *data);
+@property (nonatomic) NSStreamStatus status;
+@property (nonatomic, weak) id<NSStreamDelegate> streamDelegate;
+@property (nonatomic) NSMutableArray<NSArray *> *runLoopsAndModes;
+
+@end
+
+@implementation HLSInMemoryOutputStream
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithData:(NSData *)data commitBlock:(void (^)(NSData *data))commitBlock
+{
+    NSParameterAssert(commitBlock);
+
+    if (self = [super init]) {
+        self.commitBlock = commitBlock;
+        self.status = NSStreamStatusNotOpen;
+        self.runLoopsAndModes = [NSMutableArray array];
+
+        if (data.length != 0) {
+            _capacity = data.length;
+            _bytes = malloc(_capacity);
+            memcpy(_bytes, data.bytes, data.length);
+            _length = data.length;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    // Only if the stream has not been committed
+    free(_bytes);
+}
+
+#pragma mark Event delivery
+
+- (void)notifyEvent:(NSStreamEvent)event
+{
+    for (NSArray *runLoopAndMode in self.runLoopsAndModes) {
+        NSRunLoop *runLoop = runLoopAndMode.firstObject;
+        NSString *mode = runLoopAndMode.lastObject;
+
+        CFRunLoopPerformBlock(runLoop.getCFRunLoop, (__bridge CFStringRef)mode, ^{
+            id<NSStreamDelegate> delegate = self.delegate;
+            if ([delegate respondsToSelector:@selector(stream:handleEvent:)]) {
+                [delegate stream:self handleEvent:event];
+            }
+        });
+        CFRunLoopWakeUp(runLoop.getCFRunLoop);
+    }
+}
+
+#pragma mark NSStream overrides
+
+- (id<NSStreamDelegate>)delegate
+{
+    // By default, a stream is its own delegate
+    return self.streamDelegate ?: self;
+}
+
+- (void)setDelegate:(id<NSStreamDelegate>)delegate
+{
+    self.streamDelegate = delegate;
+}
+
+- (void)open
+{
+    if (self.status != NSStreamStatusNotOpen) {
+        return;
+    }
+
+    self.status = NSStreamStatusOpen;
+
+    [self notifyEvent:NSStreamEventOpenCompleted];
+    [self notifyEvent:NSStreamEventHasSpaceAvailable];
+}
+
+- (void)close
+{
+    if (self.status != NSStreamStatusOpen) {
+        return;
+    }
+
+    self.status = NSStreamStatusClosed;
+
+    // Hand over the buffer, trimmed to its actual length so that the committed data costs exactly what it weighs
+    NSData *data = nil;
+    if (_length != 0) {
+        // If the buffer cannot be trimmed, hand it over as is
+        uint8_t *bytes = realloc(_bytes, _length);
+        if (bytes) {
+            _bytes = bytes;
+        }
+
+        data = [[NSData alloc] initWithBytesNoCopy:_bytes length:_length freeWhenDone:YES];
+        _bytes = NULL;
+        _length = 0;
+        _capacity = 0;
+    }
+    else {
+        data = [NSData data];
+    }
+
+    self.commitBlock(data);
+}
+
+- (NSStreamStatus)streamStatus
+{
+    return self.status;
+}
+
+- (NSError *)streamError
+{
+    return nil;
+}
+
+- (id)propertyForKey:(NSString *)key
+{
+    return nil;
+}
+
+- (BOOL)setProperty:(id)property forKey:(NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode
+{
+    [self.runLoopsAndModes addObject:@[runLoop, mode]];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)runLoop forMode:(NSString *)mode
+{
+    [self.runLoopsAndModes removeObject:@[runLoop, mode]];
+}
+
+#pragma mark NSOutputStream overrides
+
+- (NSInteger)write:(const uint8_t *)buffer maxLength:(NSUInteger)length
+{
+    if (self.status != NSStreamStatusOpen) {
+        return -1;
+    }
+
+    if (length == 0) {
+        return 0;
+    }
+
+    if (_length + length > _capacity) {
+        NSUInteger capacity = MAX(_capacity * 2, _length + length);
+        uint8_t *bytes = realloc(_bytes, capacity);
+        if (! bytes) {
+            return -1;
+        }
+
+        _bytes = bytes;
+        _capacity = capacity;
+    }
+
+    memcpy(_bytes + _length, buffer, length);
+    _length += length;
+
+    [self notifyEvent:NSStreamEventHasSpaceAvailable];
+    return length;
+}
+
+- (BOOL)hasSpaceAvailable
+{
+    return self.status == NSStreamStatusOpen;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; status: %@; length: %@>",
+            [self class],
+            self,
+            @(self.status),
+            @(_length)];
+}
+
+@end
@@ -0,0 +1,85 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private protocol for the objects storing the file and directory hierarchy of an HLSInMemoryFileManager. Files are
+ * not stored directly, only a unique key pointing at the corresponding cache entry
+ *
+ * Storage objects do not perform any consistency check. Paths are always valid (i.e. begin with a /), and the file
+ * manager is responsible of checking that sources exist and that destinations do not before calling mutating methods
+ *
+ * Storage objects are not thread-safe. Synchronization is the responsibility of the file manager
+ */
+@protocol HLSInMemoryStorage <NSObject>
+
+/**
+ * Return YES iff a file or directory exists at the specified path. If so, isDirectory (if not NULL) is set accordingly
+ */
+- (BOOL)itemExistsAtPath:(NSString *)path isDirectory:(nullable BOOL *)pIsDirectory;
+
+/**
+ * Return the key of the file at the specified path, nil if no file exists at this location
+ */
+- (nullable NSString *)fileKeyAtPath:(NSString *)path;
+
+/**
+ * Return the path of the file having the specified key, nil if no such file exists
+ */
+- (nullable NSString *)pathForFileKey:(NSString *)fileKey;
+
+/**
+ * Return the names of the items contained in the directory at the specified path, nil if no directory exists there
+ */
+- (nullable NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path;
+
+/**
+ * Recursively enumerate the items contained in the directory at the specified path, directories before their contents.
+ * The file key is nil for directories. Return NO if no directory exists at the specified path
+ */
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                  usingBlock:(void (^)(NSString *itemPath, NSString * _Nullable fileKey, NSUInteger depth))block;
+
+/**
+ * Associate a file key with the specified path (the parent directory must exist). Return the key of the file which
+ * has been replaced, if any
+ */
+- (nullable NSString *)setFileKey:(NSString *)fileKey atPath:(NSString *)path;
+
+/**
+ * Create a directory at the specified path, as well as intermediate directories if needed. Return NO if a file is
+ * found along the path
+ */
+- (BOOL)createDirectoryAtPath:(NSString *)path;
+
+/**
+ * Recursively copy an item. The block is called for each copied file and must return the key of the copy (or nil if
+ * the file must not be copied)
+ */
+- (void)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath withFileKeyBlock:(NSString * _Nullable (^)(NSString *fileKey))fileKeyBlock;
+
+/**
+ * Move an item
+ */
+- (void)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath;
+
+/**
+ * Recursively remove an item (for /, only its contents). The block is called for each removed file
+ */
+- (void)removeItemAtPath:(NSString *)path withFileKeyBlock:(nullable void (^)(NSString *fileKey))fileKeyBlock;
+
+/**
+ * Remove the file having the specified key, if any
+ */
+- (void)removeFileWithKey:(NSString *)fileKey;
+
+@end
+
+NS_ASSUME_NONNULL_END
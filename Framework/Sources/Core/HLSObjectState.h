@@ -0,0 +1,57 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <UIKit/UIKit.h>
+
+@class HLSLabelLocalizationInfo;
+@class HLSViewBindingInformation;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private class gathering the state CoconutKit attaches to objects (mostly views), so that it is stored in a single
+ * associated object created on first use, rather than in one associated object per property. Looking up an associated
+ * object requires a lookup in a global table, under a lock
+ *
+ * Not thread-safe. State is meant to be accessed from the main thread only
+ */
+@interface HLSObjectState : NSObject
+
+/**
+ * Bindings (see UIView+HLSViewBinding.m)
+ */
+@property (nonatomic, copy, nullable) NSString *bindKeyPath;
+@property (nonatomic, copy, nullable) NSString *bindTransformer;
+@property (nonatomic) BOOL bindUpdateAnimated;
+@property (nonatomic) BOOL bindInputChecked;
+@property (nonatomic, nullable) HLSViewBindingInformation *bindingInformation;
+@property (nonatomic, copy, nullable) NSString *bindPlaceholder;
+
+/**
+ * Dynamic localization (see UILabel+HLSDynamicLocalization.m). Buttons store the localization information of their
+ * title label for each control state
+ */
+@property (nonatomic, nullable) HLSLabelLocalizationInfo *localizationInfo;
+@property (nonatomic, copy, nullable) NSDictionary<NSNumber *, HLSLabelLocalizationInfo *> *localizationInfosByState;
+@property (nonatomic, nullable) UIColor *originalBackgroundColor;
+@property (nonatomic, copy, nullable) NSString *locTable;
+@property (nonatomic, copy, nullable) NSString *locBundle;
+@property (nonatomic, nullable) id resolvedLocalizationSettings;
+
+@end
+
+/**
+ * Return the state attached to an object, nil if none. Use for reading state, since messages sent to nil yield default
+ * values
+ */
+OBJC_EXPORT HLSObjectState * _Nullable HLSObjectStateForObject(id object);
+
+/**
+ * Return the state attached to an object, creating it if needed. Use for writing state
+ */
+OBJC_EXPORT HLSObjectState *HLSObjectStateCreateForObject(id object);
+
+NS_ASSUME_NONNULL_END
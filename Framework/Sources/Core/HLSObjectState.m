@@ -0,0 +1,51 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSObjectState.h"
+
+#import "HLSRuntime.h"
+
+// Keys for associated objects
+static void *s_objectStateKey = &s_objectStateKey;
+
+@implementation HLSObjectState
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; bindKeyPath: %@; bindTransformer: %@; localizationInfo: %@; locTable: %@; locBundle: %@>",
+            [self class],
+            self,
+            self.bindKeyPath,
+            self.bindTransformer,
+            self.localizationInfo,
+            self.locTable,
+            self.locBundle];
+}
+
+@end
+
+#pragma mark Functions
+
+HLSObjectState *HLSObjectStateForObject(id object)
+{
+    NSCParameterAssert(object);
+
+    return hls_getAssociatedObject(object, s_objectStateKey);
+}
+
+HLSObjectState *HLSObjectStateCreateForObject(id object)
+{
+    NSCParameterAssert(object);
+
+    HLSObjectState *objectState = hls_getAssociatedObject(object, s_objectStateKey);
+    if (! objectState) {
+        objectState = [[HLSObjectState alloc] init];
+        hls_setAssociatedObject(object, s_objectStateKey, objectState, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    }
+    return objectState;
+}
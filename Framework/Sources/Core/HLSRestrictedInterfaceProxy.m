@@ -82,17 +82,8 @@
 - (BOOL)protocolDeclaresSelector:(SEL)selector
 {
     // Search in required methods first (should be the most common case for protocols defining an interface subset)
-    // Remark: Unlike the documentation says, protocol_getMethodDescription takes into account parent protocols as well
-    struct objc_method_description methodDescription = protocol_getMethodDescription(_protocol, selector, YES, YES);
-    if (! methodDescription.name) {
-        // Search in optional methods
-        methodDescription = protocol_getMethodDescription(_protocol, selector, NO, YES);
-        if (! methodDescription.name) {
-            return NO;
-        }
-    }
-    
-    return YES;
+    return hls_protocol_declaresSelector(_protocol, selector, YES, YES)
+        || hls_protocol_declaresSelector(_protocol, selector, NO, YES);
 }
 
 - (NSMethodSignature *)methodSignatureForSelector:(SEL)sel
@@ -40,6 +40,29 @@ NS_ASSUME_NONNULL_BEGIN
 #define HLSSwizzleClassSelector(clazz, selector, newImplementation, pPreviousImplementation) \
     (*pPreviousImplementation) = (__typeof((*pPreviousImplementation)))hls_class_swizzleClassSelector((clazz), (selector), (IMP)(newImplementation))
 
+/**
+ * Same as HLSSwizzleSelector and HLSSwizzleClassSelector, but for use from +load methods. Swizzles registered while an
+ * image is loaded are installed at once, after all +load methods of the image have been executed, and the previous
+ * implementation is only stored in pPreviousImplementation at that time. Swizzles registered later are installed
+ * immediately
+ *
+ * All swizzles, whether registered or installed directly, can be listed using hls_swizzleDescriptions(), and the total
+ * time spent installing them is available from hls_swizzlesInstallationDuration()
+ *
+ * Example of use:
+ * ---------------
+ *
+ *    + (void)load
+ *    {
+ *        HLSRegisterSwizzleSelector(self, @selector(setValue:animated:), swizzle_setValue_animated, &s_setValue_animated);
+ *    }
+ */
+#define HLSRegisterSwizzleSelector(clazz, selector, newImplementation, pPreviousImplementation) \
+    hls_class_registerSwizzleSelector((clazz), (selector), (IMP)(newImplementation), (IMP *)(pPreviousImplementation))
+
+#define HLSRegisterSwizzleClassSelector(clazz, selector, newImplementation, pPreviousImplementation) \
+    hls_class_registerSwizzleClassSelector((clazz), (selector), (IMP)(newImplementation), (IMP *)(pPreviousImplementation))
+
 /**
  * Begin / end macros for block swizzling. The new implementation is supplied using an enclosed block with proper signature
  * (self, followed by method arguments). Within the block implementation, you can use _cmd and _imp to refer to the swizzled
@@ -101,13 +124,21 @@ OBJC_EXPORT void instrumentObjcMessageSends(BOOL start);
  * hierarchy (which should not happen since this is clearly an error), which one is returned is
  * undefined.
  *
- * The list of method descriptions this function returns must later be freed by calling free()
+ * The list of method descriptions this function returns must later be freed by calling free(). Method descriptions
+ * are computed once per protocol and kind of methods, and cached
  */
 OBJC_EXPORT struct objc_method_description *hls_protocol_copyMethodDescriptionList(Protocol *protocol,
                                                                                    BOOL isRequiredMethod,
                                                                                    BOOL isInstanceMethod,
                                                                                    unsigned int * __nullable pCount);
 
+/**
+ * Return YES iff a protocol or one of its parent protocols declares a method with the given selector. Lookup is
+ * performed in constant time using the cached method descriptions of the protocol (see
+ * hls_protocol_copyMethodDescriptionList)
+ */
+OBJC_EXPORT BOOL hls_protocol_declaresSelector(Protocol *protocol, SEL selector, BOOL isRequiredMethod, BOOL isInstanceMethod);
+
 /**
  * Return YES iff the class or one of its superclasses conforms to the given protocol. This
  * is similar to class_conformsToProtocol, but taking superclasses into account. As for
@@ -179,6 +210,29 @@ OBJC_EXPORT IMP __nullable hls_class_swizzleClassSelectorWithBlock(Class clazz,
  */
 OBJC_EXPORT IMP __nullable hls_class_swizzleSelectorWithBlock(Class clazz, SEL selector, id newImplementationBlock);
 
+/**
+ * Register an instance / class method swizzle, installed with other registered swizzles (see HLSRegisterSwizzleSelector).
+ * The previous implementation, or NULL if not found, is stored in pPreviousImplementation when the swizzle is installed
+ */
+OBJC_EXPORT void hls_class_registerSwizzleClassSelector(Class clazz, SEL selector, IMP newImplementation, IMP __nullable * __nonnull pPreviousImplementation);
+OBJC_EXPORT void hls_class_registerSwizzleSelector(Class clazz, SEL selector, IMP newImplementation, IMP __nullable * __nonnull pPreviousImplementation);
+
+/**
+ * Install all swizzles registered so far, grouped by class. Called automatically once CoconutKit has been loaded
+ */
+OBJC_EXPORT void hls_installRegisteredSwizzles(void);
+
+/**
+ * The total time spent installing swizzles, in seconds
+ */
+OBJC_EXPORT NSTimeInterval hls_swizzlesInstallationDuration(void);
+
+/**
+ * Descriptions of all swizzles, in the order they were requested (e.g. -[UILabel setText:]). Swizzles which have not
+ * been installed yet, or whose method was not found, are marked as such
+ */
+OBJC_EXPORT NSArray<NSString *> *hls_swizzleDescriptions(void);
+
 /**
  * Return YES iff subclass is a subclass of superclass, or if subclass == superclass (in agreement with
  * the behavior of +[NSObject isSubclassOfClass:])
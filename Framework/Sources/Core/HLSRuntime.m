@@ -13,7 +13,92 @@
  *         (see http://www.opensource.apple.com/source/objc4/objc4-532.2/runtime/objc-runtime-new.mm)
  */
 
+#import <mach/mach_time.h>
 #import <objc/message.h>
+#import <pthread.h>
+
+typedef NS_ENUM(NSInteger, HLSSwizzleStatus) {
+    HLSSwizzleStatusEnumBegin = 0,
+    HLSSwizzleStatusPending = HLSSwizzleStatusEnumBegin,
+    HLSSwizzleStatusInstalled,
+    HLSSwizzleStatusNotFound,
+    HLSSwizzleStatusEnumEnd,
+    HLSSwizzleStatusEnumSize = HLSSwizzleStatusEnumEnd - HLSSwizzleStatusEnumBegin
+};
+
+typedef struct {
+    __unsafe_unretained Class clazz;
+    SEL selector;
+    IMP newImplementation;
+    IMP *pPreviousImplementation;                   // NULL for swizzles installed when requested
+    HLSSwizzleStatus status;
+} HLSSwizzle;
+
+// Swizzle registry. Recursive since installing swizzles might trigger +initialize methods which swizzle as well
+static pthread_mutex_t s_swizzlesLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER;
+static HLSSwizzle *s_swizzles = NULL;               // Protected by s_swizzlesLock
+static NSUInteger s_swizzlesCount = 0;              // Protected by s_swizzlesLock
+static NSUInteger s_swizzlesCapacity = 0;           // Protected by s_swizzlesLock
+static BOOL s_registeredSwizzlesInstalled = NO;     // Protected by s_swizzlesLock
+static uint64_t s_swizzlesInstallationTime = 0;     // Mach absolute time. Protected by s_swizzlesLock
+
+/**
+ * Method descriptions of a protocol and of its parent protocols, for a given kind of methods. A method with a given name
+ * appears at most once. Protocols cannot be modified once registered, their method descriptions are therefore cached
+ */
+@interface HLSProtocolMethodDescriptions : NSObject
+
+- (instancetype)initWithProtocol:(Protocol *)protocol isRequiredMethod:(BOOL)isRequiredMethod isInstanceMethod:(BOOL)isInstanceMethod NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly) const struct objc_method_description *methodDescriptions;
+@property (nonatomic, readonly) unsigned int count;
+
+- (BOOL)containsSelector:(SEL)selector;
+
+@end
+
+static HLSProtocolMethodDescriptions *hls_protocol_methodDescriptions(Protocol *protocol, BOOL isRequiredMethod, BOOL isInstanceMethod)
+{
+    static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+    static NSMapTable<Protocol *, HLSProtocolMethodDescriptions *> *s_caches[2][2];
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        for (NSUInteger i = 0; i < 2; ++i) {
+            for (NSUInteger j = 0; j < 2; ++j) {
+                // Protocols are never deallocated
+                s_caches[i][j] = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsOpaqueMemory | NSPointerFunctionsOpaquePersonality
+                                                       valueOptions:NSPointerFunctionsStrongMemory];
+            }
+        }
+    });
+    
+    NSMapTable<Protocol *, HLSProtocolMethodDescriptions *> *cache = s_caches[isRequiredMethod ? 1 : 0][isInstanceMethod ? 1 : 0];
+    
+    pthread_mutex_lock(&s_lock);
+    HLSProtocolMethodDescriptions *methodDescriptions = [cache objectForKey:protocol];
+    pthread_mutex_unlock(&s_lock);
+    if (methodDescriptions) {
+        return methodDescriptions;
+    }
+    
+    // Built without holding the lock, since parent protocol method descriptions are retrieved from the cache as well. If
+    // another thread was faster, use its result
+    methodDescriptions = [[HLSProtocolMethodDescriptions alloc] initWithProtocol:protocol
+                                                                isRequiredMethod:isRequiredMethod
+                                                                isInstanceMethod:isInstanceMethod];
+    
+    pthread_mutex_lock(&s_lock);
+    HLSProtocolMethodDescriptions *cachedMethodDescriptions = [cache objectForKey:protocol];
+    if (cachedMethodDescriptions) {
+        methodDescriptions = cachedMethodDescriptions;
+    }
+    else {
+        [cache setObject:methodDescriptions forKey:protocol];
+    }
+    pthread_mutex_unlock(&s_lock);
+    
+    return methodDescriptions;
+}
 
 struct objc_method_description *hls_protocol_copyMethodDescriptionList(Protocol *protocol,
                                                                        BOOL isRequiredMethod,
@@ -22,84 +107,27 @@ struct objc_method_description *hls_protocol_copyMethodDescriptionList(Protocol
 {
     NSCParameterAssert(protocol);
     
-    unsigned int numberOfMethodDescriptions = 0;
-    struct objc_method_description *methodDescriptions = NULL;
+    HLSProtocolMethodDescriptions *methodDescriptions = hls_protocol_methodDescriptions(protocol, isRequiredMethod, isInstanceMethod);
     
-    // protocol_copyMethodDescriptionList only returns the methods which the current protocol conforms to (ignoring
-    // parent protocols). Climb up the inheritance hierarchy
-    unsigned int numberOfProtocolMethodDescriptions = 0;
-    struct objc_method_description *protocolMethodDescriptions = protocol_copyMethodDescriptionList(protocol,
-                                                                                                    isRequiredMethod,
-                                                                                                    isInstanceMethod,
-                                                                                                    &numberOfProtocolMethodDescriptions);
-    if (protocolMethodDescriptions) {
-        methodDescriptions = protocolMethodDescriptions;
-        numberOfMethodDescriptions = numberOfProtocolMethodDescriptions;
-    }
-    
-    // Climb up the protocol inheritance hierarchy
-    unsigned int numberOfParentProtocols = 0;
-    Protocol * __unsafe_unretained * parentProtocols = protocol_copyProtocolList(protocol, &numberOfParentProtocols);
-    for (unsigned int i = 0; i < numberOfParentProtocols; ++i) {
-        Protocol *parentProtocol = parentProtocols[i];
-        unsigned int numberOfParentProtocolMethodDescriptions = 0;
-        struct objc_method_description *parentProtocolMethodDescriptions = hls_protocol_copyMethodDescriptionList(parentProtocol,
-                                                                                                                  isRequiredMethod,
-                                                                                                                  isInstanceMethod,
-                                                                                                                  &numberOfParentProtocolMethodDescriptions);
-        if (parentProtocolMethodDescriptions) {
-            // First method list retrieved. Keep the allocated array we got
-            if (numberOfMethodDescriptions == 0) {
-                methodDescriptions = parentProtocolMethodDescriptions;
-                numberOfMethodDescriptions = numberOfParentProtocolMethodDescriptions;
-            }
-            // Methods already available. Resize and append by copy, avoiding duplicates, then stretch if duplicates have been found
-            else {
-                // Work with the largest array we might need
-                methodDescriptions = realloc(methodDescriptions,
-                                             (numberOfMethodDescriptions + numberOfParentProtocolMethodDescriptions) * sizeof(struct objc_method_description));
-                
-                unsigned int numberOfNonDuplicateMethodDescriptions = 0;
-                for (unsigned int j = 0; j < numberOfParentProtocolMethodDescriptions; ++j) {
-                    struct objc_method_description parentProtocolMethodDescription = parentProtocolMethodDescriptions[j];
-                    
-                    // Search for duplicates. Only need to search in already existing descriptions (those returned by
-                    // protocol_copyMethodDescriptionList or hls_protocol_copyMethodDescriptionList are already unique
-                    // and do not need to be checked again)
-                    BOOL duplicateFound = NO;
-                    for (unsigned k = 0; k < numberOfMethodDescriptions; ++k) {
-                        // Compare selectors
-                        if (parentProtocolMethodDescription.name == methodDescriptions[k].name) {
-                            duplicateFound = YES;
-                            break;
-                        }
-                    }
-                    
-                    // Skip duplicates (if a second selector with a different signature is found, it is dropped)
-                    if (duplicateFound) {
-                        continue;
-                    }
-                    
-                    methodDescriptions[numberOfMethodDescriptions + numberOfNonDuplicateMethodDescriptions] = parentProtocolMethodDescription;
-                    ++numberOfNonDuplicateMethodDescriptions;
-                }
-                free(parentProtocolMethodDescriptions);
-                
-                // Shrink the array (if needed)
-                if (numberOfNonDuplicateMethodDescriptions != numberOfParentProtocolMethodDescriptions) {
-                    methodDescriptions = realloc(methodDescriptions,
-                                                 (numberOfMethodDescriptions + numberOfNonDuplicateMethodDescriptions) * sizeof(struct objc_method_description));
-                }
-                numberOfMethodDescriptions += numberOfNonDuplicateMethodDescriptions;
-            }
-        }
+    struct objc_method_description *methodDescriptionsCopy = NULL;
+    if (methodDescriptions.count != 0) {
+        size_t size = methodDescriptions.count * sizeof(struct objc_method_description);
+        methodDescriptionsCopy = malloc(size);
+        memcpy(methodDescriptionsCopy, methodDescriptions.methodDescriptions, size);
     }
-    free(parentProtocols);
     
     if (pCount) {
-        *pCount = numberOfMethodDescriptions;
+        *pCount = methodDescriptions.count;
     }
-    return methodDescriptions;
+    return methodDescriptionsCopy;
+}
+
+BOOL hls_protocol_declaresSelector(Protocol *protocol, SEL selector, BOOL isRequiredMethod, BOOL isInstanceMethod)
+{
+    NSCParameterAssert(protocol);
+    NSCParameterAssert(selector);
+    
+    return [hls_protocol_methodDescriptions(protocol, isRequiredMethod, isInstanceMethod) containsSelector:selector];
 }
 
 BOOL hls_class_conformsToProtocol(Class cls, Protocol *protocol)
@@ -140,34 +168,24 @@ BOOL hls_class_implementsProtocolMethods(Class cls, Protocol *protocol, BOOL isR
 {
     NSCParameterAssert(protocol);
     
-    unsigned int numberOfMethods = 0;
-    struct objc_method_description *methodDescriptions = hls_protocol_copyMethodDescriptionList(protocol,
-                                                                                                isRequiredMethod,
-                                                                                                isInstanceMethod,
-                                                                                                &numberOfMethods);
-    
-    BOOL result = YES;
-    for (unsigned int i = 0; i < numberOfMethods; ++i) {
-        struct objc_method_description methodDescription = methodDescriptions[i];
+    HLSProtocolMethodDescriptions *methodDescriptions = hls_protocol_methodDescriptions(protocol, isRequiredMethod, isInstanceMethod);
+    for (unsigned int i = 0; i < methodDescriptions.count; ++i) {
+        struct objc_method_description methodDescription = methodDescriptions.methodDescriptions[i];
         SEL selector = methodDescription.name;
         
         // This searches in superclasses as well
         Method method = isInstanceMethod ? class_getInstanceMethod(cls, selector) : class_getClassMethod(cls, selector);
         if (! method) {
-            result = NO;
-            break;
+            return NO;
         }
         
         // Check method signature consistency
         if (strcmp(method_getTypeEncoding(method), methodDescription.types) != 0) {
-            result = NO;
-            break;
+            return NO;
         }
-        
     }
-    free(methodDescriptions);
     
-    return result;
+    return YES;
 }
 
 /**
@@ -237,20 +255,10 @@ IMP hls_class_swizzleClassSelector(Class clazz, SEL selector, IMP newImplementat
     return hls_class_swizzleSelector(object_getClass(clazz), selector, newImplementation);
 }
 
-IMP hls_class_swizzleSelector(Class clazz, SEL selector, IMP newImplementation)
+// Return an implementation which only calls the super implementation of a method (block implementations signatures
+// must not have a SEL argument), see explanation above
+static IMP hls_class_superImplementation(Class clazz, SEL selector, const char *types)
 {
-    // Calling class_getInstanceMethod on a metaclass is the same as calling class_getClassMethod on the class itself. There
-    // is therefore no need to test whether the class is a metaclass or not! Lookup is performed in parent classes as well
-    Method method = class_getInstanceMethod(clazz, selector);
-    if (! method) {
-        // Cannot swizzle methods which are not implemented by the class or one of its parents
-        return NULL;
-    }
-    
-    // The following only adds a method implementation if the class does not implement it itself (block implementations
-    // sigatures must not have a SEL argument). The added method only calls the super counterpart, see explanation above
-    const char *types = method_getTypeEncoding(method);
-    
 #if !defined(__arm64__)
     NSUInteger returnSize = 0;
     NSGetSizeAndAlignment(types, &returnSize, NULL);
@@ -259,7 +267,7 @@ IMP hls_class_swizzleSelector(Class clazz, SEL selector, IMP newImplementation)
     // Objective-C messaging is used (small structs are returned in registers)
     // For more information, see http://www.sealiesoftware.com/blog/archive/2008/10/30/objc_explain_objc_msgSend_stret.html
     if (sizeof(void *) == 4 && types[0] == _C_STRUCT_B && returnSize != 1 && returnSize != 2 && returnSize != 4 && returnSize != 8) {
-        class_addMethod(clazz, selector, imp_implementationWithBlock(^(__unsafe_unretained id self /* prevent incorrect ARC memory calls */, va_list argp) {
+        return imp_implementationWithBlock(^(__unsafe_unretained id self /* prevent incorrect ARC memory calls */, va_list argp) {
             struct objc_super super = {
                 .receiver = self,
                 .super_class = class_getSuperclass(clazz)
@@ -276,26 +284,72 @@ IMP hls_class_swizzleSelector(Class clazz, SEL selector, IMP newImplementation)
             // Cast the call to objc_msgSendSuper_stret appropriately
             HLSLargeStruct (*objc_msgSendSuper_stret_typed)(struct objc_super *, SEL, va_list) = (void *)&objc_msgSendSuper_stret;
             return objc_msgSendSuper_stret_typed(&super, selector, argp);
-        }), types);
+        });
     }
-    else {
 #endif
-        class_addMethod(clazz, selector, imp_implementationWithBlock(^(__unsafe_unretained id self /* prevent incorrect ARC memory calls */, va_list argp) {
-            struct objc_super super = {
-                .receiver = self,
-                .super_class = class_getSuperclass(clazz)
-            };
-            
-            // Cast the call to objc_msgSendSuper appropriately
-            id (*objc_msgSendSuper_typed)(struct objc_super *, SEL, va_list) = (void *)&objc_msgSendSuper;
-            return objc_msgSendSuper_typed(&super, selector, argp);
-        }), types);
-#if !defined(__arm64__)
+    
+    return imp_implementationWithBlock(^(__unsafe_unretained id self /* prevent incorrect ARC memory calls */, va_list argp) {
+        struct objc_super super = {
+            .receiver = self,
+            .super_class = class_getSuperclass(clazz)
+        };
+        
+        // Cast the call to objc_msgSendSuper appropriately
+        id (*objc_msgSendSuper_typed)(struct objc_super *, SEL, va_list) = (void *)&objc_msgSendSuper;
+        return objc_msgSendSuper_typed(&super, selector, argp);
+    });
+}
+
+static IMP hls_class_replaceImplementation(Class clazz, SEL selector, IMP newImplementation)
+{
+    // Calling class_getInstanceMethod on a metaclass is the same as calling class_getClassMethod on the class itself. There
+    // is therefore no need to test whether the class is a metaclass or not! Lookup is performed in parent classes as well
+    Method method = class_getInstanceMethod(clazz, selector);
+    if (! method) {
+        // Cannot swizzle methods which are not implemented by the class or one of its parents
+        return NULL;
     }
-#endif
     
-    // Swizzling
-    return class_replaceMethod(clazz, selector, newImplementation, types);
+    // If the class does not implement the method itself, add the new implementation directly. The original implementation
+    // is then an implementation calling the super counterpart, see explanation above. This way the class is only modified
+    // once (each modification flushes method caches)
+    const char *types = method_getTypeEncoding(method);
+    if (class_addMethod(clazz, selector, newImplementation, types)) {
+        return hls_class_superImplementation(clazz, selector, types);
+    }
+    else {
+        return method_setImplementation(method, newImplementation);
+    }
+}
+
+static void hls_addSwizzle(Class clazz, SEL selector, IMP newImplementation, IMP *pPreviousImplementation, HLSSwizzleStatus status)
+{
+    pthread_mutex_lock(&s_swizzlesLock);
+    if (s_swizzlesCount == s_swizzlesCapacity) {
+        s_swizzlesCapacity = MAX(2 * s_swizzlesCapacity, 64);
+        s_swizzles = realloc(s_swizzles, s_swizzlesCapacity * sizeof(HLSSwizzle));
+    }
+    s_swizzles[s_swizzlesCount++] = (HLSSwizzle){
+        .clazz = clazz,
+        .selector = selector,
+        .newImplementation = newImplementation,
+        .pPreviousImplementation = pPreviousImplementation,
+        .status = status
+    };
+    pthread_mutex_unlock(&s_swizzlesLock);
+}
+
+IMP hls_class_swizzleSelector(Class clazz, SEL selector, IMP newImplementation)
+{
+    pthread_mutex_lock(&s_swizzlesLock);
+    uint64_t startTime = mach_absolute_time();
+    IMP previousImplementation = hls_class_replaceImplementation(clazz, selector, newImplementation);
+    s_swizzlesInstallationTime += mach_absolute_time() - startTime;
+    
+    hls_addSwizzle(clazz, selector, newImplementation, NULL, previousImplementation ? HLSSwizzleStatusInstalled : HLSSwizzleStatusNotFound);
+    pthread_mutex_unlock(&s_swizzlesLock);
+    
+    return previousImplementation;
 }
 
 IMP hls_class_swizzleClassSelectorWithBlock(Class clazz, SEL selector, id newImplementationBlock)
@@ -310,6 +364,95 @@ IMP hls_class_swizzleSelectorWithBlock(Class clazz, SEL selector, id newImplemen
     return hls_class_swizzleSelector(clazz, selector, newImplementation);
 }
 
+void hls_class_registerSwizzleClassSelector(Class clazz, SEL selector, IMP newImplementation, IMP *pPreviousImplementation)
+{
+    hls_class_registerSwizzleSelector(object_getClass(clazz), selector, newImplementation, pPreviousImplementation);
+}
+
+void hls_class_registerSwizzleSelector(Class clazz, SEL selector, IMP newImplementation, IMP *pPreviousImplementation)
+{
+    NSCParameterAssert(pPreviousImplementation);
+    
+    pthread_mutex_lock(&s_swizzlesLock);
+    if (s_registeredSwizzlesInstalled) {
+        *pPreviousImplementation = hls_class_swizzleSelector(clazz, selector, newImplementation);
+    }
+    else {
+        hls_addSwizzle(clazz, selector, newImplementation, pPreviousImplementation, HLSSwizzleStatusPending);
+    }
+    pthread_mutex_unlock(&s_swizzlesLock);
+}
+
+void hls_installRegisteredSwizzles(void)
+{
+    pthread_mutex_lock(&s_swizzlesLock);
+    uint64_t startTime = mach_absolute_time();
+    
+    // Install pending swizzles class by class, preserving the order in which they were registered for each class
+    for (NSUInteger i = 0; i < s_swizzlesCount; ++i) {
+        if (s_swizzles[i].status != HLSSwizzleStatusPending) {
+            continue;
+        }
+        
+        Class clazz = s_swizzles[i].clazz;
+        for (NSUInteger j = i; j < s_swizzlesCount; ++j) {
+            if (s_swizzles[j].clazz != clazz || s_swizzles[j].status != HLSSwizzleStatusPending) {
+                continue;
+            }
+            
+            // Swizzles registered meanwhile (e.g. by +initialize methods) might reallocate the registry
+            IMP previousImplementation = hls_class_replaceImplementation(clazz, s_swizzles[j].selector, s_swizzles[j].newImplementation);
+            *s_swizzles[j].pPreviousImplementation = previousImplementation;
+            s_swizzles[j].status = previousImplementation ? HLSSwizzleStatusInstalled : HLSSwizzleStatusNotFound;
+        }
+    }
+    
+    s_registeredSwizzlesInstalled = YES;
+    s_swizzlesInstallationTime += mach_absolute_time() - startTime;
+    pthread_mutex_unlock(&s_swizzlesLock);
+}
+
+NSTimeInterval hls_swizzlesInstallationDuration(void)
+{
+    mach_timebase_info_data_t timebaseInfo;
+    mach_timebase_info(&timebaseInfo);
+    
+    pthread_mutex_lock(&s_swizzlesLock);
+    uint64_t installationTime = s_swizzlesInstallationTime;
+    pthread_mutex_unlock(&s_swizzlesLock);
+    
+    return installationTime * timebaseInfo.numer / timebaseInfo.denom / 1e9;
+}
+
+NSArray<NSString *> *hls_swizzleDescriptions(void)
+{
+    static NSString * const s_statusSuffixes[] = {
+        [HLSSwizzleStatusPending] = @" (pending)",
+        [HLSSwizzleStatusInstalled] = @"",
+        [HLSSwizzleStatusNotFound] = @" (not found)"
+    };
+    
+    NSMutableArray<NSString *> *descriptions = [NSMutableArray array];
+    pthread_mutex_lock(&s_swizzlesLock);
+    for (NSUInteger i = 0; i < s_swizzlesCount; ++i) {
+        HLSSwizzle *swizzle = &s_swizzles[i];
+        [descriptions addObject:[NSString stringWithFormat:@"%@[%s %@]%@",
+                                 class_isMetaClass(swizzle->clazz) ? @"+" : @"-",
+                                 class_getName(swizzle->clazz),
+                                 NSStringFromSelector(swizzle->selector),
+                                 s_statusSuffixes[swizzle->status]]];
+    }
+    pthread_mutex_unlock(&s_swizzlesLock);
+    return [descriptions copy];
+}
+
+// Swizzles registered from +load methods are installed once all +load methods of the image have been executed, just
+// before its initializers
+__attribute__((constructor)) static void hls_installRegisteredSwizzlesAtLoad(void)
+{
+    hls_installRegisteredSwizzles();
+}
+
 BOOL hls_class_isSubclassOfClass(Class subclass, Class superclass)
 {
     for (Class class = subclass; class != Nil; class = class_getSuperclass(class)) {
@@ -350,15 +493,21 @@ void hls_object_replaceReferencesToObject(id object, id replacedObject, id repla
     free(ivars);
 }
 
+// Use an indirection so that associated objects attached using hls_setAssociatedObject can only be retrieved
+// using hls_getAssociatedObject, not using objc_getAssociatedObject. Conversely, associated objects created
+// using objc_setAssociatedObject cannot be retrieved using hls_getAssociatedObject. Keys are addresses in the
+// user address space, their complements are not (on 64-bit architectures) and therefore cannot clash with them
+static inline const void *hls_hiddenAssociationKey(const void *key)
+{
+    return (const void *)~(uintptr_t)key;
+}
+
 void hls_setAssociatedObject(id object, const void *key, id value, hls_AssociationPolicy policy)
 {
     NSCParameterAssert(object);
     NSCParameterAssert(key);
     
-    // Use an indirection so that associated objects attached using hls_setAssociatedObject can only be retrieved
-    // using hls_getAssociatedObject, not using objc_getAssociatedObject. Conversely, associated objects created
-    // using objc_setAssociatedObject cannot be retrieved using hls_getAssociatedObject
-    void *hiddenKey = (void *)[NSString stringWithFormat:@"hls_%p", key].hash;
+    const void *hiddenKey = hls_hiddenAssociationKey(key);
     if (policy == HLS_ASSOCIATION_WEAK || policy == HLS_ASSOCIATION_WEAK_NONATOMIC) {
         objc_AssociationPolicy objc_policy = (policy == HLS_ASSOCIATION_WEAK) ? OBJC_ASSOCIATION_RETAIN : OBJC_ASSOCIATION_RETAIN_NONATOMIC;
         
@@ -375,8 +524,7 @@ id hls_getAssociatedObject(id object, const void *key)
     NSCParameterAssert(object);
     NSCParameterAssert(key);
     
-    // See hls_setAssociatedObject
-    void *hiddenKey = (void *)[NSString stringWithFormat:@"hls_%p", key].hash;
+    const void *hiddenKey = hls_hiddenAssociationKey(key);
     id associatedObject = objc_getAssociatedObject(object, hiddenKey);
     if ([associatedObject isKindOfClass:[HLSWeakObjectWrapper class]]) {
         HLSWeakObjectWrapper *weakObjectWrapper = (HLSWeakObjectWrapper *)associatedObject;
@@ -386,3 +534,95 @@ id hls_getAssociatedObject(id object, const void *key)
         return associatedObject;
     }
 }
+
+@implementation HLSProtocolMethodDescriptions {
+@private
+    struct objc_method_description *_methodDescriptions;
+    CFMutableSetRef _selectors;
+}
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithProtocol:(Protocol *)protocol isRequiredMethod:(BOOL)isRequiredMethod isInstanceMethod:(BOOL)isInstanceMethod
+{
+    NSParameterAssert(protocol);
+    
+    if (self = [super init]) {
+        // Selectors are compared by address
+        _selectors = CFSetCreateMutable(kCFAllocatorDefault, 0, NULL);
+        
+        // protocol_copyMethodDescriptionList only returns the methods which the current protocol conforms to (ignoring
+        // parent protocols)
+        unsigned int numberOfProtocolMethodDescriptions = 0;
+        struct objc_method_description *protocolMethodDescriptions = protocol_copyMethodDescriptionList(protocol,
+                                                                                                        isRequiredMethod,
+                                                                                                        isInstanceMethod,
+                                                                                                        &numberOfProtocolMethodDescriptions);
+        [self appendMethodDescriptions:protocolMethodDescriptions count:numberOfProtocolMethodDescriptions];
+        free(protocolMethodDescriptions);
+        
+        // Climb up the protocol inheritance hierarchy
+        unsigned int numberOfParentProtocols = 0;
+        Protocol * __unsafe_unretained * parentProtocols = protocol_copyProtocolList(protocol, &numberOfParentProtocols);
+        for (unsigned int i = 0; i < numberOfParentProtocols; ++i) {
+            HLSProtocolMethodDescriptions *parentMethodDescriptions = hls_protocol_methodDescriptions(parentProtocols[i],
+                                                                                                      isRequiredMethod,
+                                                                                                      isInstanceMethod);
+            [self appendMethodDescriptions:parentMethodDescriptions.methodDescriptions count:parentMethodDescriptions.count];
+        }
+        free(parentProtocols);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_methodDescriptions);
+    CFRelease(_selectors);
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Accessors and mutators
+
+- (const struct objc_method_description *)methodDescriptions
+{
+    return _methodDescriptions;
+}
+
+#pragma mark Method descriptions
+
+// Skip duplicates (if a second selector with a different signature is found, it is dropped)
+- (void)appendMethodDescriptions:(const struct objc_method_description *)methodDescriptions count:(unsigned int)count
+{
+    if (count == 0) {
+        return;
+    }
+    
+    _methodDescriptions = realloc(_methodDescriptions, (_count + count) * sizeof(struct objc_method_description));
+    for (unsigned int i = 0; i < count; ++i) {
+        struct objc_method_description methodDescription = methodDescriptions[i];
+        if (CFSetContainsValue(_selectors, methodDescription.name)) {
+            continue;
+        }
+        
+        CFSetAddValue(_selectors, methodDescription.name);
+        _methodDescriptions[_count] = methodDescription;
+        ++_count;
+    }
+}
+
+- (BOOL)containsSelector:(SEL)selector
+{
+    return CFSetContainsValue(_selectors, selector);
+}
+
+@end
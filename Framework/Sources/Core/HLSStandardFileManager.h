@@ -10,8 +10,45 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ * Durability levels for file writes
+ */
+typedef NS_ENUM(NSInteger, HLSFileWriteDurability) {
+    HLSFileWriteDurabilityEnumBegin = 0,
+    HLSFileWriteDurabilityAtomic = HLSFileWriteDurabilityEnumBegin,            // Default: Data is written to a temporary file, which then replaces
+                                                                                // the original one. Files are never partially written
+    HLSFileWriteDurabilityPlain,                                                // Data is written in place. Cheaper, but a file might be partially
+                                                                                // written if the application is killed in the meantime
+    HLSFileWriteDurabilityDeferred,                                             // Data is written in place, but only when the file manager is flushed
+                                                                                // (explicitly, when the application enters the background or when the
+                                                                                // file manager is deallocated). Writes are therefore always asynchronous
+    HLSFileWriteDurabilityEnumEnd,
+    HLSFileWriteDurabilityEnumSize = HLSFileWriteDurabilityEnumEnd - HLSFileWriteDurabilityEnumBegin
+};
+
+/**
+ * Policies for file reads
+ */
+typedef NS_ENUM(NSInteger, HLSFileReadPolicy) {
+    HLSFileReadPolicyEnumBegin = 0,
+    HLSFileReadPolicyAutomatic = HLSFileReadPolicyEnumBegin,                    // Default: Foundation decides whether files are memory-mapped
+    HLSFileReadPolicyMapped,                                                    // Files are always memory-mapped, pages being loaded when accessed.
+                                                                                // Best for large read-only files
+    HLSFileReadPolicyMappedAboveThreshold,                                      // Files larger than mappingThreshold are memory-mapped, smaller
+                                                                                // ones are read
+    HLSFileReadPolicyRead,                                                      // Files are always read into memory at once. Best for small, hot
+                                                                                // files
+    HLSFileReadPolicyEnumEnd,
+    HLSFileReadPolicyEnumSize = HLSFileReadPolicyEnumEnd - HLSFileReadPolicyEnumBegin
+};
+
 /**
  * A standard NSFileManager-based file manager, built upon +[NSFileManager defaultManager]
+ *
+ * By default, files are written synchronously. When writing asynchronously, writes are queued and performed in batches
+ * on a dedicated serial queue, repeated writes to the same file being coalesced. Reads always return the most recently
+ * written data, even if not written to disk yet. Other operations (copy, move, removal, streams and URLs) first wait
+ * until pending writes have been made
  */
 @interface HLSStandardFileManager : HLSFileManager
 
@@ -27,6 +64,52 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithRootFolderPath:(nullable NSString *)rootFolderPath NS_DESIGNATED_INITIALIZER;
 
+/**
+ * If set to YES, -createFileAtPath:contents:error: returns as soon as the path has been validated, and data is written
+ * asynchronously. Write errors are then logged
+ *
+ * Default value is NO
+ */
+@property (atomic, getter=isWritingAsynchronously) BOOL writingAsynchronously;
+
+/**
+ * The durability level applied to file writes
+ *
+ * Default value is HLSFileWriteDurabilityAtomic
+ */
+@property (atomic) HLSFileWriteDurability writeDurability;
+
+/**
+ * The policy applied by -contentsOfFileAtPath:error:
+ *
+ * Default value is HLSFileReadPolicyAutomatic
+ */
+@property (atomic) HLSFileReadPolicy readPolicy;
+
+/**
+ * The size (in bytes) from which files are memory-mapped when using HLSFileReadPolicyMappedAboveThreshold
+ *
+ * Default value is 64 KB
+ */
+@property (atomic) unsigned long long mappingThreshold;
+
+/**
+ * Same as -contentsOfFileAtPath:error:, but with a specific read policy
+ */
+- (nullable NSData *)contentsOfFileAtPath:(NSString *)path readPolicy:(HLSFileReadPolicy)readPolicy error:(out NSError *__autoreleasing *)pError;
+
+/**
+ * Synchronously write all pending data to disk. This method acts as a barrier: When it returns, all writes made before
+ * it was called have been performed
+ */
+- (void)flush;
+
+/**
+ * Same as -flush, but without blocking. The completion block is called on the main thread once all writes made before
+ * the method was called have been performed
+ */
+- (void)flushWithCompletionBlock:(nullable void (^)(void))completionBlock;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,9 +11,21 @@
 #import "NSBundle+HLSExtensions.h"
 #import "NSError+HLSExtensions.h"
 
-@interface HLSStandardFileManager ()
+#import <fcntl.h>
+#import <pthread.h>
+#import <sys/stat.h>
+#import <unistd.h>
+#import <UIKit/UIKit.h>
+
+@interface HLSStandardFileManager () {
+@private
+    pthread_mutex_t _pendingWritesLock;                                         // Protects pending writes
+}
 
 @property (nonatomic, copy) NSString *rootFolderPath;
+@property (nonatomic) NSMutableDictionary<NSString *, NSData *> *pendingWrites; // Data waiting to be written, by full path
+@property (nonatomic, getter=isWriteBatchScheduled) BOOL writeBatchScheduled;   // Protected by the pending writes lock
+@property (nonatomic) dispatch_queue_t writeQueue;                              // Serial queue on which data is written
 
 @end
 
@@ -62,6 +74,17 @@
         }
         
         self.rootFolderPath = rootFolderPath;
+        
+        self.mappingThreshold = 64 * 1024;
+        
+        pthread_mutex_init(&_pendingWritesLock, NULL);
+        self.pendingWrites = [NSMutableDictionary dictionary];
+        self.writeQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSStandardFileManager.write", DISPATCH_QUEUE_SERIAL);
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
     }
     return self;
 }
@@ -71,6 +94,16 @@
     return [self initWithRootFolderPath:nil];
 }
 
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
+    // Scheduled batches retain the file manager. Only deferred writes can still be pending, write them before leaving
+    [self writePendingData];
+    
+    pthread_mutex_destroy(&_pendingWritesLock);
+}
+
 #pragma mark Helpers
 
 - (NSString *)fullPathForPath:(NSString *)path withError:(NSError *__autoreleasing *)pError
@@ -87,16 +120,296 @@
     return [self.rootFolderPath stringByAppendingPathComponent:path];;
 }
 
-#pragma mark HLSFileManagerAbstract protocol implementation
+#pragma mark Reads
 
-- (NSData *)contentsOfFileAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+- (NSDataReadingOptions)readingOptionsForFileAtFullPath:(NSString *)fullPath readPolicy:(HLSFileReadPolicy)readPolicy
+{
+    switch (readPolicy) {
+        case HLSFileReadPolicyMapped: {
+            return NSDataReadingMappedAlways;
+            break;
+        }
+            
+        case HLSFileReadPolicyMappedAboveThreshold: {
+            struct stat fileStat;
+            if (stat(fullPath.fileSystemRepresentation, &fileStat) == 0 && (unsigned long long)fileStat.st_size >= self.mappingThreshold) {
+                return NSDataReadingMappedAlways;
+            }
+            else {
+                return 0;
+            }
+            break;
+        }
+            
+        case HLSFileReadPolicyRead: {
+            return 0;
+            break;
+        }
+            
+        default: {
+            return NSDataReadingMappedIfSafe;
+            break;
+        }
+    }
+}
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path readPolicy:(HLSFileReadPolicy)readPolicy error:(out NSError *__autoreleasing *)pError
 {
     NSString *fullPath = [self fullPathForPath:path withError:pError];
     if (! fullPath) {
         return nil;
     }
     
-    return [NSData dataWithContentsOfFile:fullPath options:NSDataReadingMappedIfSafe error:pError];
+    // Read your writes
+    NSData *pendingContents = [self pendingContentsForFullPath:fullPath];
+    if (pendingContents) {
+        return pendingContents;
+    }
+    
+    NSDataReadingOptions readingOptions = [self readingOptionsForFileAtFullPath:fullPath readPolicy:readPolicy];
+    return [NSData dataWithContentsOfFile:fullPath options:readingOptions error:pError];
+}
+
+/**
+ * Only read the requested bytes, whatever the read policy
+ */
+- (NSData *)contentsOfFileAtPath:(NSString *)path range:(NSRange)range error:(out NSError *__autoreleasing *)pError
+{
+    NSString *fullPath = [self fullPathForPath:path withError:pError];
+    if (! fullPath) {
+        return nil;
+    }
+    
+    // Data not written yet is available in memory
+    if ([self pendingContentsForFullPath:fullPath]) {
+        return [super contentsOfFileAtPath:path range:range error:pError];
+    }
+    
+    int fileDescriptor = open(fullPath.fileSystemRepresentation, O_RDONLY);
+    if (fileDescriptor == -1) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"File not found", nil)];
+        }
+        return nil;
+    }
+    
+    struct stat fileStat;
+    if (fstat(fileDescriptor, &fileStat) != 0 || S_ISDIR(fileStat.st_mode)) {
+        close(fileDescriptor);
+        
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:CoconutKitLocalizedString(@"File not found", nil)];
+        }
+        return nil;
+    }
+    
+    unsigned long long fileSize = (unsigned long long)fileStat.st_size;
+    if (range.location > fileSize) {
+        close(fileDescriptor);
+        
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadUnknownError
+                          localizedDescription:CoconutKitLocalizedString(@"Invalid byte range", nil)];
+        }
+        return nil;
+    }
+    
+    NSUInteger length = (NSUInteger)MIN((unsigned long long)range.length, fileSize - range.location);
+    if (length == 0) {
+        close(fileDescriptor);
+        return [NSData data];
+    }
+    
+    uint8_t *bytes = malloc(length);
+    if (! bytes) {
+        close(fileDescriptor);
+        
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+        return nil;
+    }
+    
+    NSUInteger readLength = 0;
+    int readErrno = 0;
+    while (readLength < length) {
+        ssize_t result = pread(fileDescriptor, bytes + readLength, length - readLength, (off_t)(range.location + readLength));
+        if (result > 0) {
+            readLength += result;
+        }
+        // End of file reached (the file might have been truncated in the meantime)
+        else if (result == 0) {
+            break;
+        }
+        else if (errno != EINTR) {
+            readErrno = errno;
+            break;
+        }
+    }
+    close(fileDescriptor);
+    
+    if (readErrno != 0) {
+        free(bytes);
+        
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSPOSIXErrorDomain code:readErrno userInfo:nil];
+        }
+        return nil;
+    }
+    
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:readLength freeWhenDone:YES];
+}
+
+#pragma mark Writes
+
+- (NSDataWritingOptions)writingOptions
+{
+    return (self.writeDurability == HLSFileWriteDurabilityAtomic) ? NSDataWritingAtomic : 0;
+}
+
+/**
+ * Check that a file can be written at the specified location, so that asynchronous writes can fail early
+ */
+- (BOOL)checkFileFullPath:(NSString *)fullPath error:(NSError *__autoreleasing *)pError
+{
+    BOOL isParentDirectory = NO;
+    NSString *parentPath = fullPath.stringByDeletingLastPathComponent;
+    if (! [[NSFileManager defaultManager] fileExistsAtPath:parentPath isDirectory:&isParentDirectory] || ! isParentDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), parentPath]];
+        }
+        return NO;
+    }
+    
+    BOOL isDirectory = NO;
+    if ([[NSFileManager defaultManager] fileExistsAtPath:fullPath isDirectory:&isDirectory] && isDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+/**
+ * Schedule a batch of writes if none is already scheduled. The pending writes lock must be held
+ */
+- (void)scheduleWriteBatch
+{
+    if (self.writeBatchScheduled) {
+        return;
+    }
+    
+    self.writeBatchScheduled = YES;
+    dispatch_async(self.writeQueue, ^{
+        [self writePendingData];
+    });
+}
+
+- (void)enqueueWriteWithContents:(NSData *)contents fullPath:(NSString *)fullPath
+{
+    // Replaces any data not written yet
+    pthread_mutex_lock(&_pendingWritesLock);
+    self.pendingWrites[fullPath] = contents;
+    if (self.writeDurability != HLSFileWriteDurabilityDeferred) {
+        [self scheduleWriteBatch];
+    }
+    pthread_mutex_unlock(&_pendingWritesLock);
+}
+
+/**
+ * Write all pending data (must be called on the write queue). Data remains visible to readers until it has been
+ * written to disk
+ */
+- (void)writePendingData
+{
+    pthread_mutex_lock(&_pendingWritesLock);
+    self.writeBatchScheduled = NO;
+    NSDictionary<NSString *, NSData *> *pendingWrites = [self.pendingWrites copy];
+    pthread_mutex_unlock(&_pendingWritesLock);
+    
+    if (pendingWrites.count == 0) {
+        return;
+    }
+    
+    NSDataWritingOptions writingOptions = [self writingOptions];
+    [pendingWrites enumerateKeysAndObjectsUsingBlock:^(NSString *fullPath, NSData *contents, BOOL *stop) {
+        NSError *error = nil;
+        if (! [contents writeToFile:fullPath options:writingOptions error:&error]) {
+            HLSLoggerError(@"Could not write file %@. Reason: %@", fullPath, error);
+        }
+    }];
+    
+    // Data written again in the meantime is left for the next batch
+    pthread_mutex_lock(&_pendingWritesLock);
+    [pendingWrites enumerateKeysAndObjectsUsingBlock:^(NSString *fullPath, NSData *contents, BOOL *stop) {
+        if (self.pendingWrites[fullPath] == contents) {
+            [self.pendingWrites removeObjectForKey:fullPath];
+        }
+    }];
+    pthread_mutex_unlock(&_pendingWritesLock);
+}
+
+- (NSData *)pendingContentsForFullPath:(NSString *)fullPath
+{
+    pthread_mutex_lock(&_pendingWritesLock);
+    NSData *contents = self.pendingWrites[fullPath];
+    pthread_mutex_unlock(&_pendingWritesLock);
+    return contents;
+}
+
+- (BOOL)hasPendingWrites
+{
+    pthread_mutex_lock(&_pendingWritesLock);
+    BOOL hasPendingWrites = (self.pendingWrites.count != 0);
+    pthread_mutex_unlock(&_pendingWritesLock);
+    return hasPendingWrites;
+}
+
+- (void)flush
+{
+    // Cheap when nothing is pending
+    if (! [self hasPendingWrites]) {
+        return;
+    }
+    
+    pthread_mutex_lock(&_pendingWritesLock);
+    [self scheduleWriteBatch];
+    pthread_mutex_unlock(&_pendingWritesLock);
+    
+    dispatch_sync(self.writeQueue, ^{});
+}
+
+- (void)flushWithCompletionBlock:(void (^)(void))completionBlock
+{
+    pthread_mutex_lock(&_pendingWritesLock);
+    if (self.pendingWrites.count != 0) {
+        [self scheduleWriteBatch];
+    }
+    pthread_mutex_unlock(&_pendingWritesLock);
+    
+    dispatch_async(self.writeQueue, ^{
+        if (completionBlock) {
+            dispatch_async(dispatch_get_main_queue(), completionBlock);
+        }
+    });
+}
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    return [self contentsOfFileAtPath:path readPolicy:self.readPolicy error:pError];
 }
 
 - (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(out NSError *__autoreleasing *)pError
@@ -116,8 +429,21 @@
         return NO;
     }
     
+    if (self.writingAsynchronously || self.writeDurability == HLSFileWriteDurabilityDeferred) {
+        if (! [self checkFileFullPath:fullPath error:pError]) {
+            return NO;
+        }
+        
+        // Data is immutable once handed over
+        [self enqueueWriteWithContents:[contents copy] fullPath:fullPath];
+        return YES;
+    }
+    
+    // A synchronous write must not be overridden by a pending older one
+    [self flush];
+    
     // Overwrite existing files, returning YES and no error
-    return [contents writeToFile:fullPath options:NSDataWritingAtomic error:pError];
+    return [contents writeToFile:fullPath options:[self writingOptions] error:pError];
 }
 
 - (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(out NSError *__autoreleasing *)pError
@@ -127,6 +453,9 @@
         return NO;
     }
     
+    // A pending file might be in the way
+    [self flush];
+    
     // Return YES if the directory already exists
     return [[NSFileManager defaultManager] createDirectoryAtPath:fullPath withIntermediateDirectories:withIntermediateDirectories attributes:nil error:pError];
 }
@@ -138,7 +467,91 @@
         return nil;
     }
     
-    return [[NSFileManager defaultManager] contentsOfDirectoryAtPath:fullPath error:pError];
+    NSArray<NSString *> *contents = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:fullPath error:pError];
+    if (! contents) {
+        return nil;
+    }
+    
+    // Add files which have not been written yet
+    NSMutableOrderedSet<NSString *> *allContents = nil;
+    pthread_mutex_lock(&_pendingWritesLock);
+    for (NSString *pendingFullPath in self.pendingWrites) {
+        if ([pendingFullPath.stringByDeletingLastPathComponent isEqualToString:fullPath]) {
+            if (! allContents) {
+                allContents = [NSMutableOrderedSet orderedSetWithArray:contents];
+            }
+            [allContents addObject:pendingFullPath.lastPathComponent];
+        }
+    }
+    pthread_mutex_unlock(&_pendingWritesLock);
+    
+    return allContents ? allContents.array : contents;
+}
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
+{
+    NSParameterAssert(block);
+    
+    NSString *fullPath = [self fullPathForPath:path withError:pError];
+    if (! fullPath) {
+        return NO;
+    }
+    
+    // Pending files must be on disk so that they are enumerated with their attributes
+    [self flush];
+    
+    BOOL isDirectory = NO;
+    if (! [[NSFileManager defaultManager] fileExistsAtPath:fullPath isDirectory:&isDirectory] || ! isDirectory) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), path]];
+        }
+        return NO;
+    }
+    
+    // Attributes are fetched along with the directory entries, sparing one stat per item
+    NSURL *URL = [NSURL fileURLWithPath:fullPath isDirectory:YES];
+    NSArray<NSURLResourceKey> *keys = @[NSURLIsDirectoryKey, NSURLFileSizeKey, NSURLContentModificationDateKey];
+    NSDirectoryEnumerator<NSURL *> *enumerator = [[NSFileManager defaultManager] enumeratorAtURL:URL
+                                                                      includingPropertiesForKeys:keys
+                                                                                         options:0
+                                                                                    errorHandler:^BOOL(NSURL *itemURL, NSError *error) {
+                                                                                        HLSLoggerWarn(@"Could not enumerate %@. Reason: %@", itemURL, error);
+                                                                                        return YES;
+                                                                                    }];
+    
+    // Item paths are built from the names of their ancestors, which avoids relying on the URL representation of
+    // the root folder (which might differ because of symbolic links)
+    NSMutableArray<NSString *> *pathComponents = [NSMutableArray array];
+    for (NSURL *itemURL in enumerator) {
+        NSUInteger depth = enumerator.level;
+        [pathComponents removeObjectsInRange:NSMakeRange(depth - 1, pathComponents.count - (depth - 1))];
+        [pathComponents addObject:itemURL.lastPathComponent];
+        
+        NSDictionary<NSURLResourceKey, id> *resourceValues = [itemURL resourceValuesForKeys:keys error:NULL];
+        BOOL itemIsDirectory = [resourceValues[NSURLIsDirectoryKey] boolValue];
+        if (itemIsDirectory && maximumDepth != 0 && depth >= maximumDepth) {
+            [enumerator skipDescendants];
+        }
+        
+        NSString *itemPath = [path stringByAppendingPathComponent:[NSString pathWithComponents:pathComponents]];
+        HLSFileItem *item = [[HLSFileItem alloc] initWithPath:itemPath
+                                                    directory:itemIsDirectory
+                                                         size:itemIsDirectory ? 0 : [resourceValues[NSURLFileSizeKey] unsignedLongLongValue]
+                                             modificationDate:resourceValues[NSURLContentModificationDateKey]
+                                                        depth:depth];
+        
+        BOOL stop = NO;
+        block(item, &stop);
+        if (stop) {
+            break;
+        }
+    }
+    return YES;
 }
 
 - (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(out BOOL *)pIsDirectory
@@ -148,6 +561,13 @@
         return NO;
     }
     
+    if ([self pendingContentsForFullPath:fullPath]) {
+        if (pIsDirectory) {
+            *pIsDirectory = NO;
+        }
+        return YES;
+    }
+    
     return [[NSFileManager defaultManager] fileExistsAtPath:fullPath isDirectory:pIsDirectory];
 }
 
@@ -173,6 +593,7 @@
         return NO;
     }
     
+    [self flush];
     return [[NSFileManager defaultManager] copyItemAtPath:fullSourcePath toPath:fullDestinationPath error:pError];
 }
 
@@ -198,6 +619,7 @@
         return NO;
     }
     
+    [self flush];
     return [[NSFileManager defaultManager] moveItemAtPath:fullSourcePath toPath:fullDestinationPath error:pError];
 }
 
@@ -207,6 +629,8 @@
     if (! fullPath) {
         return NO;
     }
+    
+    [self flush];
 
     // Never delete the root, rather delete all its contents
     NSArray *pathComponents = path.pathComponents;
@@ -244,6 +668,7 @@
         return nil;
     }
     
+    [self flush];
     return [NSInputStream inputStreamWithFileAtPath:fullPath];
 }
 
@@ -259,6 +684,7 @@
         return nil;
     }
     
+    [self flush];
     return [NSOutputStream outputStreamToFileAtPath:fullPath append:append];
 }
 
@@ -275,7 +701,15 @@
         return nil;
     }
     
+    [self flush];
     return [NSURL fileURLWithPath:fullPath];
 }
 
+#pragma mark Notification callbacks
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    [self flush];
+}
+
 @end
@@ -0,0 +1,60 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private class giving access to a compiled strings table, i.e. a compact binary representation of a .strings file:
+ * A key index sorted by hash, followed by the UTF-8 bytes of all keys and values. Compiled tables are memory-mapped
+ * and values are looked up directly in the mapping, without building any dictionary
+ *
+ * Strings files are compiled the first time they are needed. Compiled tables are stored in the caches directory and
+ * reused until the strings file is modified
+ */
+@interface HLSStringsTable : NSObject
+
+/**
+ * Return the compiled table corresponding to a strings file, compiling it if needed. Return nil if the strings file
+ * could not be read
+ */
++ (nullable instancetype)stringsTableWithContentsOfFile:(NSString *)filePath;
+
+/**
+ * Compile a strings file, replacing the compiled table if it already exists
+ */
++ (BOOL)compileStringsFileAtPath:(NSString *)filePath toFileAtPath:(NSString *)compiledFilePath error:(NSError *__autoreleasing *)pError;
+
+/**
+ * Create a table from compiled table data. Return nil if the data is not a valid compiled table
+ */
+- (nullable instancetype)initWithData:(NSData *)data NS_DESIGNATED_INITIALIZER;
+
+/**
+ * Create a table with the contents of a dictionary, without writing it to disk
+ */
+- (instancetype)initWithDictionary:(NSDictionary<NSString *, NSString *> *)dictionary;
+
+/**
+ * The number of strings in the table
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * Return the value corresponding to a key, nil if none
+ */
+- (nullable NSString *)objectForKeyedSubscript:(NSString *)key;
+
+@end
+
+@interface HLSStringsTable (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
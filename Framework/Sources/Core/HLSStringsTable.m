@@ -0,0 +1,286 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSStringsTable.h"
+
+#import "HLSApplicationInformation.h"
+#import "NSString+HLSExtensions.h"
+
+static NSString * const HLSStringsTableFileExtension = @"stringstable";
+
+static const uint32_t HLSStringsTableMagic = 0x54534C48;           // 'HLST' in little-endian
+static const uint32_t HLSStringsTableVersion = 1;
+
+/**
+ * Layout of compiled tables (little-endian): A header, the entries sorted by key hash, then the UTF-8 bytes of all
+ * keys and values. Offsets are relative to the beginning of the string bytes
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t stringsLength;
+} HLSStringsTableHeader;
+
+typedef struct {
+    uint32_t hash;
+    uint32_t keyOffset;
+    uint32_t keyLength;
+    uint32_t valueOffset;
+    uint32_t valueLength;
+} HLSStringsTableEntry;
+
+// FNV-1a
+static uint32_t HLSStringsTableHash(const char *bytes, NSUInteger length)
+{
+    uint32_t hash = 2166136261U;
+    for (NSUInteger i = 0; i < length; ++i) {
+        hash ^= (uint8_t)bytes[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static NSData *HLSStringsTableDataWithDictionary(NSDictionary<NSString *, NSString *> *dictionary)
+{
+    NSUInteger count = dictionary.count;
+    NSMutableData *entriesData = [NSMutableData dataWithLength:count * sizeof(HLSStringsTableEntry)];
+    HLSStringsTableEntry *entries = entriesData.mutableBytes;
+    NSMutableData *stringsData = [NSMutableData data];
+
+    __block NSUInteger index = 0;
+    [dictionary enumerateKeysAndObjectsUsingBlock:^(NSString *key, NSString *value, BOOL *stop) {
+        if (! [key isKindOfClass:[NSString class]] || ! [value isKindOfClass:[NSString class]]) {
+            return;
+        }
+
+        NSData *keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        NSData *valueData = [value dataUsingEncoding:NSUTF8StringEncoding];
+
+        HLSStringsTableEntry *entry = &entries[index];
+        entry->hash = HLSStringsTableHash(keyData.bytes, keyData.length);
+        entry->keyOffset = (uint32_t)stringsData.length;
+        entry->keyLength = (uint32_t)keyData.length;
+        [stringsData appendData:keyData];
+        entry->valueOffset = (uint32_t)stringsData.length;
+        entry->valueLength = (uint32_t)valueData.length;
+        [stringsData appendData:valueData];
+        ++index;
+    }];
+    count = index;
+
+    qsort_b(entries, count, sizeof(HLSStringsTableEntry), ^int(const void *entry1, const void *entry2) {
+        uint32_t hash1 = ((const HLSStringsTableEntry *)entry1)->hash;
+        uint32_t hash2 = ((const HLSStringsTableEntry *)entry2)->hash;
+        return (hash1 > hash2) - (hash1 < hash2);
+    });
+
+    HLSStringsTableHeader header = {
+        .magic = HLSStringsTableMagic,
+        .version = HLSStringsTableVersion,
+        .count = (uint32_t)count,
+        .stringsLength = (uint32_t)stringsData.length
+    };
+
+    NSMutableData *data = [NSMutableData dataWithCapacity:sizeof(header) + count * sizeof(HLSStringsTableEntry) + stringsData.length];
+    [data appendBytes:&header length:sizeof(header)];
+    [data appendBytes:entries length:count * sizeof(HLSStringsTableEntry)];
+    [data appendData:stringsData];
+    return [data copy];
+}
+
+@interface HLSStringsTable ()
+
+@property (nonatomic) NSData *data;
+@property (nonatomic) NSUInteger count;
+
+@end
+
+@implementation HLSStringsTable {
+@private
+    const HLSStringsTableEntry *_entries;
+    const char *_strings;
+    NSUInteger _stringsLength;
+}
+
+#pragma mark Class methods
+
++ (instancetype)stringsTableWithContentsOfFile:(NSString *)filePath
+{
+    NSParameterAssert(filePath);
+
+    NSDictionary<NSFileAttributeKey, id> *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:filePath error:NULL];
+    if (! attributes) {
+        return nil;
+    }
+
+    // Compiled tables are identified by the path and the version of the strings file
+    static NSString *s_compiledTablesDirectoryPath = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_compiledTablesDirectoryPath = [HLSApplicationCachesDirectoryPath() stringByAppendingPathComponent:@"HLSStringsTables"];
+    });
+    NSString *compiledFileNamePrefix = [NSString stringWithFormat:@"%@_", filePath.sha1hash];
+    NSString *compiledFileName = [NSString stringWithFormat:@"%@%.0f_%llu.%@",
+                                  compiledFileNamePrefix,
+                                  [attributes.fileModificationDate timeIntervalSince1970],
+                                  attributes.fileSize,
+                                  HLSStringsTableFileExtension];
+    NSString *compiledFilePath = [s_compiledTablesDirectoryPath stringByAppendingPathComponent:compiledFileName];
+
+    NSData *compiledData = [NSData dataWithContentsOfFile:compiledFilePath options:NSDataReadingMappedAlways error:NULL];
+    if (compiledData) {
+        HLSStringsTable *stringsTable = [[self alloc] initWithData:compiledData];
+        if (stringsTable) {
+            return stringsTable;
+        }
+    }
+
+    NSDictionary<NSString *, NSString *> *dictionary = [NSDictionary dictionaryWithContentsOfFile:filePath];
+    if (! dictionary) {
+        return nil;
+    }
+
+    // If the compiled table cannot be saved, use it from memory
+    compiledData = HLSStringsTableDataWithDictionary(dictionary);
+    [[NSFileManager defaultManager] createDirectoryAtPath:s_compiledTablesDirectoryPath withIntermediateDirectories:YES attributes:nil error:NULL];
+    if ([compiledData writeToFile:compiledFilePath atomically:YES]) {
+        // Remove tables compiled for previous versions of the same strings file
+        NSArray<NSString *> *fileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:s_compiledTablesDirectoryPath error:NULL];
+        for (NSString *fileName in fileNames) {
+            if ([fileName hasPrefix:compiledFileNamePrefix] && ! [fileName isEqualToString:compiledFileName]) {
+                [[NSFileManager defaultManager] removeItemAtPath:[s_compiledTablesDirectoryPath stringByAppendingPathComponent:fileName] error:NULL];
+            }
+        }
+    }
+    return [[self alloc] initWithData:compiledData];
+}
+
++ (BOOL)compileStringsFileAtPath:(NSString *)filePath toFileAtPath:(NSString *)compiledFilePath error:(NSError *__autoreleasing *)pError
+{
+    NSParameterAssert(filePath);
+    NSParameterAssert(compiledFilePath);
+
+    NSDictionary<NSString *, NSString *> *dictionary = [NSDictionary dictionaryWithContentsOfFile:filePath];
+    if (! dictionary) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileReadCorruptFileError
+                                      userInfo:@{ NSFilePathErrorKey : filePath }];
+        }
+        return NO;
+    }
+
+    return [HLSStringsTableDataWithDictionary(dictionary) writeToFile:compiledFilePath options:NSDataWritingAtomic error:pError];
+}
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithData:(NSData *)data
+{
+    NSParameterAssert(data);
+
+    if (self = [super init]) {
+        if (data.length < sizeof(HLSStringsTableHeader)) {
+            return nil;
+        }
+
+        const HLSStringsTableHeader *header = data.bytes;
+        if (header->magic != HLSStringsTableMagic || header->version != HLSStringsTableVersion) {
+            return nil;
+        }
+
+        uint64_t expectedLength = sizeof(HLSStringsTableHeader) + (uint64_t)header->count * sizeof(HLSStringsTableEntry) + header->stringsLength;
+        if (data.length != expectedLength) {
+            return nil;
+        }
+
+        self.data = data;
+        self.count = header->count;
+        _entries = (const HLSStringsTableEntry *)(header + 1);
+        _strings = (const char *)(_entries + header->count);
+        _stringsLength = header->stringsLength;
+    }
+    return self;
+}
+
+- (instancetype)initWithDictionary:(NSDictionary<NSString *, NSString *> *)dictionary
+{
+    NSParameterAssert(dictionary);
+
+    return [self initWithData:HLSStringsTableDataWithDictionary(dictionary)];
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Lookup
+
+- (NSString *)objectForKeyedSubscript:(NSString *)key
+{
+    NSParameterAssert(key);
+
+    if (self.count == 0) {
+        return nil;
+    }
+
+    // Avoid copying the key bytes if possible (ASCII strings, for which UTF-8 and string lengths are equal)
+    const char *keyBytes = CFStringGetCStringPtr((__bridge CFStringRef)key, kCFStringEncodingUTF8);
+    NSUInteger keyLength = key.length;
+    NSData *keyData = nil;
+    if (! keyBytes) {
+        keyData = [key dataUsingEncoding:NSUTF8StringEncoding];
+        keyBytes = keyData.bytes;
+        keyLength = keyData.length;
+    }
+
+    // Find the first entry with the same hash, then compare keys
+    uint32_t hash = HLSStringsTableHash(keyBytes, keyLength);
+    NSUInteger low = 0;
+    NSUInteger high = self.count;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (_entries[middle].hash < hash) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    for (NSUInteger i = low; i < self.count && _entries[i].hash == hash; ++i) {
+        const HLSStringsTableEntry *entry = &_entries[i];
+        if (entry->keyLength != keyLength || (uint64_t)entry->keyOffset + entry->keyLength > _stringsLength
+                || memcmp(_strings + entry->keyOffset, keyBytes, keyLength) != 0) {
+            continue;
+        }
+
+        if ((uint64_t)entry->valueOffset + entry->valueLength > _stringsLength) {
+            return nil;
+        }
+        return [[NSString alloc] initWithBytes:_strings + entry->valueOffset length:entry->valueLength encoding:NSUTF8StringEncoding];
+    }
+    return nil;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; count: %@>",
+            [self class],
+            self,
+            @(self.count)];
+}
+
+@end
@@ -0,0 +1,77 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManager.h"
+#import "HLSInMemoryFileManager.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A file manager placing a memory tier (an HLSInMemoryFileManager) in front of a disk tier (any other file manager,
+ * usually an HLSStandardFileManager):
+ *   - Files are written to the memory tier only. When they are evicted from the memory cache (cost limit reached or
+ *     memory warning), they are written back to the disk tier asynchronously. Until then, they are still readable
+ *   - Files not found in the memory tier are read from the disk tier and promoted to the memory tier
+ *   - Directories are created on the disk tier, and copies, moves and removals are applied to both tiers
+ *
+ * Call -flush to force pending data to be written to the disk tier, e.g. when the application enters background
+ *
+ * The file manager can be safely used from several threads at the same time. The disk tier must not be altered
+ * directly while in use by a tiered file manager
+ */
+@interface HLSTieredFileManager : HLSFileManager <HLSInMemoryFileManagerDelegate>
+
+/**
+ * Create a tiered file manager with the specified disk tier. The memory tier is created with flat storage
+ */
+- (instancetype)initWithDiskFileManager:(HLSFileManager *)diskFileManager NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The disk tier
+ */
+@property (nonatomic, readonly) HLSFileManager *diskFileManager;
+
+/**
+ * Size of the memory tier, in bytes (refer to -[HLSInMemoryFileManager byteCostLimit] for more information). Above
+ * this limit, files are evicted and written back to the disk tier
+ *
+ * Default value is 0 (no limit)
+ */
+@property (nonatomic) NSUInteger byteCostLimit;
+
+/**
+ * Synchronously write all data only available in memory to the disk tier. Data stays in the memory tier
+ */
+- (void)flush;
+
+/**
+ * Statistics, which can be used to tune byteCostLimit:
+ *   - hitCount: Number of file reads served from memory
+ *   - missCount: Number of file reads which had to access the disk tier
+ *   - promotionCount: Number of files read from disk and promoted to the memory tier
+ *   - writeBackCount: Number of evicted files which had to be written back to the disk tier
+ */
+@property (nonatomic, readonly) NSUInteger hitCount;
+@property (nonatomic, readonly) NSUInteger missCount;
+@property (nonatomic, readonly) NSUInteger promotionCount;
+@property (nonatomic, readonly) NSUInteger writeBackCount;
+
+/**
+ * Reset all statistics to 0
+ */
+- (void)resetStatistics;
+
+@end
+
+@interface HLSTieredFileManager (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
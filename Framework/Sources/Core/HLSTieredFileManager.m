@@ -0,0 +1,685 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSTieredFileManager.h"
+
+#import "HLSFileManager+Friend.h"
+#import "HLSInMemoryFileManager+Friend.h"
+#import "HLSInMemoryOutputStream.h"
+#import "HLSLogger.h"
+#import "NSBundle+HLSExtensions.h"
+#import "NSError+HLSExtensions.h"
+
+#import <pthread.h>
+#import <stdatomic.h>
+#import <UIKit/UIKit.h>
+
+@interface HLSTieredFileManager () {
+@private
+    pthread_mutex_t _mutationLock;                                              // Serializes operations altering the tiers
+    pthread_mutex_t _stateLock;                                                 // Protects dirty paths and pending writes
+    _Atomic(NSUInteger) _generation;                                            // Incremented each time the tiers are altered
+    _Atomic(NSUInteger) _hitCount;
+    _Atomic(NSUInteger) _missCount;
+    _Atomic(NSUInteger) _promotionCount;
+    _Atomic(NSUInteger) _writeBackCount;
+}
+
+@property (nonatomic) HLSInMemoryFileManager *memoryFileManager;
+@property (nonatomic) HLSFileManager *diskFileManager;
+@property (nonatomic) NSMutableSet<NSString *> *dirtyPaths;                     // Files whose data is only available in memory
+@property (nonatomic) NSMutableDictionary<NSString *, NSData *> *pendingWrites; // Data evicted from memory, not written to disk yet
+@property (nonatomic) dispatch_queue_t diskQueue;                               // Serial queue on which the disk tier is altered
+
+@end
+
+@implementation HLSTieredFileManager
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithDiskFileManager:(HLSFileManager *)diskFileManager
+{
+    NSParameterAssert(diskFileManager);
+
+    if (self = [super init]) {
+        self.diskFileManager = diskFileManager;
+
+        // Registered before the memory tier, so that dirty data is moved to pending writes before the memory tier is
+        // cleared
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning:)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+
+        self.memoryFileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+        self.memoryFileManager.delegate = self;
+
+        pthread_mutex_init(&_mutationLock, NULL);
+        pthread_mutex_init(&_stateLock, NULL);
+
+        self.dirtyPaths = [NSMutableSet set];
+        self.pendingWrites = [NSMutableDictionary dictionary];
+        self.diskQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSTieredFileManager.disk", DISPATCH_QUEUE_SERIAL);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+
+    pthread_mutex_destroy(&_mutationLock);
+    pthread_mutex_destroy(&_stateLock);
+}
+
+#pragma mark Accessors and mutators
+
+- (NSUInteger)byteCostLimit
+{
+    return self.memoryFileManager.byteCostLimit;
+}
+
+- (void)setByteCostLimit:(NSUInteger)byteCostLimit
+{
+    self.memoryFileManager.byteCostLimit = byteCostLimit;
+}
+
+- (NSUInteger)hitCount
+{
+    return atomic_load(&_hitCount);
+}
+
+- (NSUInteger)missCount
+{
+    return atomic_load(&_missCount);
+}
+
+- (NSUInteger)promotionCount
+{
+    return atomic_load(&_promotionCount);
+}
+
+- (NSUInteger)writeBackCount
+{
+    return atomic_load(&_writeBackCount);
+}
+
+#pragma mark Statistics
+
+- (void)resetStatistics
+{
+    atomic_store(&_hitCount, 0);
+    atomic_store(&_missCount, 0);
+    atomic_store(&_promotionCount, 0);
+    atomic_store(&_writeBackCount, 0);
+}
+
+#pragma mark Helpers
+
+- (NSError *)invalidPathError
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain
+                               code:NSFileReadInvalidFileNameError
+               localizedDescription:CoconutKitLocalizedString(@"Invalid file path", nil)];
+}
+
+/**
+ * Files are looked up in memory first, then in the pending write list, and finally on disk. Data moving from one
+ * location to the next is always inserted before being removed, which guarantees that it can always be found
+ */
+- (BOOL)itemExistsAtNormalizedPath:(NSString *)path isDirectory:(BOOL *)pIsDirectory
+{
+    if ([self.memoryFileManager fileExistsAtPath:path isDirectory:pIsDirectory]) {
+        return YES;
+    }
+
+    pthread_mutex_lock(&_stateLock);
+    BOOL pending = (self.pendingWrites[path] != nil);
+    pthread_mutex_unlock(&_stateLock);
+
+    if (pending) {
+        if (pIsDirectory) {
+            *pIsDirectory = NO;
+        }
+        return YES;
+    }
+
+    return [self.diskFileManager fileExistsAtPath:path isDirectory:pIsDirectory];
+}
+
+#pragma mark Disk tier management
+
+/**
+ * Synchronously perform an operation altering the disk tier, after all pending writes have been made
+ */
+- (BOOL)performDiskOperationWithBlock:(BOOL (^)(NSError *__autoreleasing *pError))block error:(NSError *__autoreleasing *)pError
+{
+    __block BOOL success = NO;
+    __block NSError *error = nil;
+    dispatch_sync(self.diskQueue, ^{
+        NSError *blockError = nil;
+        success = block(&blockError);
+        error = blockError;
+    });
+
+    if (! success && pError) {
+        *pError = error;
+    }
+    return success;
+}
+
+- (void)scheduleWriteBackForPath:(NSString *)path contents:(NSData *)contents
+{
+    pthread_mutex_lock(&_stateLock);
+    self.pendingWrites[path] = contents;
+    pthread_mutex_unlock(&_stateLock);
+
+    dispatch_async(self.diskQueue, ^{
+        NSError *error = nil;
+        if (! [self.diskFileManager createFileAtPath:path contents:contents error:&error]) {
+            HLSLoggerError(@"Could not write %@ back to disk. Reason: %@", path, error);
+        }
+
+        // The data might have been evicted again in the meantime, in which case another write is pending
+        pthread_mutex_lock(&_stateLock);
+        if (self.pendingWrites[path] == contents) {
+            [self.pendingWrites removeObjectForKey:path];
+        }
+        pthread_mutex_unlock(&_stateLock);
+    });
+}
+
+/**
+ * Schedule dirty files located at, below or above the specified path to be written back to disk, so that the disk
+ * tier can be altered consistently. Return the number of files scheduled, excluding those which had already been
+ * evicted. The mutation lock must be held
+ */
+- (NSUInteger)writeBackItemsRelatedToPath:(NSString *)path
+{
+    NSString *prefix = [path isEqualToString:@"/"] ? path : [path stringByAppendingString:@"/"];
+
+    NSMutableArray<NSString *> *dirtyPaths = [NSMutableArray array];
+    pthread_mutex_lock(&_stateLock);
+    for (NSString *dirtyPath in self.dirtyPaths) {
+        if ([dirtyPath isEqualToString:path] || [dirtyPath hasPrefix:prefix] || [path hasPrefix:[dirtyPath stringByAppendingString:@"/"]]) {
+            [dirtyPaths addObject:dirtyPath];
+        }
+    }
+    pthread_mutex_unlock(&_stateLock);
+
+    NSUInteger writeBackCount = 0;
+    for (NSString *dirtyPath in dirtyPaths) {
+        NSData *contents = [self.memoryFileManager contentsOfFileAtPath:dirtyPath error:NULL];
+
+        // Already evicted. Wait until the eviction has been reported, which schedules the write back
+        if (! contents) {
+            [self.memoryFileManager waitUntilEvictionsAreProcessed];
+            continue;
+        }
+
+        pthread_mutex_lock(&_stateLock);
+        BOOL dirty = [self.dirtyPaths containsObject:dirtyPath];
+        [self.dirtyPaths removeObject:dirtyPath];
+        pthread_mutex_unlock(&_stateLock);
+
+        if (dirty) {
+            [self scheduleWriteBackForPath:dirtyPath contents:contents];
+            ++writeBackCount;
+        }
+    }
+    return writeBackCount;
+}
+
+/**
+ * Promote data read from disk to the memory tier, provided the tiers have not been altered since the data was read
+ * (generation); otherwise stale data might override more recent data
+ */
+- (void)promoteFileAtPath:(NSString *)path contents:(NSData *)contents generation:(NSUInteger)generation
+{
+    pthread_mutex_lock(&_mutationLock);
+    if (atomic_load(&_generation) == generation && ! [self.memoryFileManager fileExistsAtPath:path]) {
+        [self.memoryFileManager createDirectoryAtPath:path.stringByDeletingLastPathComponent withIntermediateDirectories:YES error:NULL];
+        if ([self.memoryFileManager createFileAtPath:path contents:contents error:NULL]) {
+            atomic_fetch_add(&_promotionCount, 1);
+        }
+    }
+    pthread_mutex_unlock(&_mutationLock);
+}
+
+- (void)flush
+{
+    [self.memoryFileManager waitUntilEvictionsAreProcessed];
+
+    pthread_mutex_lock(&_mutationLock);
+    [self writeBackItemsRelatedToPath:@"/"];
+    pthread_mutex_unlock(&_mutationLock);
+
+    // Wait until all writes have been made
+    dispatch_sync(self.diskQueue, ^{});
+}
+
+#pragma mark HLSFileManagerAbstract protocol implementation
+
+- (NSData *)contentsOfFileAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return nil;
+    }
+
+    NSData *contents = [self.memoryFileManager contentsOfFileAtPath:normalizedPath error:NULL];
+    if (! contents) {
+        pthread_mutex_lock(&_stateLock);
+        contents = self.pendingWrites[normalizedPath];
+        BOOL dirty = [self.dirtyPaths containsObject:normalizedPath];
+        pthread_mutex_unlock(&_stateLock);
+
+        // Dirty data evicted from memory is only moved to pending writes once the eviction has been processed. Wait
+        // for it, otherwise the file would be reported as missing
+        if (! contents && dirty) {
+            [self.memoryFileManager waitUntilEvictionsAreProcessed];
+
+            pthread_mutex_lock(&_stateLock);
+            contents = self.pendingWrites[normalizedPath];
+            pthread_mutex_unlock(&_stateLock);
+
+            if (! contents) {
+                contents = [self.memoryFileManager contentsOfFileAtPath:normalizedPath error:NULL];
+            }
+        }
+    }
+
+    if (contents) {
+        atomic_fetch_add(&_hitCount, 1);
+        return contents;
+    }
+
+    atomic_fetch_add(&_missCount, 1);
+
+    NSUInteger generation = atomic_load(&_generation);
+    contents = [self.diskFileManager contentsOfFileAtPath:normalizedPath error:pError];
+    if (! contents) {
+        return nil;
+    }
+
+    [self promoteFileAtPath:normalizedPath contents:contents generation:generation];
+    return contents;
+}
+
+- (BOOL)createFileAtPath:(NSString *)path contents:(NSData *)contents error:(out NSError *__autoreleasing *)pError
+{
+    if (! contents) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteUnknownError
+                          localizedDescription:CoconutKitLocalizedString(@"No data has been provided", nil)];
+        }
+        return NO;
+    }
+
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    pthread_mutex_lock(&_mutationLock);
+
+    // Must fail if the parent directory does not exist
+    BOOL isParentDirectory = NO;
+    NSString *parentPath = normalizedPath.stringByDeletingLastPathComponent;
+    if (! [self itemExistsAtNormalizedPath:parentPath isDirectory:&isParentDirectory] || ! isParentDirectory) {
+        pthread_mutex_unlock(&_mutationLock);
+
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileNoSuchFileError
+                          localizedDescription:[NSString stringWithFormat:CoconutKitLocalizedString(@"The directory %@ does not exist", nil), parentPath]];
+        }
+        return NO;
+    }
+
+    // Directories cannot be replaced with files
+    BOOL isDirectory = NO;
+    if ([self itemExistsAtNormalizedPath:normalizedPath isDirectory:&isDirectory] && isDirectory) {
+        pthread_mutex_unlock(&_mutationLock);
+
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain
+                                          code:NSFileWriteFileExistsError
+                          localizedDescription:CoconutKitLocalizedString(@"The destination already exists", nil)];
+        }
+        return NO;
+    }
+
+    atomic_fetch_add(&_generation, 1);
+
+    // Mark the file as dirty first, since the memory tier might evict it immediately if the cost limit is reached
+    pthread_mutex_lock(&_stateLock);
+    [self.dirtyPaths addObject:normalizedPath];
+    pthread_mutex_unlock(&_stateLock);
+
+    [self.memoryFileManager createDirectoryAtPath:parentPath withIntermediateDirectories:YES error:NULL];
+    BOOL created = [self.memoryFileManager createFileAtPath:normalizedPath contents:contents error:pError];
+    if (! created) {
+        pthread_mutex_lock(&_stateLock);
+        [self.dirtyPaths removeObject:normalizedPath];
+        pthread_mutex_unlock(&_stateLock);
+    }
+
+    pthread_mutex_unlock(&_mutationLock);
+    return created;
+}
+
+- (BOOL)createDirectoryAtPath:(NSString *)path withIntermediateDirectories:(BOOL)withIntermediateDirectories error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    pthread_mutex_lock(&_mutationLock);
+
+    // A file only available in memory might be in the way
+    [self writeBackItemsRelatedToPath:normalizedPath];
+    atomic_fetch_add(&_generation, 1);
+
+    // Directories are only created on disk
+    BOOL created = [self performDiskOperationWithBlock:^BOOL(NSError *__autoreleasing *pDiskError) {
+        return [self.diskFileManager createDirectoryAtPath:normalizedPath withIntermediateDirectories:withIntermediateDirectories error:pDiskError];
+    } error:pError];
+
+    pthread_mutex_unlock(&_mutationLock);
+    return created;
+}
+
+- (NSArray<NSString *> *)contentsOfDirectoryAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return nil;
+    }
+
+    // Merge the contents of both tiers, as well as files waiting to be written to disk
+    NSError *diskError = nil;
+    NSArray<NSString *> *diskContents = [self.diskFileManager contentsOfDirectoryAtPath:normalizedPath error:&diskError];
+    NSArray<NSString *> *memoryContents = [self.memoryFileManager contentsOfDirectoryAtPath:normalizedPath error:NULL];
+    if (! diskContents && ! memoryContents) {
+        if (pError) {
+            *pError = diskError;
+        }
+        return nil;
+    }
+
+    NSMutableOrderedSet<NSString *> *contents = [NSMutableOrderedSet orderedSet];
+    if (diskContents) {
+        [contents addObjectsFromArray:diskContents];
+    }
+    if (memoryContents) {
+        [contents addObjectsFromArray:memoryContents];
+    }
+
+    pthread_mutex_lock(&_stateLock);
+    for (NSString *pendingPath in self.pendingWrites) {
+        if ([pendingPath.stringByDeletingLastPathComponent isEqualToString:normalizedPath]) {
+            [contents addObject:pendingPath.lastPathComponent];
+        }
+    }
+    pthread_mutex_unlock(&_stateLock);
+
+    return contents.array;
+}
+
+- (BOOL)enumerateItemsAtPath:(NSString *)path
+                maximumDepth:(NSUInteger)maximumDepth
+                       error:(out NSError *__autoreleasing *)pError
+                  usingBlock:(void (^)(HLSFileItem *item, BOOL *pStop))block
+{
+    NSParameterAssert(block);
+
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    // The disk tier contains the whole hierarchy once dirty files below the path have been written back, and provides
+    // attributes for all of them in a single pass
+    [self.memoryFileManager waitUntilEvictionsAreProcessed];
+
+    pthread_mutex_lock(&_mutationLock);
+    [self writeBackItemsRelatedToPath:normalizedPath];
+    pthread_mutex_unlock(&_mutationLock);
+
+    dispatch_sync(self.diskQueue, ^{});
+
+    return [self.diskFileManager enumerateItemsAtPath:normalizedPath maximumDepth:maximumDepth error:pError usingBlock:block];
+}
+
+- (BOOL)fileExistsAtPath:(NSString *)path isDirectory:(out BOOL *)pIsDirectory
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        return NO;
+    }
+
+    return [self itemExistsAtNormalizedPath:normalizedPath isDirectory:pIsDirectory];
+}
+
+- (BOOL)copyItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedSourcePath = HLSFileManagerNormalizedPath(sourcePath);
+    NSString *normalizedDestinationPath = HLSFileManagerNormalizedPath(destinationPath);
+    if (! normalizedSourcePath || ! normalizedDestinationPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    pthread_mutex_lock(&_mutationLock);
+
+    // Bring the disk tier up to date, so that it can perform the copy (and all required checks) itself
+    [self writeBackItemsRelatedToPath:normalizedSourcePath];
+    [self writeBackItemsRelatedToPath:normalizedDestinationPath];
+    atomic_fetch_add(&_generation, 1);
+
+    BOOL copied = [self performDiskOperationWithBlock:^BOOL(NSError *__autoreleasing *pDiskError) {
+        return [self.diskFileManager copyItemAtPath:normalizedSourcePath toPath:normalizedDestinationPath error:pDiskError];
+    } error:pError];
+
+    // Copy what is available in memory as well (cheap, since copies share their data)
+    if (copied && [self.memoryFileManager fileExistsAtPath:normalizedSourcePath]) {
+        [self.memoryFileManager createDirectoryAtPath:normalizedDestinationPath.stringByDeletingLastPathComponent withIntermediateDirectories:YES error:NULL];
+        [self.memoryFileManager copyItemAtPath:normalizedSourcePath toPath:normalizedDestinationPath error:NULL];
+    }
+
+    pthread_mutex_unlock(&_mutationLock);
+    return copied;
+}
+
+- (BOOL)moveItemAtPath:(NSString *)sourcePath toPath:(NSString *)destinationPath error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedSourcePath = HLSFileManagerNormalizedPath(sourcePath);
+    NSString *normalizedDestinationPath = HLSFileManagerNormalizedPath(destinationPath);
+    if (! normalizedSourcePath || ! normalizedDestinationPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    pthread_mutex_lock(&_mutationLock);
+
+    // Bring the disk tier up to date, so that it can perform the move (and all required checks) itself
+    [self writeBackItemsRelatedToPath:normalizedSourcePath];
+    [self writeBackItemsRelatedToPath:normalizedDestinationPath];
+    atomic_fetch_add(&_generation, 1);
+
+    BOOL moved = [self performDiskOperationWithBlock:^BOOL(NSError *__autoreleasing *pDiskError) {
+        return [self.diskFileManager moveItemAtPath:normalizedSourcePath toPath:normalizedDestinationPath error:pDiskError];
+    } error:pError];
+
+    if (moved && [self.memoryFileManager fileExistsAtPath:normalizedSourcePath]) {
+        [self.memoryFileManager createDirectoryAtPath:normalizedDestinationPath.stringByDeletingLastPathComponent withIntermediateDirectories:YES error:NULL];
+        [self.memoryFileManager moveItemAtPath:normalizedSourcePath toPath:normalizedDestinationPath error:NULL];
+    }
+
+    pthread_mutex_unlock(&_mutationLock);
+    return moved;
+}
+
+- (BOOL)removeItemAtPath:(NSString *)path error:(out NSError *__autoreleasing *)pError
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        if (pError) {
+            *pError = [self invalidPathError];
+        }
+        return NO;
+    }
+
+    pthread_mutex_lock(&_mutationLock);
+
+    atomic_fetch_add(&_generation, 1);
+
+    // Dirty data is discarded. Writes already pending are made before the item is removed from disk
+    NSString *prefix = [normalizedPath isEqualToString:@"/"] ? normalizedPath : [normalizedPath stringByAppendingString:@"/"];
+    pthread_mutex_lock(&_stateLock);
+    for (NSString *dirtyPath in [self.dirtyPaths allObjects]) {
+        if ([dirtyPath isEqualToString:normalizedPath] || [dirtyPath hasPrefix:prefix]) {
+            [self.dirtyPaths removeObject:dirtyPath];
+        }
+    }
+    pthread_mutex_unlock(&_stateLock);
+
+    BOOL removedFromMemory = [self.memoryFileManager removeItemAtPath:normalizedPath error:NULL];
+
+    NSError *diskError = nil;
+    BOOL removedFromDisk = [self performDiskOperationWithBlock:^BOOL(NSError *__autoreleasing *pDiskError) {
+        return [self.diskFileManager removeItemAtPath:normalizedPath error:pDiskError];
+    } error:&diskError];
+
+    pthread_mutex_unlock(&_mutationLock);
+
+    // Files only available in memory are not found on disk
+    if (! removedFromMemory && ! removedFromDisk) {
+        if (pError) {
+            *pError = diskError;
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+#pragma mark HLSFileManagerStreamSupport protocol implementation
+
+- (NSInputStream *)inputStreamWithFileAtPath:(NSString *)path
+{
+    NSData *data = [self contentsOfFileAtPath:path error:NULL];
+    if (! data) {
+        return nil;
+    }
+
+    return [NSInputStream inputStreamWithData:data];
+}
+
+- (NSOutputStream *)outputStreamToFileAtPath:(NSString *)path append:(BOOL)append
+{
+    NSString *normalizedPath = HLSFileManagerNormalizedPath(path);
+    if (! normalizedPath) {
+        return nil;
+    }
+
+    BOOL isParentDirectory = NO;
+    if (! [self itemExistsAtNormalizedPath:normalizedPath.stringByDeletingLastPathComponent isDirectory:&isParentDirectory] || ! isParentDirectory) {
+        return nil;
+    }
+
+    BOOL isDirectory = NO;
+    BOOL exists = [self itemExistsAtNormalizedPath:normalizedPath isDirectory:&isDirectory];
+    if (exists && isDirectory) {
+        return nil;
+    }
+
+    // When appending, the stream starts with the file contents available at creation time
+    NSData *initialData = (append && exists) ? [self contentsOfFileAtPath:normalizedPath error:NULL] : nil;
+    return [[HLSInMemoryOutputStream alloc] initWithData:initialData commitBlock:^(NSData *data) {
+        NSError *error = nil;
+        if (! [self createFileAtPath:normalizedPath contents:data error:&error]) {
+            HLSLoggerWarn(@"Could not commit output stream data to %@. Reason: %@", normalizedPath, error);
+        }
+    }];
+}
+
+#pragma mark HLSInMemoryFileManagerDelegate protocol implementation
+
+- (void)inMemoryFileManager:(HLSInMemoryFileManager *)fileManager willEvictFileAtPath:(NSString *)path contents:(NSData *)contents
+{
+    // Called with the memory tier locked: Must not access it. Only dirty data needs to be written back, the disk tier
+    // already contains the rest. This also applies when the memory tier is cleared because of a memory warning
+    pthread_mutex_lock(&_stateLock);
+    BOOL dirty = [self.dirtyPaths containsObject:path];
+    [self.dirtyPaths removeObject:path];
+    pthread_mutex_unlock(&_stateLock);
+
+    if (dirty) {
+        atomic_fetch_add(&_writeBackCount, 1);
+        [self scheduleWriteBackForPath:path contents:contents];
+    }
+}
+
+#pragma mark Notification callbacks
+
+- (void)didReceiveMemoryWarning:(NSNotification *)notification
+{
+    // Move dirty data to pending writes right away, rather than when evictions are processed
+    pthread_mutex_lock(&_mutationLock);
+    NSUInteger writeBackCount = [self writeBackItemsRelatedToPath:@"/"];
+    pthread_mutex_unlock(&_mutationLock);
+
+    atomic_fetch_add(&_writeBackCount, writeBackCount);
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; diskFileManager: %@; hitCount: %@; missCount: %@; promotionCount: %@; writeBackCount: %@>",
+            [self class],
+            self,
+            self.diskFileManager,
+            @(self.hitCount),
+            @(self.missCount),
+            @(self.promotionCount),
+            @(self.writeBackCount)];
+}
+
+@end
@@ -8,6 +8,7 @@
 
 #import <objc/runtime.h>
 #import "HLSLogger.h"
+#import "HLSStringsTable.h"
 
 NSString * const HLSCurrentLocalizationDidChangeNotification = @"HLSCurrentLocalizationDidChangeNotification";
 NSString * const HLSMissingLocalization = @"HLSMissingLocalization";
@@ -16,7 +17,13 @@ static NSString * const HLSPreferredLocalizationDefaultsKey = @"HLSPreferredLoca
 
 static NSString *currentLocalization = nil;
 
+// Compiled strings tables, by bundle. Replaced when the localization changes
+static NSMapTable<NSBundle *, NSCache<NSString *, id> *> *stringsTableCaches = nil;
+
 static void setDefaultLocalization(void);
+static NSCache<NSString *, id> *stringsTableCacheForBundle(NSBundle *bundle);
+static HLSStringsTable *stringsTableForBundle(NSBundle *bundle, NSString *tableName, NSString *localization);
+static void invalidateStringsTableCaches(void);
 static void exchangeNSBundleInstanceMethod(SEL originalSelector);
 static void initialize(void);
 
@@ -49,6 +56,77 @@ NSString *HLSLocalizedDescriptionForCFNetworkError(NSInteger errorCode)
     return HLSLocalizedStringFromBundle(key, s_bundle);
 }
 
+/**
+ * Strings tables are cached per bundle and table name for the current localization. Caches are purged automatically
+ * under memory pressure
+ */
+static NSCache<NSString *, id> *stringsTableCacheForBundle(NSBundle *bundle)
+{
+    @synchronized([NSBundle class]) {
+        if (! stringsTableCaches) {
+            stringsTableCaches = [NSMapTable weakToStrongObjectsMapTable];
+        }
+        
+        NSCache<NSString *, id> *stringsTableCache = [stringsTableCaches objectForKey:bundle];
+        if (! stringsTableCache) {
+            stringsTableCache = [[NSCache alloc] init];
+            stringsTableCache.name = [NSString stringWithFormat:@"ch.defagos.CoconutKit.NSBundle.stringsTables.%@", bundle.bundlePath.lastPathComponent];
+            [stringsTableCaches setObject:stringsTableCache forKey:bundle];
+        }
+        return stringsTableCache;
+    }
+}
+
+/**
+ * Lookups still running with a former cache only fill this cache, which is discarded
+ */
+static void invalidateStringsTableCaches(void)
+{
+    @synchronized([NSBundle class]) {
+        stringsTableCaches = nil;
+    }
+}
+
+/**
+ * Load a strings table of a bundle for a localization. Return an empty table if the table does not exist, and nil if
+ * the bundle does not support the localization. Tables are compiled the first time they are loaded, so that values
+ * can be looked up without parsing the strings file again
+ */
+static HLSStringsTable *stringsTableForBundle(NSBundle *bundle, NSString *tableName, NSString *localization)
+{
+    NSString *localizationName = localization;
+    BOOL lprojFound = YES;
+    NSString *lprojPath = [[bundle.bundlePath stringByAppendingPathComponent:localization] stringByAppendingPathExtension:@"lproj"];
+    if (![[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
+        // Handle old style English.lproj / French.lproj / German.lproj ...
+        static NSLocale *enLocale = nil;
+        if (!enLocale) {
+            enLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en"];
+        }
+        NSString *displayLocalizationName = [enLocale displayNameForKey:NSLocaleLanguageCode value:localization];
+        lprojPath = [[bundle.bundlePath stringByAppendingPathComponent:displayLocalizationName] stringByAppendingPathExtension:@"lproj"];
+        if ([[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
+            localizationName = displayLocalizationName;
+        }
+        else {
+            lprojFound = NO;
+        }
+    }
+    
+    if (! lprojFound) {
+        return nil;
+    }
+    
+    static HLSStringsTable *s_emptyStringsTable = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_emptyStringsTable = [[HLSStringsTable alloc] initWithDictionary:@{}];
+    });
+    
+    NSString *tablePath = [bundle pathForResource:tableName ofType:@"strings" inDirectory:nil forLocalization:localizationName];
+    return (tablePath ? [HLSStringsTable stringsTableWithContentsOfFile:tablePath] : nil) ?: s_emptyStringsTable;
+}
+
 static void setDefaultLocalization(void)
 {
     NSArray *mainBundleLocalizations = [NSBundle mainBundle].localizations;
@@ -101,6 +179,7 @@ static void setDefaultLocalization(void)
     }
     
     if (![currentLocalization isEqualToString:previousLocalization]) {
+        invalidateStringsTableCaches();
         [[NSNotificationCenter defaultCenter] postNotificationName:HLSCurrentLocalizationDidChangeNotification object:self];
     }
     
@@ -118,37 +197,25 @@ static void setDefaultLocalization(void)
         return notFoundValue;
     }
     
-    NSString *localizationName = currentLocalization;
-    BOOL lprojFound = YES;
-    NSString *lprojPath = [[self.bundlePath stringByAppendingPathComponent:currentLocalization] stringByAppendingPathExtension:@"lproj"];
-    if (![[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
-        // Handle old style English.lproj / French.lproj / German.lproj ...
-        static NSLocale *enLocale = nil;
-        if (!enLocale) {
-            enLocale = [[NSLocale alloc] initWithLocaleIdentifier:@"en"];
-        }
-        NSString *displayLocalizationName = [enLocale displayNameForKey:NSLocaleLanguageCode value:currentLocalization];
-        lprojPath = [[self.bundlePath stringByAppendingPathComponent:displayLocalizationName] stringByAppendingPathExtension:@"lproj"];
-        if ([[NSFileManager defaultManager] fileExistsAtPath:lprojPath]) {
-            localizationName = displayLocalizationName;
-        }
-        else {
-            lprojFound = NO;
-        }
+    if (tableName.length == 0) {
+        tableName = @"Localizable";
     }
     
-    if (! lprojFound) {
-        return notFoundValue;
-    }
+    // Retrieve the cache first, so that a table is never cached for a localization it does not belong to
+    NSCache<NSString *, id> *stringsTableCache = stringsTableCacheForBundle(self);
+    NSString *localization = currentLocalization;
     
-    if (tableName.length == 0) {
-        tableName = @"Localizable";
+    id table = [stringsTableCache objectForKey:tableName];
+    if (! table) {
+        table = stringsTableForBundle(self, tableName, localization) ?: [NSNull null];
+        [stringsTableCache setObject:table forKey:tableName];
     }
     
-    NSString *tablePath = [self pathForResource:tableName ofType:@"strings" inDirectory:nil forLocalization:localizationName];
-    NSDictionary *table = [NSDictionary dictionaryWithContentsOfFile:tablePath];
+    if (table == [NSNull null]) {
+        return notFoundValue;
+    }
     
-    NSString *localizedString = table[key];
+    NSString *localizedString = ((HLSStringsTable *)table)[key];
     
     if (! localizedString) {
         if ([[NSUserDefaults standardUserDefaults] boolForKey:@"NSShowNonLocalizedStrings"]) {
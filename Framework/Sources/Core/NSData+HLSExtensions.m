@@ -6,21 +6,17 @@
 
 #import "NSData+HLSExtensions.h"
 
-#import <CommonCrypto/CommonDigest.h>
+#import "HLSDigest.h"
 
-static NSString* digest(NSData *data, unsigned char *(*cc_digest)(const void *, CC_LONG, unsigned char *), CC_LONG digestLength)
+/**
+ * Data is fed region by region, which avoids flattening non-contiguous data (e.g. received from the network) into a
+ * temporary buffer
+ */
+static NSString *digest(NSData *data, HLSDigestAlgorithm algorithm)
 {
-	unsigned char md[digestLength];     // C99
-    memset(md, 0, sizeof(md));
-	cc_digest(data.bytes, (CC_LONG)data.length, md);
-    
-    // Hexadecimal representation
-    NSMutableString *hexHash = [NSMutableString string];
-    for (NSUInteger i = 0; i < sizeof(md); ++i) {
-        [hexHash appendFormat:@"%02X", md[i]];
-    }
-    
-    return hexHash.lowercaseString;
+    HLSDigest *dataDigest = [[HLSDigest alloc] initWithAlgorithm:algorithm];
+    [dataDigest updateWithData:data];
+    return dataDigest.hexadecimalDigest;
 }
 
 @implementation NSData (HLSExtensions)
@@ -29,42 +25,42 @@ static NSString* digest(NSData *data, unsigned char *(*cc_digest)(const void *,
 
 - (NSString *)md2hash
 {
-    return digest(self, CC_MD2, CC_MD2_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmMD2);
 }
 
 - (NSString *)md4hash
 {
-    return digest(self, CC_MD4, CC_MD4_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmMD4);
 }
 
 - (NSString *)md5hash
 {
-    return digest(self, CC_MD5, CC_MD5_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmMD5);
 }
 
 - (NSString *)sha1hash
 {
-    return digest(self, CC_SHA1, CC_SHA1_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmSHA1);
 }
 
 - (NSString *)sha224hash
 {
-    return digest(self, CC_SHA224, CC_SHA224_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmSHA224);
 }
 
 - (NSString *)sha256hash
 {
-    return digest(self, CC_SHA256, CC_SHA256_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmSHA256);
 }
 
 - (NSString *)sha384hash
 {
-    return digest(self, CC_SHA384, CC_SHA384_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmSHA384);
 }
 
 - (NSString *)sha512hash
 {
-    return digest(self, CC_SHA512, CC_SHA512_DIGEST_LENGTH);
+    return digest(self, HLSDigestAlgorithmSHA512);
 }
 
 @end
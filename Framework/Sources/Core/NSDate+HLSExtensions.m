@@ -20,7 +20,7 @@ static NSString *swizzle_descriptionWithLocale(NSDate *self, SEL _cmd, id locale
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(descriptionWithLocale:), swizzle_descriptionWithLocale, &s_descriptionWithLocale);
+    HLSRegisterSwizzleSelector(self, @selector(descriptionWithLocale:), swizzle_descriptionWithLocale, &s_descriptionWithLocale);
 }
 
 #pragma mark Convenience methods
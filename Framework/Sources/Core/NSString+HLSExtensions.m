@@ -6,6 +6,7 @@
 
 #import "NSString+HLSExtensions.h"
 
+#import "HLSDigest.h"
 #import "HLSLogger.h"
 #import "NSData+HLSExtensions.h"
 
@@ -20,13 +21,7 @@ static NSString* digest(NSString *string, unsigned char *(*cc_digest)(const void
     const char *utf8str = string.UTF8String;
 	cc_digest(utf8str, (CC_LONG)strlen(utf8str), md);
     
-    // Hexadecimal representation
-    NSMutableString *hexHash = [NSMutableString string];
-    for (NSUInteger i = 0; i < sizeof(md); ++i) {
-        [hexHash appendFormat:@"%02X", md[i]];
-    }
-    
-    return hexHash.lowercaseString;
+    return HLSHexadecimalStringFromBytes(md, sizeof(md));
 }
 
 @implementation NSString (HLSExtensions)
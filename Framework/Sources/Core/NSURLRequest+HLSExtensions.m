@@ -19,7 +19,7 @@ static id swizzle_initWithURL_cachePolicy_timeoutInterval(NSURLRequest *self, SE
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithURL:cachePolicy:timeoutInterval:), swizzle_initWithURL_cachePolicy_timeoutInterval, &s_initWithURL_cachePolicy_timeoutInterval);
+    HLSRegisterSwizzleSelector(self, @selector(initWithURL:cachePolicy:timeoutInterval:), swizzle_initWithURL_cachePolicy_timeoutInterval, &s_initWithURL_cachePolicy_timeoutInterval);
 }
 
 @end
@@ -14,11 +14,6 @@
  */
 @interface HLSLogger (Friend)
 
-/**
- * Return the paths of all available log files, from the most recent to the oldest one
- */
-@property (nonatomic, readonly) NSArray<NSString *> *availableLogFilePaths;
-
 /**
  * Remove all log files
  */
@@ -14,12 +14,36 @@ NS_ASSUME_NONNULL_BEGIN
  */
 #ifdef HLS_LOGGER
 
-// Note the ## in front of __VA_ARGS__ to support 0 variable arguments
-#define HLSLoggerDebug(format, ...)	[[HLSLogger sharedLogger] debug:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerInfo(format, ...)	[[HLSLogger sharedLogger] info:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerWarn(format, ...)	[[HLSLogger sharedLogger] warn:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerError(format, ...)	[[HLSLogger sharedLogger] error:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
-#define HLSLoggerFatal(format, ...)	[[HLSLogger sharedLogger] fatal:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:format, ## __VA_ARGS__]]]
+// The level is checked first. Neither the arguments nor the message are evaluated or formatted if the level is not
+// active. Note the ## in front of __VA_ARGS__ to support 0 variable arguments
+#define HLSLoggerLogWithLevel(level, format, ...)                                                                      \
+    do {                                                                                                                \
+        HLSLogger *hls_logger = [HLSLogger sharedLogger];                                                               \
+        if ([hls_logger isEnabledForLevel:level]) {                                                                     \
+            [hls_logger logWithLevel:level function:__PRETTY_FUNCTION__ format:format, ## __VA_ARGS__];                 \
+        }                                                                                                               \
+    } while (0)
+
+#define HLSLoggerDebug(format, ...)	HLSLoggerLogWithLevel(HLSLoggerLevelDebug, format, ## __VA_ARGS__)
+#define HLSLoggerInfo(format, ...)	HLSLoggerLogWithLevel(HLSLoggerLevelInfo, format, ## __VA_ARGS__)
+#define HLSLoggerWarn(format, ...)	HLSLoggerLogWithLevel(HLSLoggerLevelWarn, format, ## __VA_ARGS__)
+#define HLSLoggerError(format, ...)	HLSLoggerLogWithLevel(HLSLoggerLevelError, format, ## __VA_ARGS__)
+#define HLSLoggerFatal(format, ...)	HLSLoggerLogWithLevel(HLSLoggerLevelFatal, format, ## __VA_ARGS__)
+
+// Same for entries belonging to a category (see HLSLoggerCategory), whose level is checked instead of the logger level
+#define HLSLoggerCategoryLogWithLevel(category, level, format, ...)                                                    \
+    do {                                                                                                                \
+        HLSLoggerCategory *hls_category = (category);                                                                   \
+        if ([hls_category isEnabledForLevel:level]) {                                                                   \
+            [[HLSLogger sharedLogger] logWithLevel:level category:hls_category function:__PRETTY_FUNCTION__ format:format, ## __VA_ARGS__]; \
+        }                                                                                                               \
+    } while (0)
+
+#define HLSLoggerCategoryDebug(category, format, ...)	HLSLoggerCategoryLogWithLevel(category, HLSLoggerLevelDebug, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryInfo(category, format, ...)	HLSLoggerCategoryLogWithLevel(category, HLSLoggerLevelInfo, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryWarn(category, format, ...)	HLSLoggerCategoryLogWithLevel(category, HLSLoggerLevelWarn, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryError(category, format, ...)	HLSLoggerCategoryLogWithLevel(category, HLSLoggerLevelError, format, ## __VA_ARGS__)
+#define HLSLoggerCategoryFatal(category, format, ...)	HLSLoggerCategoryLogWithLevel(category, HLSLoggerLevelFatal, format, ## __VA_ARGS__)
 
 #else
 
@@ -29,8 +53,28 @@ NS_ASSUME_NONNULL_BEGIN
 #define HLSLoggerError(format, ...)
 #define HLSLoggerFatal(format, ...)
 
+#define HLSLoggerCategoryDebug(category, format, ...)
+#define HLSLoggerCategoryInfo(category, format, ...)
+#define HLSLoggerCategoryWarn(category, format, ...)
+#define HLSLoggerCategoryError(category, format, ...)
+#define HLSLoggerCategoryFatal(category, format, ...)
+
 #endif
 
+/**
+ * Return the category of the shared logger with the specified name, looked up only once per call site, e.g.
+ *   HLSLoggerCategoryInfo(HLSLoggerCategoryNamed(@"networking"), @"Request %@ sent", request);
+ */
+#define HLSLoggerCategoryNamed(name)                                                                                   \
+    ({                                                                                                                  \
+        static HLSLoggerCategory *hls_category = nil;                                                                   \
+        static dispatch_once_t hls_onceToken;                                                                           \
+        dispatch_once(&hls_onceToken, ^{                                                                                \
+            hls_category = [[HLSLogger sharedLogger] categoryWithName:name];                                            \
+        });                                                                                                             \
+        hls_category;                                                                                                   \
+    })
+
 /**
  * Logging levels
  */
@@ -49,6 +93,30 @@ typedef NS_ENUM(NSInteger, HLSLoggerLevel) {
     HLSLoggerLevelEnumSize = HLSLoggerLevelEnumEnd - HLSLoggerLevelEnumBegin
 };
 
+/**
+ * Policies applied when entries are logged asynchronously faster than they can be written
+ */
+typedef NS_ENUM(NSInteger, HLSLoggerOverflowPolicy) {
+    HLSLoggerOverflowPolicyEnumBegin = 0,
+    HLSLoggerOverflowPolicyDropOldest = HLSLoggerOverflowPolicyEnumBegin,  // Default: Discard the oldest buffered entries. Logging never blocks
+    HLSLoggerOverflowPolicyBlock,                                           // Wait until buffered entries have been written. No entry is lost
+    HLSLoggerOverflowPolicyEnumEnd,
+    HLSLoggerOverflowPolicyEnumSize = HLSLoggerOverflowPolicyEnumEnd - HLSLoggerOverflowPolicyEnumBegin
+};
+
+/**
+ * Formats of log files
+ */
+typedef NS_ENUM(NSInteger, HLSLoggerFileFormat) {
+    HLSLoggerFileFormatEnumBegin = 0,
+    HLSLoggerFileFormatText = HLSLoggerFileFormatEnumBegin,                 // Default: Human-readable text files (.txt)
+    HLSLoggerFileFormatBinary,                                              // Compact binary files (.hlslog), see HLSLoggerDecoder.h
+    HLSLoggerFileFormatEnumEnd,
+    HLSLoggerFileFormatEnumSize = HLSLoggerFileFormatEnumEnd - HLSLoggerFileFormatEnumBegin
+};
+
+@class HLSLoggerCategory;
+
 /**
  * Basic logging facility writing to the console or to files, and providing an in-app log viewer. Thread-safe
  *
@@ -72,16 +140,128 @@ typedef NS_ENUM(NSInteger, HLSLoggerLevel) {
 + (HLSLogger *)sharedLogger;
 
 /**
- * The logger level. The default value is HLSLoggerLevelInfo
+ * The logger level. Reading it is lock-free, and changes are saved in the user defaults in the background. The default
+ * value is HLSLoggerLevelInfo
  */
 @property (nonatomic) HLSLoggerLevel level;
 
+/**
+ * Return the category with the specified name, creating it if needed. Categories are never destroyed. Since this
+ * method has to look the category up, keep the returned object or use the HLSLoggerCategoryNamed macro
+ */
+- (HLSLoggerCategory *)categoryWithName:(NSString *)name;
+
+/**
+ * All categories created so far, sorted by name
+ */
+@property (nonatomic, readonly) NSArray<HLSLoggerCategory *> *categories;
+
 /**
  * Enable or disable logging to a file at runtime. The sharedLogger instance logs files in /Library/HLSLogger. The default 
  * value is NO
  */
 @property (nonatomic, getter=isFileLoggingEnabled) BOOL fileLoggingEnabled;
 
+/**
+ * The format of log files. In binary format, entries are neither formatted nor dated when logged. They only record
+ * a timestamp, their level, thread, call site and raw arguments, and must be decoded with the functions declared in
+ * HLSLoggerDecoder.h (or the HLSLoggerDecoder command-line tool). Changing the format starts a new log file. The
+ * default value is HLSLoggerFileFormatText
+ */
+@property (nonatomic) HLSLoggerFileFormat fileFormat;
+
+/**
+ * Enable or disable logging to the console. Disable it when logging to binary files to avoid formatting entries
+ * altogether. The default value is YES
+ */
+@property (nonatomic, getter=isConsoleLoggingEnabled) BOOL consoleLoggingEnabled;
+
+/**
+ * If set to YES, file entries are buffered without locking and written in batches by a background thread, so that
+ * logging threads neither contend with each other nor wait for the disk. At most 8192 entries are buffered, beyond
+ * which the overflow policy applies. The default value is NO
+ */
+@property (nonatomic, getter=isFileLoggingAsynchronous) BOOL fileLoggingAsynchronous;
+
+/**
+ * The policy to apply when the buffer is full. The default value is HLSLoggerOverflowPolicyDropOldest
+ */
+@property (nonatomic) HLSLoggerOverflowPolicy overflowPolicy;
+
+/**
+ * The number of entries discarded because the buffer was full
+ */
+@property (nonatomic, readonly) NSUInteger droppedEntryCount;
+
+/**
+ * The size in bytes beyond which the current log file is closed and a new one started. The limit is checked before
+ * entries are written, so that files can slightly exceed it. Set to 0 for no limit. The default value is 2 MB
+ */
+@property (nonatomic) unsigned long long maximumFileSize;
+
+/**
+ * The age beyond which the current log file is closed and a new one started. Set to 0 for no limit. The default value
+ * is one day
+ */
+@property (nonatomic) NSTimeInterval maximumFileAge;
+
+/**
+ * The total size in bytes of log files beyond which the oldest ones are deleted in the background, the current log
+ * file excepted. Set to 0 for no limit. The default value is 20 MB
+ */
+@property (nonatomic) unsigned long long maximumDiskUsage;
+
+/**
+ * If set to YES, text log files are compressed in the background once closed (gzip, .gz extension appended). Binary
+ * log files are already compact and never compressed. The default value is YES
+ */
+@property (nonatomic, getter=isCompressingClosedFiles) BOOL compressingClosedFiles;
+
+/**
+ * Return the paths of all available log files, from the most recent to the oldest one
+ */
+@property (nonatomic, readonly) NSArray<NSString *> *availableLogFilePaths;
+
+/**
+ * Read a log file line by line, without loading it into memory as a whole. Text, compressed and binary log files are
+ * supported, the lines of binary files being decoded as they are read. Set *pStop to YES to stop reading. Return NO
+ * and an error if the file could not be read
+ */
+- (BOOL)enumerateLinesOfLogFileAtPath:(NSString *)logFilePath
+                                error:(out NSError *__autoreleasing *)pError
+                           usingBlock:(void (^)(NSString *line, BOOL *pStop))block;
+
+/**
+ * Return (at most) the last count lines of a log file, in order. Uncompressed text files are read backwards from
+ * their end, other files are read line by line. Return nil and an error if the file could not be read
+ */
+- (nullable NSArray<NSString *> *)lastLines:(NSUInteger)count
+                            ofLogFileAtPath:(NSString *)logFilePath
+                                      error:(out NSError *__autoreleasing *)pError;
+
+/**
+ * Synchronously write all buffered entries to the log file, e.g. before the application is terminated. Buffered
+ * entries are automatically written when the application enters background
+ */
+- (void)flush;
+
+/**
+ * Return YES iff entries with the specified level are logged
+ */
+- (BOOL)isEnabledForLevel:(HLSLoggerLevel)level;
+
+/**
+ * Log an entry with the specified level, prefixed with the name of the function it originates from. The message is
+ * only formatted if the level is active. Should never be called directly, use the macros instead
+ */
+- (void)logWithLevel:(HLSLoggerLevel)level function:(const char *)function format:(NSString *)format, ... NS_FORMAT_FUNCTION(3, 4);
+
+/**
+ * Same as above for an entry belonging to a category, whose level is checked instead of the logger level. The entry
+ * is prefixed with the category name. Should never be called directly, use the macros instead
+ */
+- (void)logWithLevel:(HLSLoggerLevel)level category:(HLSLoggerCategory *)category function:(const char *)function format:(NSString *)format, ... NS_FORMAT_FUNCTION(4, 5);
+
 /**
  * Logging functions; should never be called directly, use the macros instead
  */
@@ -113,4 +293,47 @@ typedef NS_ENUM(NSInteger, HLSLoggerLevel) {
 
 @end
 
+/**
+ * A named logging category (e.g. networking, bindings or animations), with its own level. This makes it possible to
+ * enable verbose logging for a single subsystem, even in production, without paying for it elsewhere: Checking whether
+ * a category is enabled for some level is a single atomic read and comparison.
+ *
+ * Categories are obtained from -[HLSLogger categoryWithName:], and their levels can be changed at any time from any
+ * thread. Changes are saved in the user defaults in the background and restored when the category is created again
+ */
+@interface HLSLoggerCategory : NSObject
+
+/**
+ * The category name
+ */
+@property (nonatomic, readonly, copy) NSString *name;
+
+/**
+ * The category level. Unless explicitly set, the category uses the level of its logger
+ */
+@property (nonatomic) HLSLoggerLevel level;
+
+/**
+ * Return YES iff the category level has been explicitly set
+ */
+@property (nonatomic, readonly, getter=hasOwnLevel) BOOL ownLevel;
+
+/**
+ * Use the level of the logger again
+ */
+- (void)resetLevel;
+
+/**
+ * Return YES iff entries of the category with the specified level are logged
+ */
+- (BOOL)isEnabledForLevel:(HLSLoggerLevel)level;
+
+@end
+
+@interface HLSLoggerCategory (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
 NS_ASSUME_NONNULL_END
@@ -8,10 +8,17 @@
 
 #import "HLSApplicationInformation.h"
 #import "HLSLogger+Friend.h"
+#import "HLSLoggerBinaryEncoder.h"
+#import "HLSLoggerBinaryFormat.h"
+#import "HLSLoggerDecoder.h"
+#import "HLSLoggerRingBuffer.h"
 #import "HLSLoggerViewController.h"
 #import "NSBundle+HLSExtensions.h"
 #import "NSString+HLSExtensions.h"
 #import <pthread.h>
+#import <stdatomic.h>
+#import <UIKit/UIKit.h>
+#import <zlib.h>
 
 typedef struct {
 	__unsafe_unretained NSString *name;                 // Mode name
@@ -25,13 +32,251 @@ static const HLSLoggerMode kLoggerModeWarn = {@"WARN", 2, @"255,120,0"};
 static const HLSLoggerMode kLoggerModeError = {@"ERROR", 3, @"255,0,0"};
 static const HLSLoggerMode kLoggerModeFatal = {@"FATAL", 4, @"255,0,0"};
 
+static HLSLoggerMode HLSLoggerModeForLevel(HLSLoggerLevel level)
+{
+    switch (level) {
+        case HLSLoggerLevelDebug: {
+            return kLoggerModeDebug;
+            break;
+        }
+            
+        case HLSLoggerLevelInfo: {
+            return kLoggerModeInfo;
+            break;
+        }
+            
+        case HLSLoggerLevelWarn: {
+            return kLoggerModeWarn;
+            break;
+        }
+            
+        case HLSLoggerLevelError: {
+            return kLoggerModeError;
+            break;
+        }
+            
+        default: {
+            return kLoggerModeFatal;
+            break;
+        }
+    }
+}
+
 static NSString * const HLSLoggerLevelKey = @"HLSLoggerLevelKey";
 static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingEnabledKey";
+static NSString * const HLSLoggerCategoryLevelsKey = @"HLSLoggerCategoryLevelsKey";
+
+static NSString * const HLSLoggerTextLogFileExtension = @"txt";
+static NSString * const HLSLoggerCompressedLogFileExtension = @"gz";
+
+static const NSUInteger HLSLoggerBufferCapacity = 8192;
+static const NSUInteger HLSLoggerBatchSize = 256 * 1024;
+static const NSUInteger HLSLoggerChunkSize = 64 * 1024;
+
+static NSError *HLSLoggerReadError(NSInteger code, NSString *filePath)
+{
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:code userInfo:@{ NSFilePathErrorKey : filePath }];
+}
+
+static NSString *HLSLoggerLineWithData(NSData *lineData)
+{
+    // Files might have been truncated in the middle of a character
+    return [[NSString alloc] initWithData:lineData encoding:NSUTF8StringEncoding]
+        ?: [[NSString alloc] initWithData:lineData encoding:NSISOLatin1StringEncoding];
+}
+
+/**
+ * Compress a file with gzip
+ */
+static BOOL HLSLoggerCompressFile(NSString *filePath, NSString *compressedFilePath)
+{
+    FILE *file = fopen(filePath.fileSystemRepresentation, "rb");
+    if (! file) {
+        return NO;
+    }
+    
+    gzFile compressedFile = gzopen(compressedFilePath.fileSystemRepresentation, "wb");
+    if (! compressedFile) {
+        fclose(file);
+        return NO;
+    }
+    
+    BOOL success = YES;
+    char *buffer = malloc(HLSLoggerChunkSize);
+    size_t length = 0;
+    while ((length = fread(buffer, 1, HLSLoggerChunkSize, file)) != 0) {
+        if (gzwrite(compressedFile, buffer, (unsigned)length) != (int)length) {
+            success = NO;
+            break;
+        }
+    }
+    if (ferror(file)) {
+        success = NO;
+    }
+    free(buffer);
+    
+    fclose(file);
+    if (gzclose(compressedFile) != Z_OK) {
+        success = NO;
+    }
+    return success;
+}
 
-@interface HLSLogger ()
+/**
+ * Read a text file line by line. Compressed files are transparently decompressed
+ */
+static BOOL HLSLoggerEnumerateLinesOfTextFile(NSString *filePath, void (^block)(NSString *line, BOOL *pStop))
+{
+    gzFile file = gzopen(filePath.fileSystemRepresentation, "rb");
+    if (! file) {
+        return NO;
+    }
+    gzbuffer(file, HLSLoggerChunkSize);
+    
+    BOOL success = YES;
+    BOOL stop = NO;
+    NSMutableData *lineData = [NSMutableData data];
+    uint8_t *buffer = malloc(HLSLoggerChunkSize);
+    while (! stop) {
+        int length = gzread(file, buffer, HLSLoggerChunkSize);
+        if (length <= 0) {
+            success = (length == 0);
+            break;
+        }
+        
+        // Lines spanning several chunks are accumulated
+        const uint8_t *start = buffer;
+        const uint8_t *end = buffer + length;
+        while (! stop && start < end) {
+            const uint8_t *lineFeed = memchr(start, '\n', end - start);
+            if (! lineFeed) {
+                [lineData appendBytes:start length:end - start];
+                break;
+            }
+            
+            [lineData appendBytes:start length:lineFeed - start];
+            @autoreleasepool {
+                block(HLSLoggerLineWithData(lineData), &stop);
+            }
+            lineData.length = 0;
+            start = lineFeed + 1;
+        }
+    }
+    free(buffer);
+    gzclose(file);
+    
+    // Last line without line feed
+    if (success && ! stop && lineData.length != 0) {
+        block(HLSLoggerLineWithData(lineData), &stop);
+    }
+    return success;
+}
+
+/**
+ * Return the last lines of an uncompressed text file, reading it backwards by chunks until enough lines have been
+ * found
+ */
+static NSArray<NSString *> *HLSLoggerLastLinesOfTextFile(NSString *filePath, NSUInteger count)
+{
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForReadingAtPath:filePath];
+    if (! fileHandle) {
+        return nil;
+    }
+    
+    // One more line feed than lines is needed to find where the first line begins
+    NSMutableArray<NSData *> *chunks = [NSMutableArray array];
+    NSUInteger lineFeedCount = 0;
+    unsigned long long offset = [fileHandle seekToEndOfFile];
+    while (offset != 0 && lineFeedCount <= count) {
+        NSUInteger length = (NSUInteger)MIN(offset, HLSLoggerChunkSize);
+        offset -= length;
+        [fileHandle seekToFileOffset:offset];
+        NSData *chunk = [fileHandle readDataOfLength:length];
+        [chunks insertObject:chunk atIndex:0];
+        
+        const uint8_t *bytes = chunk.bytes;
+        for (NSUInteger i = 0; i < chunk.length; ++i) {
+            if (bytes[i] == '\n') {
+                ++lineFeedCount;
+            }
+        }
+    }
+    [fileHandle closeFile];
+    
+    NSMutableData *tailData = [NSMutableData data];
+    for (NSData *chunk in chunks) {
+        [tailData appendData:chunk];
+    }
+    
+    // Discard the incomplete first line, if any, before decoding
+    if (offset != 0) {
+        const uint8_t *lineFeed = memchr(tailData.bytes, '\n', tailData.length);
+        NSUInteger discardedLength = lineFeed ? (NSUInteger)(lineFeed - (const uint8_t *)tailData.bytes) + 1 : tailData.length;
+        [tailData replaceBytesInRange:NSMakeRange(0, discardedLength) withBytes:NULL length:0];
+    }
+    
+    NSMutableArray<NSString *> *lines = [[HLSLoggerLineWithData(tailData) componentsSeparatedByString:@"\n"] mutableCopy];
+    if (lines.lastObject.length == 0) {
+        [lines removeLastObject];
+    }
+    if (lines.count > count) {
+        return [lines subarrayWithRange:NSMakeRange(lines.count - count, count)];
+    }
+    else {
+        return [lines copy];
+    }
+}
+
+@interface HLSLoggerCategory () {
+@private
+    _Atomic(HLSLoggerLevel) _level;                             // Own level, or level of the logger
+    _Atomic(BOOL) _ownLevel;
+}
+
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, weak) HLSLogger *logger;
+
+- (instancetype)initWithName:(NSString *)name logger:(HLSLogger *)logger level:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel NS_DESIGNATED_INITIALIZER;
+
+- (void)updateLevel:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel;
+- (void)inheritLevel:(HLSLoggerLevel)level;
+
+@end
+
+@interface HLSLogger () {
+@private
+    _Atomic(HLSLoggerLevel) _level;                             // Read for each entry, must be lock-free
+    pthread_mutex_t _fileLock;                                  // Protects the log file, without blocking logging threads
+    _Atomic(BOOL) _fileLoggingEnabled;
+    _Atomic(HLSLoggerFileFormat) _fileFormat;
+    _Atomic(BOOL) _consoleLoggingEnabled;
+    _Atomic(BOOL) _fileLoggingAsynchronous;
+    _Atomic(HLSLoggerOverflowPolicy) _overflowPolicy;
+    _Atomic(NSUInteger) _droppedEntryCount;
+    _Atomic(unsigned long long) _maximumFileSize;
+    _Atomic(NSTimeInterval) _maximumFileAge;
+    _Atomic(unsigned long long) _maximumDiskUsage;
+    _Atomic(BOOL) _compressingClosedFiles;
+    pthread_mutex_t _spaceMutex;                                // Only used by threads waiting for space in the buffer
+    pthread_cond_t _spaceCondition;
+}
 
 @property (nonatomic, copy) NSString *logDirectoryPath;
 @property (nonatomic) NSFileHandle *logFileHandle;
+@property (nonatomic, copy) NSString *logFilePath;                             // Path of the current log file
+@property (nonatomic) HLSLoggerFileFormat logFileFormat;                       // Format of the current log file
+@property (nonatomic) unsigned long long logFileSize;                          // Size of the current log file
+@property (nonatomic) CFAbsoluteTime logFileCreationTime;                      // Time at which the current log file was opened
+@property (nonatomic) HLSLoggerBinaryEncoder *binaryEncoder;
+@property (nonatomic) NSMutableIndexSet *definedCallSiteIdentifiers;          // Call sites written to the current binary file
+@property (nonatomic) HLSLoggerRingBuffer *ringBuffer;
+@property (nonatomic) dispatch_queue_t writeQueue;              // Serial queue on which buffered entries are written
+@property (nonatomic) dispatch_source_t writeSource;            // Coalesces write requests
+@property (nonatomic) dispatch_queue_t maintenanceQueue;        // Serial queue on which closed log files are compressed and deleted
+@property (nonatomic) NSMutableDictionary<NSString *, HLSLoggerCategory *> *categoriesByName;      // Also protects category level changes
+@property (nonatomic) dispatch_queue_t settingsQueue;           // Serial queue on which settings are saved
+
+- (void)setLevel:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel forCategory:(HLSLoggerCategory *)category;
 
 @end
 
@@ -61,54 +306,247 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
         self.logDirectoryPath = logDirectoryPath;
         
         NSNumber *level = [[NSUserDefaults standardUserDefaults] objectForKey:HLSLoggerLevelKey];
-        _level = level ? level.integerValue : HLSLoggerLevelInfo;
+        atomic_init(&_level, level ? level.integerValue : HLSLoggerLevelInfo);
         
         NSNumber *fileLoggingEnabled = [[NSUserDefaults standardUserDefaults] objectForKey:HLSLoggerFileLoggingEnabledKey];
-        _fileLoggingEnabled = fileLoggingEnabled ? fileLoggingEnabled.integerValue : NO;
+        atomic_init(&_fileLoggingEnabled, fileLoggingEnabled ? fileLoggingEnabled.boolValue : NO);
+        
+        pthread_mutex_init(&_fileLock, NULL);
+        atomic_init(&_fileFormat, HLSLoggerFileFormatText);
+        atomic_init(&_consoleLoggingEnabled, YES);
+        atomic_init(&_fileLoggingAsynchronous, NO);
+        atomic_init(&_overflowPolicy, HLSLoggerOverflowPolicyDropOldest);
+        atomic_init(&_droppedEntryCount, 0);
+        atomic_init(&_maximumFileSize, 2 * 1024 * 1024);
+        atomic_init(&_maximumFileAge, 24. * 60. * 60.);
+        atomic_init(&_maximumDiskUsage, 20 * 1024 * 1024);
+        atomic_init(&_compressingClosedFiles, YES);
+        pthread_mutex_init(&_spaceMutex, NULL);
+        pthread_cond_init(&_spaceCondition, NULL);
+        
+        self.categoriesByName = [NSMutableDictionary dictionary];
+        self.settingsQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSLogger.settings", DISPATCH_QUEUE_SERIAL);
+        
+        self.binaryEncoder = [[HLSLoggerBinaryEncoder alloc] init];
+        self.definedCallSiteIdentifiers = [NSMutableIndexSet indexSet];
+        
+        self.ringBuffer = [[HLSLoggerRingBuffer alloc] initWithCapacity:HLSLoggerBufferCapacity];
+        self.writeQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSLogger.write", DISPATCH_QUEUE_SERIAL);
+        
+        // Write requests made while a batch is being written are merged into a single one
+        __weak __typeof(self) weakSelf = self;
+        self.writeSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_DATA_OR, 0, 0, self.writeQueue);
+        dispatch_source_set_event_handler(self.writeSource, ^{
+            [weakSelf writeBufferedRecords];
+        });
+        dispatch_resume(self.writeSource);
+        
+        self.maintenanceQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSLogger.maintenance", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(self.maintenanceQueue, dispatch_get_global_queue(QOS_CLASS_UTILITY, 0));
+        
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(applicationDidEnterBackground:)
+                                                     name:UIApplicationDidEnterBackgroundNotification
+                                                   object:nil];
 	}
 	return self;
 }
 
-#pragma mark Accessors and mutators
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    
+    dispatch_source_cancel(_writeSource);
+    
+    pthread_mutex_destroy(&_fileLock);
+    pthread_mutex_destroy(&_spaceMutex);
+    pthread_cond_destroy(&_spaceCondition);
+}
 
-@synthesize level = _level;
+#pragma mark Accessors and mutators
 
+// Read for each entry. Must not block
 - (HLSLoggerLevel)level
 {
-    @synchronized(self) {
-        return _level;
-    }
+    return atomic_load_explicit(&_level, memory_order_relaxed);
 }
 
 - (void)setLevel:(HLSLoggerLevel)level
 {
-    @synchronized(self) {
-        _level = level;
+    @synchronized(self.categoriesByName) {
+        atomic_store(&_level, level);
         
-        [[NSUserDefaults standardUserDefaults] setInteger:level forKey:HLSLoggerLevelKey];
-        [[NSUserDefaults standardUserDefaults] synchronize];
+        for (HLSLoggerCategory *category in self.categoriesByName.allValues) {
+            [category inheritLevel:level];
+        }
     }
+    
+    [self saveSettingsWithBlock:^(NSUserDefaults *userDefaults) {
+        [userDefaults setInteger:level forKey:HLSLoggerLevelKey];
+    }];
 }
 
-@synthesize fileLoggingEnabled = _fileLoggingEnabled;
-
+// Read for each entry. Must not block
 - (BOOL)isFileLoggingEnabled
 {
-    @synchronized(self) {
-        return _fileLoggingEnabled;
-    }
+    return atomic_load(&_fileLoggingEnabled);
 }
 
 - (void)setFileLoggingEnabled:(BOOL)fileLoggingEnabled
 {
-    @synchronized(self) {
-        _fileLoggingEnabled = fileLoggingEnabled;
-        
-        [[NSUserDefaults standardUserDefaults] setBool:fileLoggingEnabled forKey:HLSLoggerFileLoggingEnabledKey];
-        [[NSUserDefaults standardUserDefaults] synchronize];
+    atomic_store(&_fileLoggingEnabled, fileLoggingEnabled);
+    
+    [self saveSettingsWithBlock:^(NSUserDefaults *userDefaults) {
+        [userDefaults setBool:fileLoggingEnabled forKey:HLSLoggerFileLoggingEnabledKey];
+    }];
+}
+
+- (HLSLoggerFileFormat)fileFormat
+{
+    return atomic_load(&_fileFormat);
+}
+
+- (void)setFileFormat:(HLSLoggerFileFormat)fileFormat
+{
+    // The current file is replaced when the next entry with the new format is written
+    atomic_store(&_fileFormat, fileFormat);
+}
+
+- (BOOL)isConsoleLoggingEnabled
+{
+    return atomic_load(&_consoleLoggingEnabled);
+}
+
+- (void)setConsoleLoggingEnabled:(BOOL)consoleLoggingEnabled
+{
+    atomic_store(&_consoleLoggingEnabled, consoleLoggingEnabled);
+}
+
+- (BOOL)isFileLoggingAsynchronous
+{
+    return atomic_load(&_fileLoggingAsynchronous);
+}
+
+- (void)setFileLoggingAsynchronous:(BOOL)fileLoggingAsynchronous
+{
+    atomic_store(&_fileLoggingAsynchronous, fileLoggingAsynchronous);
+    
+    // Entries logged synchronously from now on must not be written before buffered ones
+    if (! fileLoggingAsynchronous) {
+        [self flush];
+    }
+}
+
+- (HLSLoggerOverflowPolicy)overflowPolicy
+{
+    return atomic_load(&_overflowPolicy);
+}
+
+- (void)setOverflowPolicy:(HLSLoggerOverflowPolicy)overflowPolicy
+{
+    atomic_store(&_overflowPolicy, overflowPolicy);
+}
+
+- (NSUInteger)droppedEntryCount
+{
+    return atomic_load(&_droppedEntryCount);
+}
+
+- (unsigned long long)maximumFileSize
+{
+    return atomic_load(&_maximumFileSize);
+}
+
+- (void)setMaximumFileSize:(unsigned long long)maximumFileSize
+{
+    atomic_store(&_maximumFileSize, maximumFileSize);
+}
+
+- (NSTimeInterval)maximumFileAge
+{
+    return atomic_load(&_maximumFileAge);
+}
+
+- (void)setMaximumFileAge:(NSTimeInterval)maximumFileAge
+{
+    atomic_store(&_maximumFileAge, maximumFileAge);
+}
+
+- (unsigned long long)maximumDiskUsage
+{
+    return atomic_load(&_maximumDiskUsage);
+}
+
+- (void)setMaximumDiskUsage:(unsigned long long)maximumDiskUsage
+{
+    atomic_store(&_maximumDiskUsage, maximumDiskUsage);
+}
+
+- (BOOL)isCompressingClosedFiles
+{
+    return atomic_load(&_compressingClosedFiles);
+}
+
+- (void)setCompressingClosedFiles:(BOOL)compressingClosedFiles
+{
+    atomic_store(&_compressingClosedFiles, compressingClosedFiles);
+}
+
+#pragma mark Settings
+
+/**
+ * Save settings in the background, so that they can be changed at any time without waiting for the user defaults
+ */
+- (void)saveSettingsWithBlock:(void (^)(NSUserDefaults *userDefaults))block
+{
+    dispatch_async(self.settingsQueue, ^{
+        block([NSUserDefaults standardUserDefaults]);
+    });
+}
+
+#pragma mark Categories
+
+- (HLSLoggerCategory *)categoryWithName:(NSString *)name
+{
+    NSParameterAssert(name);
+    
+    @synchronized(self.categoriesByName) {
+        HLSLoggerCategory *category = self.categoriesByName[name];
+        if (! category) {
+            id savedLevel = [[NSUserDefaults standardUserDefaults] dictionaryForKey:HLSLoggerCategoryLevelsKey][name];
+            BOOL ownLevel = [savedLevel isKindOfClass:[NSNumber class]];
+            HLSLoggerLevel level = ownLevel ? [savedLevel integerValue] : self.level;
+            category = [[HLSLoggerCategory alloc] initWithName:name logger:self level:level ownLevel:ownLevel];
+            self.categoriesByName[name] = category;
+        }
+        return category;
+    }
+}
+
+- (NSArray<HLSLoggerCategory *> *)categories
+{
+    @synchronized(self.categoriesByName) {
+        NSSortDescriptor *nameSortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"name" ascending:YES];
+        return [self.categoriesByName.allValues sortedArrayUsingDescriptors:@[nameSortDescriptor]];
     }
 }
 
+- (void)setLevel:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel forCategory:(HLSLoggerCategory *)category
+{
+    NSParameterAssert(category);
+    
+    @synchronized(self.categoriesByName) {
+        [category updateLevel:ownLevel ? level : self.level ownLevel:ownLevel];
+    }
+    
+    NSString *name = category.name;
+    [self saveSettingsWithBlock:^(NSUserDefaults *userDefaults) {
+        NSMutableDictionary<NSString *, NSNumber *> *categoryLevels = [[userDefaults dictionaryForKey:HLSLoggerCategoryLevelsKey] mutableCopy] ?: [NSMutableDictionary dictionary];
+        categoryLevels[name] = ownLevel ? @(level) : nil;
+        [userDefaults setObject:categoryLevels forKey:HLSLoggerCategoryLevelsKey];
+    }];
+}
+
 #pragma mark Logging methods
 
 - (void)logMessage:(NSString *)message forMode:(HLSLoggerMode)mode
@@ -118,7 +556,37 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
 	if (self.level > mode.level) {
 		return;
 	}
+    
+    [self writeMessage:message category:nil forMode:mode];
+}
 
+/**
+ * Write a message to the console and / or to the log file, without checking its level
+ */
+- (void)writeMessage:(NSString *)message category:(NSString *)category forMode:(HLSLoggerMode)mode
+{
+    BOOL consoleLoggingEnabled = self.consoleLoggingEnabled;
+    BOOL fileLoggingEnabled = self.fileLoggingEnabled;
+    BOOL binaryFileLoggingEnabled = fileLoggingEnabled && self.fileFormat == HLSLoggerFileFormatBinary;
+    BOOL textFileLoggingEnabled = fileLoggingEnabled && ! binaryFileLoggingEnabled;
+    
+    if (binaryFileLoggingEnabled) {
+        [self logToFileWithEntryData:[self.binaryEncoder entryDataWithLevel:(uint8_t)mode.level category:category message:message]];
+    }
+    
+    if (consoleLoggingEnabled || textFileLoggingEnabled) {
+        NSString *logEntry = category ? [NSString stringWithFormat:@"[%@] [%@] %@", mode.name, category, message] : [NSString stringWithFormat:@"[%@] %@", mode.name, message];
+        if (consoleLoggingEnabled) {
+            [self logToConsoleWithEntry:logEntry mode:mode];
+        }
+        if (textFileLoggingEnabled) {
+            [self logToFileWithEntry:logEntry];
+        }
+    }
+}
+
+- (void)logToConsoleWithEntry:(NSString *)logEntry mode:(HLSLoggerMode)mode
+{
     static BOOL s_xcodeColorsEnabled = NO;
     static dispatch_once_t s_onceToken;
     dispatch_once(&s_onceToken, ^{
@@ -127,69 +595,346 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
     });
     
     // NSLog is thread-safe and adds date, thread and process information in front of each line
-    NSString *logEntry = [NSString stringWithFormat:@"[%@] %@", mode.name, message];
     if (s_xcodeColorsEnabled && mode.rgbValues) {
         NSLog(@"\033[fg%@;%@\033[;", mode.rgbValues, logEntry);
     }
     else {
         NSLog(@"%@", logEntry);
     }
+}
+
+- (void)logToFileWithEntry:(NSString *)logEntry
+{
+    if (self.fileLoggingAsynchronous) {
+        // Only capture what cannot be obtained later. Formatting and I/O are performed by the writer
+        HLSLoggerRecord record = { CFAbsoluteTimeGetCurrent(), pthread_mach_thread_np(pthread_self()), CFBridgingRetain(logEntry) };
+        [self bufferRecord:record];
+        return;
+    }
     
-    if (self.fileLoggingEnabled) {
-        [self logToFileWithEntry:logEntry];
+    NSString *logFileEntry = [self logFileEntryWithEntry:logEntry
+                                               timestamp:CFAbsoluteTimeGetCurrent()
+                                                threadId:pthread_mach_thread_np(pthread_self())];
+    NSData *logFileEntryData = [logFileEntry dataUsingEncoding:NSUTF8StringEncoding];
+    
+    pthread_mutex_lock(&_fileLock);
+    if ([self openLogFileHandleWithFormat:HLSLoggerFileFormatText]) {
+        [self writeLogFileData:logFileEntryData];
     }
+    pthread_mutex_unlock(&_fileLock);
 }
 
-- (void)logToFileWithEntry:(NSString *)logEntry
+- (void)logToFileWithEntryData:(NSData *)entryData
 {
-    @synchronized(self) {
-        if (! self.logFileHandle) {
-            NSFileManager *fileManager = [NSFileManager defaultManager];
-            
-            // Stores all logs in an HLSLogger directory of Library
-            if (! [fileManager fileExistsAtPath:self.logDirectoryPath]) {
-                NSError *error = nil;
-                if (! [fileManager createDirectoryAtPath:self.logDirectoryPath withIntermediateDirectories:YES attributes:nil error:&error]) {
-                    NSLog(@"Could not create log directory. Reason: %@", error);
-                    return;
-                }
-            }
-            
-            // File name: BundleName_version_date.log
-            static NSDateFormatter *s_dateFormatter = nil;
-            static dispatch_once_t s_onceToken;
-            dispatch_once(&s_onceToken, ^{
-                s_dateFormatter = [[NSDateFormatter alloc] init];
-                s_dateFormatter.dateFormat = @"yyyyMMdd_HHmmss";
-            });
-            
-            NSString *dateString = [s_dateFormatter stringFromDate:[NSDate date]];
-            NSString *bundleName = [[NSBundle mainBundle].infoDictionary[@"CFBundleName"] stringByReplacingOccurrencesOfString:@"." withString:@"-"];
-            NSString *versionString = [[NSBundle mainBundle].friendlyVersionNumber stringByReplacingOccurrencesOfString:@"." withString:@"-"];
-            NSString *logFileName = [NSString stringWithFormat:@"%@_%@_%@.txt", bundleName, versionString, dateString];
-            NSString *logFilePath = [self.logDirectoryPath stringByAppendingPathComponent:logFileName];
-            if (! [fileManager fileExistsAtPath:logFilePath]) {
-                if (! [fileManager createFileAtPath:logFilePath contents:nil attributes:nil]) {
-                    NSLog(@"Could not create log file");
-                    return;
-                }
+    if (self.fileLoggingAsynchronous) {
+        HLSLoggerRecord record = { CFAbsoluteTimeGetCurrent(), pthread_mach_thread_np(pthread_self()), CFBridgingRetain(entryData) };
+        [self bufferRecord:record];
+        return;
+    }
+    
+    NSIndexSet *callSiteIdentifiers = [NSIndexSet indexSetWithIndex:HLSLoggerBinaryEntryCallSiteIdentifier(entryData)];
+    
+    pthread_mutex_lock(&_fileLock);
+    [self writeBinaryData:entryData callSiteIdentifiers:callSiteIdentifiers];
+    pthread_mutex_unlock(&_fileLock);
+}
+
+/**
+ * Write binary entries, preceded by the call sites they reference which have not been written to the current file
+ * yet. The file lock must be held
+ */
+- (void)writeBinaryData:(NSData *)data callSiteIdentifiers:(NSIndexSet *)callSiteIdentifiers
+{
+    if (! [self openLogFileHandleWithFormat:HLSLoggerFileFormatBinary]) {
+        return;
+    }
+    
+    NSMutableIndexSet *undefinedCallSiteIdentifiers = [callSiteIdentifiers mutableCopy];
+    [undefinedCallSiteIdentifiers removeIndexes:self.definedCallSiteIdentifiers];
+    if (undefinedCallSiteIdentifiers.count != 0) {
+        [self writeLogFileData:[self.binaryEncoder callSiteDataWithIdentifiers:undefinedCallSiteIdentifiers]];
+        [self.definedCallSiteIdentifiers addIndexes:undefinedCallSiteIdentifiers];
+    }
+    
+    [self writeLogFileData:data];
+}
+
+/**
+ * Write data to the current log file. The file lock must be held
+ */
+- (void)writeLogFileData:(NSData *)data
+{
+    [self.logFileHandle writeData:data];
+    self.logFileSize += data.length;
+}
+
+/**
+ * Return the handle of the current log file, creating the file if needed. If the current file has another format or
+ * must be rotated, a new one is created. The file lock must be held
+ */
+- (NSFileHandle *)openLogFileHandleWithFormat:(HLSLoggerFileFormat)format
+{
+    if (self.logFileHandle && (self.logFileFormat != format || [self shouldRotateLogFile])) {
+        [self closeLogFile];
+    }
+    
+    if (! self.logFileHandle) {
+        NSFileManager *fileManager = [NSFileManager defaultManager];
+        
+        // Stores all logs in an HLSLogger directory of Library
+        if (! [fileManager fileExistsAtPath:self.logDirectoryPath]) {
+            NSError *error = nil;
+            if (! [fileManager createDirectoryAtPath:self.logDirectoryPath withIntermediateDirectories:YES attributes:nil error:&error]) {
+                NSLog(@"Could not create log directory. Reason: %@", error);
+                return nil;
             }
-            
-            self.logFileHandle = [NSFileHandle fileHandleForWritingAtPath:logFilePath];
         }
-    
-        // Add date, thread and process information, as NSLog does
+        
+        // File name: BundleName_version_date.log. Milliseconds are included so that rotated files have distinct names
         static NSDateFormatter *s_dateFormatter = nil;
         static dispatch_once_t s_onceToken;
         dispatch_once(&s_onceToken, ^{
             s_dateFormatter = [[NSDateFormatter alloc] init];
-            s_dateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+            s_dateFormatter.dateFormat = @"yyyyMMdd_HHmmss_SSS";
         });
         
-        mach_port_t threadId = pthread_mach_thread_np(pthread_self());
-        NSString *logFileEntry = [NSString stringWithFormat:@"%@ [%x] %@\n", [s_dateFormatter stringFromDate:[NSDate date]], threadId, logEntry];
-        [self.logFileHandle writeData:[logFileEntry dataUsingEncoding:NSUTF8StringEncoding]];
+        NSString *dateString = [s_dateFormatter stringFromDate:[NSDate date]];
+        NSString *bundleName = [[NSBundle mainBundle].infoDictionary[@"CFBundleName"] stringByReplacingOccurrencesOfString:@"." withString:@"-"];
+        NSString *versionString = [[NSBundle mainBundle].friendlyVersionNumber stringByReplacingOccurrencesOfString:@"." withString:@"-"];
+        NSString *extension = (format == HLSLoggerFileFormatBinary) ? HLSLoggerBinaryLogFileExtension : HLSLoggerTextLogFileExtension;
+        NSString *logFileName = [NSString stringWithFormat:@"%@_%@_%@.%@", bundleName, versionString, dateString, extension];
+        NSString *logFilePath = [self.logDirectoryPath stringByAppendingPathComponent:logFileName];
+        if (! [fileManager fileExistsAtPath:logFilePath]) {
+            NSData *contents = (format == HLSLoggerFileFormatBinary) ? [HLSLoggerBinaryEncoder fileHeaderData] : nil;
+            if (! [fileManager createFileAtPath:logFilePath contents:contents attributes:nil]) {
+                NSLog(@"Could not create log file");
+                return nil;
+            }
+        }
+        
+        // Append to the file if it already exists
+        self.logFileHandle = [NSFileHandle fileHandleForWritingAtPath:logFilePath];
+        if (! self.logFileHandle) {
+            NSLog(@"Could not open log file");
+            return nil;
+        }
+        
+        self.logFilePath = logFilePath;
+        self.logFileSize = [self.logFileHandle seekToEndOfFile];
+        self.logFileCreationTime = CFAbsoluteTimeGetCurrent();
+        self.logFileFormat = format;
+        [self.definedCallSiteIdentifiers removeAllIndexes];
+        
+        // Also takes care of the files of previous sessions
+        dispatch_async(self.maintenanceQueue, ^{
+            [self performLogFileMaintenance];
+        });
+    }
+    return self.logFileHandle;
+}
+
+/**
+ * Return YES iff the current log file has reached its maximum size or age. The file lock must be held
+ */
+- (BOOL)shouldRotateLogFile
+{
+    unsigned long long maximumFileSize = self.maximumFileSize;
+    if (maximumFileSize != 0 && self.logFileSize >= maximumFileSize) {
+        return YES;
+    }
+    
+    NSTimeInterval maximumFileAge = self.maximumFileAge;
+    return maximumFileAge > 0. && CFAbsoluteTimeGetCurrent() - self.logFileCreationTime >= maximumFileAge;
+}
+
+/**
+ * Close the current log file. The file lock must be held
+ */
+- (void)closeLogFile
+{
+    [self.logFileHandle closeFile];
+    self.logFileHandle = nil;
+    self.logFilePath = nil;
+}
+
+- (NSString *)logFileEntryWithEntry:(NSString *)logEntry timestamp:(CFAbsoluteTime)timestamp threadId:(mach_port_t)threadId
+{
+    // Add date, thread and process information, as NSLog does
+    static NSDateFormatter *s_dateFormatter = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_dateFormatter = [[NSDateFormatter alloc] init];
+        s_dateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+    });
+    
+    NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:timestamp];
+    return [NSString stringWithFormat:@"%@ [%x] %@\n", [s_dateFormatter stringFromDate:date], threadId, logEntry];
+}
+
+#pragma mark Asynchronous logging
+
+- (void)bufferRecord:(HLSLoggerRecord)record
+{
+    while (! [self.ringBuffer enqueueRecord:record]) {
+        if (self.overflowPolicy == HLSLoggerOverflowPolicyDropOldest) {
+            HLSLoggerRecord droppedRecord;
+            if ([self.ringBuffer dequeueRecord:&droppedRecord]) {
+                CFRelease(droppedRecord.message);
+                atomic_fetch_add(&_droppedEntryCount, 1);
+            }
+        }
+        else {
+            // Slow path only. The timeout guards against a missed signal
+            dispatch_source_merge_data(self.writeSource, 1);
+            
+            pthread_mutex_lock(&_spaceMutex);
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += 10 * NSEC_PER_MSEC;
+            if (timeout.tv_nsec >= NSEC_PER_SEC) {
+                timeout.tv_sec += 1;
+                timeout.tv_nsec -= NSEC_PER_SEC;
+            }
+            pthread_cond_timedwait(&_spaceCondition, &_spaceMutex, &timeout);
+            pthread_mutex_unlock(&_spaceMutex);
+        }
+    }
+    
+    dispatch_source_merge_data(self.writeSource, 1);
+}
+
+/**
+ * Write buffered records in large batches (must be called on the write queue). Records are either text entries
+ * (NSString) or binary entries (NSData), a batch only contains records of a single kind
+ */
+- (void)writeBufferedRecords
+{
+    NSMutableData *batchData = [NSMutableData dataWithCapacity:HLSLoggerBatchSize];
+    HLSLoggerFileFormat batchFormat = HLSLoggerFileFormatText;
+    NSMutableIndexSet *batchCallSiteIdentifiers = [NSMutableIndexSet indexSet];
+    
+    HLSLoggerRecord record;
+    while ([self.ringBuffer dequeueRecord:&record]) {
+        @autoreleasepool {
+            id message = CFBridgingRelease(record.message);
+            HLSLoggerFileFormat format = [message isKindOfClass:[NSData class]] ? HLSLoggerFileFormatBinary : HLSLoggerFileFormatText;
+            if (format != batchFormat && batchData.length != 0) {
+                [self writeBatchData:batchData format:batchFormat callSiteIdentifiers:batchCallSiteIdentifiers];
+                batchData.length = 0;
+                [batchCallSiteIdentifiers removeAllIndexes];
+            }
+            batchFormat = format;
+            
+            if (format == HLSLoggerFileFormatBinary) {
+                [batchData appendData:message];
+                [batchCallSiteIdentifiers addIndex:HLSLoggerBinaryEntryCallSiteIdentifier(message)];
+            }
+            else {
+                NSString *logFileEntry = [self logFileEntryWithEntry:message timestamp:record.timestamp threadId:record.threadId];
+                [batchData appendData:[logFileEntry dataUsingEncoding:NSUTF8StringEncoding]];
+            }
+        }
+        
+        if (batchData.length >= HLSLoggerBatchSize) {
+            [self writeBatchData:batchData format:batchFormat callSiteIdentifiers:batchCallSiteIdentifiers];
+            batchData.length = 0;
+            [batchCallSiteIdentifiers removeAllIndexes];
+        }
+    }
+    
+    if (batchData.length != 0) {
+        [self writeBatchData:batchData format:batchFormat callSiteIdentifiers:batchCallSiteIdentifiers];
     }
+    
+    pthread_mutex_lock(&_spaceMutex);
+    pthread_cond_broadcast(&_spaceCondition);
+    pthread_mutex_unlock(&_spaceMutex);
+}
+
+- (void)writeBatchData:(NSData *)batchData format:(HLSLoggerFileFormat)format callSiteIdentifiers:(NSIndexSet *)callSiteIdentifiers
+{
+    pthread_mutex_lock(&_fileLock);
+    if (format == HLSLoggerFileFormatBinary) {
+        [self writeBinaryData:batchData callSiteIdentifiers:callSiteIdentifiers];
+    }
+    else if ([self openLogFileHandleWithFormat:HLSLoggerFileFormatText]) {
+        [self writeLogFileData:batchData];
+    }
+    pthread_mutex_unlock(&_fileLock);
+}
+
+- (void)flush
+{
+    dispatch_sync(self.writeQueue, ^{
+        [self writeBufferedRecords];
+    });
+}
+
+- (BOOL)isEnabledForLevel:(HLSLoggerLevel)level
+{
+    return atomic_load_explicit(&_level, memory_order_relaxed) <= level;
+}
+
+- (void)logWithLevel:(HLSLoggerLevel)level function:(const char *)function format:(NSString *)format, ...
+{
+    // Called directly, not through the macros
+    if (! [self isEnabledForLevel:level]) {
+        return;
+    }
+    
+    va_list arguments;
+    va_start(arguments, format);
+    [self logWithLevel:level category:nil function:function format:format arguments:arguments];
+    va_end(arguments);
+}
+
+- (void)logWithLevel:(HLSLoggerLevel)level category:(HLSLoggerCategory *)category function:(const char *)function format:(NSString *)format, ...
+{
+    NSParameterAssert(category);
+    
+    // Called directly, not through the macros
+    if (! [category isEnabledForLevel:level]) {
+        return;
+    }
+    
+    va_list arguments;
+    va_start(arguments, format);
+    [self logWithLevel:level category:category.name function:function format:format arguments:arguments];
+    va_end(arguments);
+}
+
+- (void)logWithLevel:(HLSLoggerLevel)level category:(NSString *)category function:(const char *)function format:(NSString *)format arguments:(va_list)arguments
+{
+    NSParameterAssert(function);
+    NSParameterAssert(format);
+    
+    if (! self.consoleLoggingEnabled && ! self.fileLoggingEnabled) {
+        return;
+    }
+    
+    HLSLoggerMode mode = HLSLoggerModeForLevel(level);
+    NSString *prefix = category ? [NSString stringWithFormat:@"[%@] [%@] ", mode.name, category] : [NSString stringWithFormat:@"[%@] ", mode.name];
+    
+    // In binary format, raw arguments are written to the file. The message is only formatted for the console
+    if (self.fileLoggingEnabled && self.fileFormat == HLSLoggerFileFormatBinary) {
+        va_list encodedArguments;
+        va_copy(encodedArguments, arguments);
+        NSData *entryData = [self.binaryEncoder entryDataWithLevel:(uint8_t)level category:category function:function format:format arguments:encodedArguments];
+        va_end(encodedArguments);
+        
+        if (entryData) {
+            [self logToFileWithEntryData:entryData];
+            
+            if (self.consoleLoggingEnabled) {
+                NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+                [self logToConsoleWithEntry:[NSString stringWithFormat:@"%@(%s) - %@", prefix, function, message] mode:mode];
+            }
+            return;
+        }
+    }
+    
+    NSString *message = [[NSString alloc] initWithFormat:format arguments:arguments];
+    [self writeMessage:[NSString stringWithFormat:@"(%s) - %@", function, message] category:category forMode:mode];
 }
 
 - (void)debug:(NSString *)message
@@ -251,9 +996,13 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
     @synchronized(self) {
         NSArray<NSString *> *logFileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:self.logDirectoryPath error:NULL];
         
-        // Log files names are sorted in increasing date order
+        // Log files names are sorted in increasing date order. Hidden files are being compressed
         NSMutableArray<NSString *> *logFilePaths = [NSMutableArray array];
-        for (NSString *logFileName in [logFileNames reverseObjectEnumerator]) {
+        for (NSString *logFileName in [[logFileNames sortedArrayUsingSelector:@selector(compare:)] reverseObjectEnumerator]) {
+            if ([logFileName hasPrefix:@"."]) {
+                continue;
+            }
+            
             NSString *logFilePath = [self.logDirectoryPath stringByAppendingPathComponent:logFileName];
             [logFilePaths addObject:logFilePath];
         }
@@ -262,19 +1011,179 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
     }
 }
 
-- (void)clearLogs
+- (BOOL)isCurrentLogFilePath:(NSString *)logFilePath
 {
-    @synchronized(self) {
-        self.logFileHandle = nil;
-        
-        NSArray<NSString *> *availableLogPaths = self.availableLogFilePaths;
-        for (NSString *availableLogPath in availableLogPaths) {
+    pthread_mutex_lock(&_fileLock);
+    BOOL current = [logFilePath isEqualToString:self.logFilePath];
+    pthread_mutex_unlock(&_fileLock);
+    return current;
+}
+
+/**
+ * Compress closed text log files, and delete the oldest log files beyond the disk quota. Must be called on the
+ * maintenance queue
+ */
+- (void)performLogFileMaintenance
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    
+    if (self.compressingClosedFiles) {
+        for (NSString *logFilePath in self.availableLogFilePaths) {
+            if (! [logFilePath.pathExtension isEqualToString:HLSLoggerTextLogFileExtension] || [self isCurrentLogFilePath:logFilePath]) {
+                continue;
+            }
+            
+            // Compress to a hidden file first, so that incomplete files are never listed
+            NSString *compressedLogFileName = [logFilePath.lastPathComponent stringByAppendingPathExtension:HLSLoggerCompressedLogFileExtension];
+            NSString *compressedLogFilePath = [self.logDirectoryPath stringByAppendingPathComponent:compressedLogFileName];
+            NSString *partialLogFilePath = [self.logDirectoryPath stringByAppendingPathComponent:[@"." stringByAppendingString:compressedLogFileName]];
+            if (! HLSLoggerCompressFile(logFilePath, partialLogFilePath)) {
+                NSLog(@"Could not compress log file %@", logFilePath);
+                [fileManager removeItemAtPath:partialLogFilePath error:NULL];
+                continue;
+            }
+            
+            [fileManager removeItemAtPath:compressedLogFilePath error:NULL];
             NSError *error = nil;
-            if (! [[NSFileManager defaultManager] removeItemAtPath:availableLogPath error:&error]) {
-                NSLog(@"Could not cleanup log file %@. Reason: %@", availableLogPath, error);
+            if (! [fileManager moveItemAtPath:partialLogFilePath toPath:compressedLogFilePath error:&error]) {
+                NSLog(@"Could not compress log file %@. Reason: %@", logFilePath, error);
+                [fileManager removeItemAtPath:partialLogFilePath error:NULL];
+                continue;
             }
+            [fileManager removeItemAtPath:logFilePath error:NULL];
+        }
+    }
+    
+    unsigned long long maximumDiskUsage = self.maximumDiskUsage;
+    if (maximumDiskUsage == 0) {
+        return;
+    }
+    
+    NSArray<NSString *> *logFilePaths = self.availableLogFilePaths;
+    NSMutableDictionary<NSString *, NSNumber *> *logFileSizes = [NSMutableDictionary dictionary];
+    unsigned long long diskUsage = 0;
+    for (NSString *logFilePath in logFilePaths) {
+        unsigned long long logFileSize = [fileManager attributesOfItemAtPath:logFilePath error:NULL].fileSize;
+        logFileSizes[logFilePath] = @(logFileSize);
+        diskUsage += logFileSize;
+    }
+    
+    // Delete the oldest files first
+    for (NSString *logFilePath in [logFilePaths reverseObjectEnumerator]) {
+        if (diskUsage <= maximumDiskUsage) {
+            break;
+        }
+        
+        if ([self isCurrentLogFilePath:logFilePath]) {
+            continue;
+        }
+        
+        NSError *error = nil;
+        if (! [fileManager removeItemAtPath:logFilePath error:&error]) {
+            NSLog(@"Could not delete log file %@. Reason: %@", logFilePath, error);
+            continue;
+        }
+        diskUsage -= logFileSizes[logFilePath].unsignedLongLongValue;
+    }
+}
+
+- (BOOL)enumerateLinesOfLogFileAtPath:(NSString *)logFilePath
+                                error:(out NSError *__autoreleasing *)pError
+                           usingBlock:(void (^)(NSString *line, BOOL *pStop))block
+{
+    NSParameterAssert(logFilePath);
+    NSParameterAssert(block);
+    
+    // Entries of the current file might still be buffered
+    [self flush];
+    
+    if ([logFilePath.pathExtension isEqualToString:HLSLoggerBinaryLogFileExtension]) {
+        return HLSLoggerDecodeBinaryLogFile(logFilePath, block, pError);
+    }
+    
+    if (! [[NSFileManager defaultManager] fileExistsAtPath:logFilePath]) {
+        if (pError) {
+            *pError = HLSLoggerReadError(NSFileReadNoSuchFileError, logFilePath);
+        }
+        return NO;
+    }
+    
+    if (! HLSLoggerEnumerateLinesOfTextFile(logFilePath, block)) {
+        if (pError) {
+            *pError = HLSLoggerReadError(NSFileReadUnknownError, logFilePath);
+        }
+        return NO;
+    }
+    
+    return YES;
+}
+
+- (NSArray<NSString *> *)lastLines:(NSUInteger)count
+                   ofLogFileAtPath:(NSString *)logFilePath
+                             error:(out NSError *__autoreleasing *)pError
+{
+    NSParameterAssert(logFilePath);
+    
+    if ([logFilePath.pathExtension isEqualToString:HLSLoggerTextLogFileExtension]) {
+        [self flush];
+        
+        NSArray<NSString *> *lines = HLSLoggerLastLinesOfTextFile(logFilePath, count);
+        if (! lines && pError) {
+            *pError = HLSLoggerReadError(NSFileReadNoSuchFileError, logFilePath);
+        }
+        return lines;
+    }
+    
+    // Other files cannot be read backwards. Keep the last lines read in a circular buffer
+    NSMutableArray<NSString *> *lines = [NSMutableArray arrayWithCapacity:count];
+    __block NSUInteger index = 0;
+    BOOL success = [self enumerateLinesOfLogFileAtPath:logFilePath error:pError usingBlock:^(NSString *line, BOOL *pStop) {
+        if (count == 0) {
+            *pStop = YES;
+        }
+        else if (lines.count < count) {
+            [lines addObject:line];
+        }
+        else {
+            lines[index] = line;
+            index = (index + 1) % count;
+        }
+    }];
+    if (! success) {
+        return nil;
+    }
+    
+    NSArray<NSString *> *oldestLines = [lines subarrayWithRange:NSMakeRange(index, lines.count - index)];
+    return [oldestLines arrayByAddingObjectsFromArray:[lines subarrayWithRange:NSMakeRange(0, index)]];
+}
+
+- (void)clearLogs
+{
+    [self flush];
+    
+    // Wait until pending maintenance is over, which requires the file lock
+    dispatch_sync(self.maintenanceQueue, ^{});
+    
+    pthread_mutex_lock(&_fileLock);
+    
+    [self closeLogFile];
+    
+    NSArray<NSString *> *availableLogPaths = self.availableLogFilePaths;
+    for (NSString *availableLogPath in availableLogPaths) {
+        NSError *error = nil;
+        if (! [[NSFileManager defaultManager] removeItemAtPath:availableLogPath error:&error]) {
+            NSLog(@"Could not cleanup log file %@. Reason: %@", availableLogPath, error);
         }
     }
+    
+    pthread_mutex_unlock(&_fileLock);
+}
+
+#pragma mark Notification callbacks
+
+- (void)applicationDidEnterBackground:(NSNotification *)notification
+{
+    [self flush];
 }
 
 #pragma mark Log window
@@ -291,3 +1200,94 @@ static NSString * const HLSLoggerFileLoggingEnabledKey = @"HLSLoggerFileLoggingE
 }
 
 @end
+
+@implementation HLSLoggerCategory
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithName:(NSString *)name logger:(HLSLogger *)logger level:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel
+{
+    NSParameterAssert(name);
+    NSParameterAssert(logger);
+    
+    if (self = [super init]) {
+        self.name = name;
+        self.logger = logger;
+        atomic_init(&_level, level);
+        atomic_init(&_ownLevel, ownLevel);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Accessors and mutators
+
+- (HLSLoggerLevel)level
+{
+    return atomic_load_explicit(&_level, memory_order_relaxed);
+}
+
+- (void)setLevel:(HLSLoggerLevel)level
+{
+    [self.logger setLevel:level ownLevel:YES forCategory:self];
+}
+
+- (BOOL)hasOwnLevel
+{
+    return atomic_load(&_ownLevel);
+}
+
+#pragma mark Levels
+
+- (void)resetLevel
+{
+    [self.logger setLevel:HLSLoggerLevelNone ownLevel:NO forCategory:self];
+}
+
+// Read for each entry. A single load and comparison
+- (BOOL)isEnabledForLevel:(HLSLoggerLevel)level
+{
+    return atomic_load_explicit(&_level, memory_order_relaxed) <= level;
+}
+
+/**
+ * The category lock of the logger must be held
+ */
+- (void)updateLevel:(HLSLoggerLevel)level ownLevel:(BOOL)ownLevel
+{
+    atomic_store(&_level, level);
+    atomic_store(&_ownLevel, ownLevel);
+}
+
+/**
+ * The category lock of the logger must be held
+ */
+- (void)inheritLevel:(HLSLoggerLevel)level
+{
+    if (! atomic_load(&_ownLevel)) {
+        atomic_store(&_level, level);
+    }
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; name: %@; level: %@; ownLevel: %@>",
+            [self class],
+            self,
+            self.name,
+            @(self.level),
+            HLSStringFromBool(self.hasOwnLevel)];
+}
+
+@end
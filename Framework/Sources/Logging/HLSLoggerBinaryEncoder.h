@@ -0,0 +1,49 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private class encoding log entries in the HLSLogger binary format (see HLSLoggerBinaryFormat.h). Call sites (a
+ * category, a function and a format) are interned once, so that entries only carry an identifier and their raw arguments,
+ * without any message or date being formatted. Thread-safe
+ *
+ * Call sites are identified by the addresses of their category name, function name and format string, which is cheap
+ * for the constant strings used by the logging macros and for the names of HLSLoggerCategory objects. Only literal
+ * formats are interned, so that the number of call sites remains bounded
+ */
+@interface HLSLoggerBinaryEncoder : NSObject
+
+/**
+ * Return a file header, whose time references are the current ones
+ */
++ (NSData *)fileHeaderData;
+
+/**
+ * Encode an entry with the specified level, category (nil if none) and format arguments. Return nil if the format
+ * cannot be encoded or is not a literal, in which case the entry must be formatted and encoded as a message instead
+ */
+- (nullable NSData *)entryDataWithLevel:(uint8_t)level
+                               category:(nullable NSString *)category
+                               function:(const char *)function
+                                 format:(NSString *)format
+                              arguments:(va_list)arguments;
+
+/**
+ * Encode an entry with the specified level, category (nil if none) and already formatted message
+ */
+- (NSData *)entryDataWithLevel:(uint8_t)level category:(nullable NSString *)category message:(NSString *)message;
+
+/**
+ * Return the call site records with the specified identifiers
+ */
+- (NSData *)callSiteDataWithIdentifiers:(NSIndexSet *)identifiers;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,453 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerBinaryEncoder.h"
+
+#import "HLSLoggerBinaryFormat.h"
+
+#import <mach/mach_time.h>
+#import <objc/runtime.h>
+#import <pthread.h>
+
+static const char HLSLoggerMessageFunction[] = "";
+static NSString * const HLSLoggerNoCategory = @"";
+
+/**
+ * Unlike mach_absolute_time, mach_continuous_time keeps running while the device sleeps, so that dates computed from
+ * the file header reference do not drift. On iOS 9, where it is not available, dates are shifted by the time spent
+ * asleep since the log file was created
+ */
+static uint64_t HLSLoggerMonotonicTimestamp(void)
+{
+    static mach_timebase_info_data_t s_timebaseInfo;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        mach_timebase_info(&s_timebaseInfo);
+    });
+
+    uint64_t time = 0;
+    if (@available(iOS 10, *)) {
+        time = mach_continuous_time();
+    }
+    else {
+        time = mach_absolute_time();
+    }
+    return time * s_timebaseInfo.numer / s_timebaseInfo.denom;
+}
+
+/**
+ * Return YES iff the string is a literal, whose address identifies it for the lifetime of the process
+ */
+static BOOL HLSLoggerIsLiteralString(NSString *string)
+{
+    static Class s_literalStringClass = Nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        s_literalStringClass = object_getClass(@"");
+    });
+    return object_getClass(string) == s_literalStringClass;
+}
+
+static void HLSLoggerAppendIntegerArgument(NSMutableData *data, int64_t value)
+{
+    HLSLoggerBinaryAppendUInt8(data, HLSLoggerBinaryArgumentTypeInteger);
+    HLSLoggerBinaryAppendUInt64(data, (uint64_t)value);
+}
+
+static void HLSLoggerAppendDoubleArgument(NSMutableData *data, double value)
+{
+    HLSLoggerBinaryAppendUInt8(data, HLSLoggerBinaryArgumentTypeDouble);
+    HLSLoggerBinaryAppendFloat64(data, value);
+}
+
+static void HLSLoggerAppendStringArgument(NSMutableData *data, const char *bytes, size_t length)
+{
+    HLSLoggerBinaryAppendUInt8(data, HLSLoggerBinaryArgumentTypeString);
+    HLSLoggerBinaryAppendUInt32(data, (uint32_t)length);
+    [data appendBytes:bytes length:length];
+}
+
+static void HLSLoggerAppendUTF8String(NSMutableData *data, NSString *string)
+{
+    const char *bytes = string.UTF8String ?: "";
+    size_t length = strlen(bytes);
+    HLSLoggerBinaryAppendUInt32(data, (uint32_t)length);
+    [data appendBytes:bytes length:length];
+}
+
+/**
+ * A category, function and format triple, interned once
+ */
+@interface HLSLoggerCallSite : NSObject
+
+@property (nonatomic) uint32_t identifier;
+@property (nonatomic) NSString *category;                       // Strong reference, so that its address is never reused
+@property (nonatomic, copy) NSString *function;
+@property (nonatomic) NSString *format;                         // Strong reference, so that its address is never reused
+@property (nonatomic, nullable) NSData *conversionsData;        // nil if the format cannot be encoded
+
+@end
+
+@implementation HLSLoggerCallSite
+
+@end
+
+@interface HLSLoggerBinaryEncoder () {
+@private
+    pthread_rwlock_t _lock;
+    CFMutableDictionaryRef _functionTables;                     // Category address -> (function address -> (format address -> call site))
+}
+
+@property (nonatomic) NSMutableArray<HLSLoggerCallSite *> *callSites;       // Ordered by identifier, starting at 1
+
+@end
+
+@implementation HLSLoggerBinaryEncoder
+
+#pragma mark Class methods
+
++ (NSData *)fileHeaderData
+{
+    NSMutableData *headerData = [NSMutableData dataWithCapacity:HLSLoggerBinaryHeaderLength];
+    [headerData appendBytes:HLSLoggerBinaryMagic length:sizeof(HLSLoggerBinaryMagic)];
+    HLSLoggerBinaryAppendUInt16(headerData, HLSLoggerBinaryVersion);
+    HLSLoggerBinaryAppendUInt64(headerData, HLSLoggerMonotonicTimestamp());
+    HLSLoggerBinaryAppendFloat64(headerData, CFAbsoluteTimeGetCurrent());
+    return [headerData copy];
+}
+
+#pragma mark Object creation and destruction
+
+- (instancetype)init
+{
+    if (self = [super init]) {
+        pthread_rwlock_init(&_lock, NULL);
+        _functionTables = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+        self.callSites = [NSMutableArray array];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    CFRelease(_functionTables);
+    pthread_rwlock_destroy(&_lock);
+}
+
+#pragma mark Call sites
+
+/**
+ * The lock must be held
+ */
+- (HLSLoggerCallSite *)registeredCallSiteWithCategory:(NSString *)category function:(const char *)function format:(NSString *)format
+{
+    CFDictionaryRef functionTable = CFDictionaryGetValue(_functionTables, (__bridge const void *)category);
+    CFDictionaryRef formatTable = functionTable ? CFDictionaryGetValue(functionTable, function) : NULL;
+    if (! formatTable) {
+        return nil;
+    }
+    return (__bridge HLSLoggerCallSite *)CFDictionaryGetValue(formatTable, (__bridge const void *)format);
+}
+
+- (HLSLoggerCallSite *)callSiteWithCategory:(NSString *)category function:(const char *)function format:(NSString *)format
+{
+    category = category ?: HLSLoggerNoCategory;
+
+    // Call sites are never removed, they can safely be used once the lock has been released
+    pthread_rwlock_rdlock(&_lock);
+    HLSLoggerCallSite *callSite = [self registeredCallSiteWithCategory:category function:function format:format];
+    pthread_rwlock_unlock(&_lock);
+    if (callSite) {
+        return callSite;
+    }
+
+    pthread_rwlock_wrlock(&_lock);
+    callSite = [self registeredCallSiteWithCategory:category function:function format:format];
+    if (! callSite) {
+        callSite = [[HLSLoggerCallSite alloc] init];
+        callSite.identifier = (uint32_t)self.callSites.count + 1;
+        callSite.category = category;
+        callSite.function = @(function) ?: @"";
+        callSite.format = format;
+        callSite.conversionsData = HLSLoggerConversionsForFormat(format);
+
+        CFMutableDictionaryRef functionTable = (CFMutableDictionaryRef)CFDictionaryGetValue(_functionTables, (__bridge const void *)category);
+        if (! functionTable) {
+            functionTable = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+            CFDictionarySetValue(_functionTables, (__bridge const void *)category, functionTable);
+            CFRelease(functionTable);
+        }
+
+        CFMutableDictionaryRef formatTable = (CFMutableDictionaryRef)CFDictionaryGetValue(functionTable, function);
+        if (! formatTable) {
+            formatTable = CFDictionaryCreateMutable(kCFAllocatorDefault, 0, NULL, &kCFTypeDictionaryValueCallBacks);
+            CFDictionarySetValue(functionTable, function, formatTable);
+            CFRelease(formatTable);
+        }
+        CFDictionarySetValue(formatTable, (__bridge const void *)format, (__bridge const void *)callSite);
+        [self.callSites addObject:callSite];
+    }
+    pthread_rwlock_unlock(&_lock);
+    return callSite;
+}
+
+- (NSData *)callSiteDataWithIdentifiers:(NSIndexSet *)identifiers
+{
+    NSParameterAssert(identifiers);
+
+    NSMutableData *callSiteData = [NSMutableData data];
+
+    pthread_rwlock_rdlock(&_lock);
+    [identifiers enumerateIndexesUsingBlock:^(NSUInteger identifier, BOOL *pStop) {
+        if (identifier == 0 || identifier > self.callSites.count) {
+            return;
+        }
+
+        HLSLoggerCallSite *callSite = self.callSites[identifier - 1];
+        HLSLoggerBinaryAppendUInt8(callSiteData, HLSLoggerBinaryRecordTypeCallSite);
+        HLSLoggerBinaryAppendUInt32(callSiteData, callSite.identifier);
+        HLSLoggerAppendUTF8String(callSiteData, callSite.category);
+        HLSLoggerAppendUTF8String(callSiteData, callSite.function);
+        HLSLoggerAppendUTF8String(callSiteData, callSite.format);
+    }];
+    pthread_rwlock_unlock(&_lock);
+
+    return [callSiteData copy];
+}
+
+#pragma mark Encoding
+
+- (NSMutableData *)entryDataWithLevel:(uint8_t)level callSite:(HLSLoggerCallSite *)callSite
+{
+    NSMutableData *entryData = [NSMutableData dataWithCapacity:128];
+    HLSLoggerBinaryAppendUInt8(entryData, HLSLoggerBinaryRecordTypeEntry);
+    HLSLoggerBinaryAppendUInt8(entryData, level);
+    HLSLoggerBinaryAppendUInt32(entryData, callSite.identifier);
+    HLSLoggerBinaryAppendUInt32(entryData, pthread_mach_thread_np(pthread_self()));
+    HLSLoggerBinaryAppendUInt64(entryData, HLSLoggerMonotonicTimestamp());
+    HLSLoggerBinaryAppendUInt32(entryData, 0);                  // Argument length, set once arguments have been appended
+    return entryData;
+}
+
+- (NSData *)finishedEntryData:(NSMutableData *)entryData
+{
+    uint32_t argumentLength = OSSwapHostToLittleInt32((uint32_t)(entryData.length - HLSLoggerBinaryEntryHeaderLength));
+    [entryData replaceBytesInRange:NSMakeRange(HLSLoggerBinaryEntryHeaderLength - sizeof(argumentLength), sizeof(argumentLength))
+                         withBytes:&argumentLength];
+    return entryData;
+}
+
+- (NSData *)entryDataWithLevel:(uint8_t)level
+                      category:(NSString *)category
+                      function:(const char *)function
+                        format:(NSString *)format
+                     arguments:(va_list)arguments
+{
+    NSParameterAssert(function);
+    NSParameterAssert(format);
+
+    // Formats built at runtime would each yield a new call site, kept forever. Have them encoded as messages instead
+    if (! HLSLoggerIsLiteralString(format)) {
+        return nil;
+    }
+
+    HLSLoggerCallSite *callSite = [self callSiteWithCategory:category function:function format:format];
+    if (! callSite.conversionsData) {
+        return nil;
+    }
+
+    NSMutableData *entryData = [self entryDataWithLevel:level callSite:callSite];
+
+    // Fetch each argument with the type expected by its conversion, as printf does
+    const HLSLoggerConversion *conversions = callSite.conversionsData.bytes;
+    NSUInteger conversionCount = callSite.conversionsData.length / sizeof(HLSLoggerConversion);
+    for (NSUInteger i = 0; i < conversionCount; ++i) {
+        HLSLoggerConversion conversion = conversions[i];
+        if (conversion.kind == HLSLoggerConversionKindPercent) {
+            continue;
+        }
+
+        if (conversion.width == HLSLoggerConversionValueFromArgument) {
+            HLSLoggerAppendIntegerArgument(entryData, va_arg(arguments, int));
+        }
+
+        int precision = conversion.precision;
+        if (precision == HLSLoggerConversionValueFromArgument) {
+            precision = va_arg(arguments, int);
+            HLSLoggerAppendIntegerArgument(entryData, precision);
+        }
+
+        switch (conversion.kind) {
+            case HLSLoggerConversionKindSignedInteger: {
+                int64_t value = 0;
+                switch (conversion.lengthModifier) {
+                    case HLSLoggerLengthModifierChar: {
+                        value = (signed char)va_arg(arguments, int);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierShort: {
+                        value = (short)va_arg(arguments, int);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierLong: {
+                        value = va_arg(arguments, long);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierLongLong: {
+                        value = va_arg(arguments, long long);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierSize: {
+                        value = va_arg(arguments, ssize_t);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierPointerDifference: {
+                        value = va_arg(arguments, ptrdiff_t);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierMaximum: {
+                        value = va_arg(arguments, intmax_t);
+                        break;
+                    }
+
+                    default: {
+                        value = va_arg(arguments, int);
+                        break;
+                    }
+                }
+                HLSLoggerAppendIntegerArgument(entryData, value);
+                break;
+            }
+
+            case HLSLoggerConversionKindUnsignedInteger: {
+                uint64_t value = 0;
+                switch (conversion.lengthModifier) {
+                    case HLSLoggerLengthModifierChar: {
+                        value = (unsigned char)va_arg(arguments, unsigned int);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierShort: {
+                        value = (unsigned short)va_arg(arguments, unsigned int);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierLong: {
+                        value = va_arg(arguments, unsigned long);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierLongLong: {
+                        value = va_arg(arguments, unsigned long long);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierSize: {
+                        value = va_arg(arguments, size_t);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierPointerDifference: {
+                        value = (uint64_t)va_arg(arguments, ptrdiff_t);
+                        break;
+                    }
+
+                    case HLSLoggerLengthModifierMaximum: {
+                        value = va_arg(arguments, uintmax_t);
+                        break;
+                    }
+
+                    default: {
+                        value = va_arg(arguments, unsigned int);
+                        break;
+                    }
+                }
+                HLSLoggerAppendIntegerArgument(entryData, (int64_t)value);
+                break;
+            }
+
+            case HLSLoggerConversionKindDouble: {
+                double value = (conversion.lengthModifier == HLSLoggerLengthModifierLongDouble) ? (double)va_arg(arguments, long double) : va_arg(arguments, double);
+                HLSLoggerAppendDoubleArgument(entryData, value);
+                break;
+            }
+
+            case HLSLoggerConversionKindObject: {
+                id object = va_arg(arguments, id);
+                const char *description = object ? ([object description].UTF8String ?: "") : "(null)";
+                HLSLoggerAppendStringArgument(entryData, description, strlen(description));
+                break;
+            }
+
+            case HLSLoggerConversionKindCString: {
+                const char *string = va_arg(arguments, const char *) ?: "(null)";
+                size_t length = (precision >= 0) ? strnlen(string, precision) : strlen(string);
+                HLSLoggerAppendStringArgument(entryData, string, length);
+                break;
+            }
+
+            case HLSLoggerConversionKindUnicharString: {
+                const unichar *characters = va_arg(arguments, const unichar *);
+                NSString *string = @"(null)";
+                if (characters) {
+                    NSUInteger length = 0;
+                    while (characters[length] != 0 && (precision < 0 || length < (NSUInteger)precision)) {
+                        ++length;
+                    }
+                    string = [NSString stringWithCharacters:characters length:length];
+                }
+                const char *bytes = string.UTF8String ?: "";
+                HLSLoggerAppendStringArgument(entryData, bytes, strlen(bytes));
+                break;
+            }
+
+            case HLSLoggerConversionKindPointer: {
+                HLSLoggerAppendIntegerArgument(entryData, (int64_t)(uintptr_t)va_arg(arguments, void *));
+                break;
+            }
+
+            default: {
+                break;
+            }
+        }
+    }
+
+    return [self finishedEntryData:entryData];
+}
+
+- (NSData *)entryDataWithLevel:(uint8_t)level category:(NSString *)category message:(NSString *)message
+{
+    NSParameterAssert(message);
+
+    HLSLoggerCallSite *callSite = [self callSiteWithCategory:category function:HLSLoggerMessageFunction format:@"%@"];
+    NSMutableData *entryData = [self entryDataWithLevel:level callSite:callSite];
+
+    const char *bytes = message.UTF8String ?: "";
+    HLSLoggerAppendStringArgument(entryData, bytes, strlen(bytes));
+    return [self finishedEntryData:entryData];
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger callSiteCount = self.callSites.count;
+    pthread_rwlock_unlock(&_lock);
+
+    return [NSString stringWithFormat:@"<%@: %p; callSiteCount: %@>",
+            [self class],
+            self,
+            @(callSiteCount)];
+}
+
+@end
@@ -0,0 +1,206 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+#import <libkern/OSByteOrder.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Private definitions of the HLSLogger binary log file format, shared by the logger and the decoder. Only depends on
+ * Foundation so that the decoder can be built as a command-line tool.
+ *
+ * All integers are little-endian. A file starts with a header:
+ *   - magic (6 bytes, "HLSLOG") and format version (uint16)
+ *   - monotonic reference timestamp in nanoseconds (uint64) and corresponding absolute time (CFAbsoluteTime, float64)
+ *
+ * followed by records, each starting with its type (uint8):
+ *   - call site: identifier (uint32), category, function and format, each as a length (uint32) followed by UTF-8 bytes.
+ *     The category is empty for uncategorized entries, and missing in version 1 files. A call site is always written
+ *     before the first entry referencing it in a file
+ *   - entry: level (uint8), call site identifier (uint32), thread id (uint32), monotonic timestamp in nanoseconds
+ *     (uint64), argument length (uint32) and bytes. Each argument of the call site format starts with its type (uint8)
+ *     followed by its value: an int64 or a float64, or a UTF-8 string preceded by its length (uint32)
+ */
+
+static const char HLSLoggerBinaryMagic[6] = { 'H', 'L', 'S', 'L', 'O', 'G' };
+static const uint16_t HLSLoggerBinaryVersion = 2;
+static const NSUInteger HLSLoggerBinaryHeaderLength = 24;
+static const NSUInteger HLSLoggerBinaryEntryHeaderLength = 22;            // Record type and fixed-size entry fields
+
+typedef NS_ENUM(uint8_t, HLSLoggerBinaryRecordType) {
+    HLSLoggerBinaryRecordTypeCallSite = 1,
+    HLSLoggerBinaryRecordTypeEntry = 2
+};
+
+typedef NS_ENUM(uint8_t, HLSLoggerBinaryArgumentType) {
+    HLSLoggerBinaryArgumentTypeInteger = 1,
+    HLSLoggerBinaryArgumentTypeDouble = 2,
+    HLSLoggerBinaryArgumentTypeString = 3
+};
+
+/**
+ * Arguments expected by a format conversion
+ */
+typedef NS_ENUM(uint8_t, HLSLoggerConversionKind) {
+    HLSLoggerConversionKindPercent = 0,                                    // %%, no argument
+    HLSLoggerConversionKindSignedInteger,
+    HLSLoggerConversionKindUnsignedInteger,
+    HLSLoggerConversionKindDouble,
+    HLSLoggerConversionKindObject,
+    HLSLoggerConversionKindCString,
+    HLSLoggerConversionKindUnicharString,
+    HLSLoggerConversionKindPointer
+};
+
+typedef NS_ENUM(uint8_t, HLSLoggerLengthModifier) {
+    HLSLoggerLengthModifierNone = 0,
+    HLSLoggerLengthModifierChar,                                           // hh
+    HLSLoggerLengthModifierShort,                                          // h
+    HLSLoggerLengthModifierLong,                                           // l
+    HLSLoggerLengthModifierLongLong,                                       // ll or q
+    HLSLoggerLengthModifierSize,                                           // z
+    HLSLoggerLengthModifierPointerDifference,                              // t
+    HLSLoggerLengthModifierMaximum,                                        // j
+    HLSLoggerLengthModifierLongDouble                                      // L
+};
+
+typedef NS_OPTIONS(uint8_t, HLSLoggerConversionFlags) {
+    HLSLoggerConversionFlagLeftJustify = (1 << 0),                         // -
+    HLSLoggerConversionFlagSign = (1 << 1),                                // +
+    HLSLoggerConversionFlagSpace = (1 << 2),                               // (space)
+    HLSLoggerConversionFlagAlternate = (1 << 3),                           // #
+    HLSLoggerConversionFlagZeroPadding = (1 << 4),                         // 0
+    HLSLoggerConversionFlagGrouping = (1 << 5)                             // '
+};
+
+static const int HLSLoggerConversionValueNone = -1;
+static const int HLSLoggerConversionValueFromArgument = -2;                // * width or precision
+
+/**
+ * A conversion specification parsed from a format string
+ */
+typedef struct {
+    NSUInteger location;                                                   // Range of the specification in the format
+    NSUInteger length;
+    HLSLoggerConversionKind kind;
+    HLSLoggerLengthModifier lengthModifier;
+    HLSLoggerConversionFlags flags;
+    int width;                                                             // Or one of the special values above
+    int precision;                                                         // Ditto
+    unichar conversion;                                                    // Conversion character, e.g. 'd' or '@'
+} HLSLoggerConversion;
+
+/**
+ * Parse the conversions contained in a format string, returning them as a packed array of HLSLoggerConversion.
+ * Return nil if the format cannot be logged in binary form (positional arguments, %n, wide strings or unknown
+ * conversions)
+ */
+OBJC_EXPORT NSData * _Nullable HLSLoggerConversionsForFormat(NSString *format);
+
+/**
+ * Name of a level as displayed in log files
+ */
+OBJC_EXPORT NSString *HLSLoggerBinaryLevelName(uint8_t level);
+
+#pragma mark Writing and reading values
+
+static inline void HLSLoggerBinaryAppendUInt8(NSMutableData *data, uint8_t value)
+{
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static inline void HLSLoggerBinaryAppendUInt16(NSMutableData *data, uint16_t value)
+{
+    value = OSSwapHostToLittleInt16(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static inline void HLSLoggerBinaryAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    value = OSSwapHostToLittleInt32(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static inline void HLSLoggerBinaryAppendUInt64(NSMutableData *data, uint64_t value)
+{
+    value = OSSwapHostToLittleInt64(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static inline void HLSLoggerBinaryAppendFloat64(NSMutableData *data, double value)
+{
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    HLSLoggerBinaryAppendUInt64(data, bits);
+}
+
+/**
+ * Reading functions advance the cursor and return NO if not enough bytes are available before the end
+ */
+static inline BOOL HLSLoggerBinaryReadBytes(const uint8_t **pCursor, const uint8_t *end, void *bytes, size_t length)
+{
+    if ((size_t)(end - *pCursor) < length) {
+        return NO;
+    }
+    memcpy(bytes, *pCursor, length);
+    *pCursor += length;
+    return YES;
+}
+
+static inline BOOL HLSLoggerBinaryReadUInt8(const uint8_t **pCursor, const uint8_t *end, uint8_t *pValue)
+{
+    return HLSLoggerBinaryReadBytes(pCursor, end, pValue, sizeof(*pValue));
+}
+
+static inline BOOL HLSLoggerBinaryReadUInt16(const uint8_t **pCursor, const uint8_t *end, uint16_t *pValue)
+{
+    if (! HLSLoggerBinaryReadBytes(pCursor, end, pValue, sizeof(*pValue))) {
+        return NO;
+    }
+    *pValue = OSSwapLittleToHostInt16(*pValue);
+    return YES;
+}
+
+static inline BOOL HLSLoggerBinaryReadUInt32(const uint8_t **pCursor, const uint8_t *end, uint32_t *pValue)
+{
+    if (! HLSLoggerBinaryReadBytes(pCursor, end, pValue, sizeof(*pValue))) {
+        return NO;
+    }
+    *pValue = OSSwapLittleToHostInt32(*pValue);
+    return YES;
+}
+
+static inline BOOL HLSLoggerBinaryReadUInt64(const uint8_t **pCursor, const uint8_t *end, uint64_t *pValue)
+{
+    if (! HLSLoggerBinaryReadBytes(pCursor, end, pValue, sizeof(*pValue))) {
+        return NO;
+    }
+    *pValue = OSSwapLittleToHostInt64(*pValue);
+    return YES;
+}
+
+static inline BOOL HLSLoggerBinaryReadFloat64(const uint8_t **pCursor, const uint8_t *end, double *pValue)
+{
+    uint64_t bits = 0;
+    if (! HLSLoggerBinaryReadUInt64(pCursor, end, &bits)) {
+        return NO;
+    }
+    memcpy(pValue, &bits, sizeof(bits));
+    return YES;
+}
+
+/**
+ * Return the call site identifier of an encoded entry
+ */
+static inline uint32_t HLSLoggerBinaryEntryCallSiteIdentifier(NSData *entryData)
+{
+    uint32_t callSiteIdentifier = 0;
+    [entryData getBytes:&callSiteIdentifier range:NSMakeRange(2, sizeof(callSiteIdentifier))];
+    return OSSwapLittleToHostInt32(callSiteIdentifier);
+}
+
+NS_ASSUME_NONNULL_END
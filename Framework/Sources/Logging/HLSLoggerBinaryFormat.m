@@ -0,0 +1,284 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerBinaryFormat.h"
+
+static BOOL HLSLoggerIsDigit(unichar character)
+{
+    return character >= '0' && character <= '9';
+}
+
+#pragma mark Functions
+
+NSData *HLSLoggerConversionsForFormat(NSString *format)
+{
+    NSCParameterAssert(format);
+
+    NSUInteger length = format.length;
+    unichar *characters = malloc(MAX(length, 1) * sizeof(unichar));
+    [format getCharacters:characters range:NSMakeRange(0, length)];
+
+    NSMutableData *conversionsData = [NSMutableData data];
+    BOOL supported = YES;
+
+    NSUInteger i = 0;
+    while (i < length) {
+        if (characters[i] != '%') {
+            ++i;
+            continue;
+        }
+
+        HLSLoggerConversion conversion;
+        memset(&conversion, 0, sizeof(conversion));
+        conversion.location = i;
+        conversion.width = HLSLoggerConversionValueNone;
+        conversion.precision = HLSLoggerConversionValueNone;
+        ++i;
+
+        // Flags
+        BOOL parsingFlags = YES;
+        while (parsingFlags && i < length) {
+            switch (characters[i]) {
+                case '-': {
+                    conversion.flags |= HLSLoggerConversionFlagLeftJustify;
+                    ++i;
+                    break;
+                }
+
+                case '+': {
+                    conversion.flags |= HLSLoggerConversionFlagSign;
+                    ++i;
+                    break;
+                }
+
+                case ' ': {
+                    conversion.flags |= HLSLoggerConversionFlagSpace;
+                    ++i;
+                    break;
+                }
+
+                case '#': {
+                    conversion.flags |= HLSLoggerConversionFlagAlternate;
+                    ++i;
+                    break;
+                }
+
+                case '0': {
+                    conversion.flags |= HLSLoggerConversionFlagZeroPadding;
+                    ++i;
+                    break;
+                }
+
+                case '\'': {
+                    conversion.flags |= HLSLoggerConversionFlagGrouping;
+                    ++i;
+                    break;
+                }
+
+                default: {
+                    parsingFlags = NO;
+                    break;
+                }
+            }
+        }
+
+        // Width
+        if (i < length && characters[i] == '*') {
+            conversion.width = HLSLoggerConversionValueFromArgument;
+            ++i;
+        }
+        else if (i < length && HLSLoggerIsDigit(characters[i])) {
+            conversion.width = 0;
+            while (i < length && HLSLoggerIsDigit(characters[i])) {
+                conversion.width = MIN(10 * conversion.width + (characters[i] - '0'), INT16_MAX);
+                ++i;
+            }
+        }
+
+        // Precision
+        if (i < length && characters[i] == '.') {
+            ++i;
+            if (i < length && characters[i] == '*') {
+                conversion.precision = HLSLoggerConversionValueFromArgument;
+                ++i;
+            }
+            else {
+                conversion.precision = 0;
+                while (i < length && HLSLoggerIsDigit(characters[i])) {
+                    conversion.precision = MIN(10 * conversion.precision + (characters[i] - '0'), INT16_MAX);
+                    ++i;
+                }
+            }
+        }
+
+        // Length modifier
+        if (i < length) {
+            switch (characters[i]) {
+                case 'h': {
+                    if (i + 1 < length && characters[i + 1] == 'h') {
+                        conversion.lengthModifier = HLSLoggerLengthModifierChar;
+                        ++i;
+                    }
+                    else {
+                        conversion.lengthModifier = HLSLoggerLengthModifierShort;
+                    }
+                    ++i;
+                    break;
+                }
+
+                case 'l': {
+                    if (i + 1 < length && characters[i + 1] == 'l') {
+                        conversion.lengthModifier = HLSLoggerLengthModifierLongLong;
+                        ++i;
+                    }
+                    else {
+                        conversion.lengthModifier = HLSLoggerLengthModifierLong;
+                    }
+                    ++i;
+                    break;
+                }
+
+                case 'q': {
+                    conversion.lengthModifier = HLSLoggerLengthModifierLongLong;
+                    ++i;
+                    break;
+                }
+
+                case 'z': {
+                    conversion.lengthModifier = HLSLoggerLengthModifierSize;
+                    ++i;
+                    break;
+                }
+
+                case 't': {
+                    conversion.lengthModifier = HLSLoggerLengthModifierPointerDifference;
+                    ++i;
+                    break;
+                }
+
+                case 'j': {
+                    conversion.lengthModifier = HLSLoggerLengthModifierMaximum;
+                    ++i;
+                    break;
+                }
+
+                case 'L': {
+                    conversion.lengthModifier = HLSLoggerLengthModifierLongDouble;
+                    ++i;
+                    break;
+                }
+
+                default: {
+                    break;
+                }
+            }
+        }
+
+        // Conversion. Positional arguments (e.g. %1$@) end up here as well
+        if (i == length) {
+            supported = NO;
+            break;
+        }
+
+        conversion.conversion = characters[i];
+        switch (conversion.conversion) {
+            case '%': {
+                conversion.kind = HLSLoggerConversionKindPercent;
+                break;
+            }
+
+            case 'd':
+            case 'i':
+            case 'c':
+            case 'C': {
+                conversion.kind = HLSLoggerConversionKindSignedInteger;
+                break;
+            }
+
+            case 'D': {
+                conversion.kind = HLSLoggerConversionKindSignedInteger;
+                conversion.lengthModifier = HLSLoggerLengthModifierLong;
+                break;
+            }
+
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X': {
+                conversion.kind = HLSLoggerConversionKindUnsignedInteger;
+                break;
+            }
+
+            case 'O':
+            case 'U': {
+                conversion.kind = HLSLoggerConversionKindUnsignedInteger;
+                conversion.lengthModifier = HLSLoggerLengthModifierLong;
+                break;
+            }
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A': {
+                conversion.kind = HLSLoggerConversionKindDouble;
+                break;
+            }
+
+            case '@': {
+                conversion.kind = HLSLoggerConversionKindObject;
+                break;
+            }
+
+            case 's': {
+                conversion.kind = HLSLoggerConversionKindCString;
+                supported = (conversion.lengthModifier == HLSLoggerLengthModifierNone);
+                break;
+            }
+
+            case 'S': {
+                conversion.kind = HLSLoggerConversionKindUnicharString;
+                break;
+            }
+
+            case 'p': {
+                conversion.kind = HLSLoggerConversionKindPointer;
+                break;
+            }
+
+            default: {
+                supported = NO;
+                break;
+            }
+        }
+
+        if (! supported) {
+            break;
+        }
+
+        ++i;
+        conversion.length = i - conversion.location;
+        [conversionsData appendBytes:&conversion length:sizeof(conversion)];
+    }
+
+    free(characters);
+    return supported ? [conversionsData copy] : nil;
+}
+
+NSString *HLSLoggerBinaryLevelName(uint8_t level)
+{
+    static NSArray<NSString *> *s_levelNames = nil;
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        // Same order as HLSLoggerLevel values
+        s_levelNames = @[@"DEBUG", @"INFO", @"WARN", @"ERROR", @"FATAL"];
+    });
+
+    return (level < s_levelNames.count) ? s_levelNames[level] : @"FATAL";
+}
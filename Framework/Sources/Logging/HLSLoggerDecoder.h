@@ -0,0 +1,34 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Extension of the log files written by HLSLogger in binary format
+ */
+OBJC_EXPORT NSString * const HLSLoggerBinaryLogFileExtension;
+
+/**
+ * Decode a log file written by HLSLogger in binary format, calling the block for each entry in order. Entries are
+ * formatted as in text log files, without trailing line feed. Set *pStop to YES to stop decoding
+ *
+ * Return NO and an error if the file could not be read or is not a valid binary log file. Entries truncated at the end
+ * of the file (e.g. because the application crashed while they were written) are silently ignored
+ */
+OBJC_EXPORT BOOL HLSLoggerDecodeBinaryLogFile(NSString *filePath,
+                                              void (^block)(NSString *line, BOOL *pStop),
+                                              NSError *__autoreleasing *pError);
+
+/**
+ * Decode a log file written by HLSLogger in binary format into a text file, which is replaced if it already exists
+ */
+OBJC_EXPORT BOOL HLSLoggerConvertBinaryLogFile(NSString *filePath,
+                                               NSString *textFilePath,
+                                               NSError *__autoreleasing *pError);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,415 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerDecoder.h"
+
+#import "HLSLoggerBinaryFormat.h"
+
+NSString * const HLSLoggerBinaryLogFileExtension = @"hlslog";
+
+static const NSUInteger HLSLoggerDecoderBatchSize = 256 * 1024;
+
+/**
+ * A call site read from a log file
+ */
+@interface HLSLoggerDecodedCallSite : NSObject
+
+@property (nonatomic, copy) NSString *category;
+@property (nonatomic, copy) NSString *function;
+@property (nonatomic, copy) NSString *format;
+@property (nonatomic) NSData *conversionsData;
+
+@end
+
+@implementation HLSLoggerDecodedCallSite
+
+@end
+
+static NSError *HLSLoggerFileError(NSInteger code, NSString *filePath)
+{
+    // Cocoa errors come with localized descriptions, no resource bundle is required
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:code userInfo:@{ NSFilePathErrorKey : filePath }];
+}
+
+static BOOL HLSLoggerReadIntegerArgument(const uint8_t **pCursor, const uint8_t *end, int64_t *pValue)
+{
+    uint8_t type = 0;
+    uint64_t value = 0;
+    if (! HLSLoggerBinaryReadUInt8(pCursor, end, &type) || type != HLSLoggerBinaryArgumentTypeInteger
+            || ! HLSLoggerBinaryReadUInt64(pCursor, end, &value)) {
+        return NO;
+    }
+    *pValue = (int64_t)value;
+    return YES;
+}
+
+static BOOL HLSLoggerReadDoubleArgument(const uint8_t **pCursor, const uint8_t *end, double *pValue)
+{
+    uint8_t type = 0;
+    return HLSLoggerBinaryReadUInt8(pCursor, end, &type) && type == HLSLoggerBinaryArgumentTypeDouble
+        && HLSLoggerBinaryReadFloat64(pCursor, end, pValue);
+}
+
+static NSString *HLSLoggerReadUTF8String(const uint8_t **pCursor, const uint8_t *end)
+{
+    uint32_t length = 0;
+    if (! HLSLoggerBinaryReadUInt32(pCursor, end, &length) || (size_t)(end - *pCursor) < length) {
+        return nil;
+    }
+
+    NSString *string = [[NSString alloc] initWithBytes:*pCursor length:length encoding:NSUTF8StringEncoding];
+    *pCursor += length;
+    return string;
+}
+
+static NSString *HLSLoggerReadStringArgument(const uint8_t **pCursor, const uint8_t *end)
+{
+    uint8_t type = 0;
+    if (! HLSLoggerBinaryReadUInt8(pCursor, end, &type) || type != HLSLoggerBinaryArgumentTypeString) {
+        return nil;
+    }
+    return HLSLoggerReadUTF8String(pCursor, end);
+}
+
+/**
+ * Return the printf specification corresponding to a conversion, with the specified values and length modifier
+ */
+static NSString *HLSLoggerSpecification(HLSLoggerConversion conversion, int width, int precision, NSString *lengthModifier, unichar conversionCharacter)
+{
+    NSMutableString *specification = [NSMutableString stringWithString:@"%"];
+    if (conversion.flags & HLSLoggerConversionFlagLeftJustify) {
+        [specification appendString:@"-"];
+    }
+    if (conversion.flags & HLSLoggerConversionFlagSign) {
+        [specification appendString:@"+"];
+    }
+    if (conversion.flags & HLSLoggerConversionFlagSpace) {
+        [specification appendString:@" "];
+    }
+    if (conversion.flags & HLSLoggerConversionFlagAlternate) {
+        [specification appendString:@"#"];
+    }
+    if (conversion.flags & HLSLoggerConversionFlagZeroPadding) {
+        [specification appendString:@"0"];
+    }
+    if (conversion.flags & HLSLoggerConversionFlagGrouping) {
+        [specification appendString:@"'"];
+    }
+    if (width >= 0) {
+        [specification appendFormat:@"%d", width];
+    }
+    if (precision >= 0) {
+        [specification appendFormat:@".%d", precision];
+    }
+    [specification appendFormat:@"%@%C", lengthModifier, conversionCharacter];
+    return [specification copy];
+}
+
+static NSString *HLSLoggerPaddedString(NSString *string, HLSLoggerConversion conversion, int width)
+{
+    if (width < 0 || string.length >= (NSUInteger)width) {
+        return string;
+    }
+
+    NSString *padding = [@"" stringByPaddingToLength:width - string.length withString:@" " startingAtIndex:0];
+    return (conversion.flags & HLSLoggerConversionFlagLeftJustify) ? [string stringByAppendingString:padding] : [padding stringByAppendingString:string];
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+
+/**
+ * Format the arguments of an entry according to its call site format. Return nil if the arguments do not match
+ */
+static NSString *HLSLoggerDecodedMessage(HLSLoggerDecodedCallSite *callSite, const uint8_t *cursor, const uint8_t *end)
+{
+    NSString *format = callSite.format;
+    NSMutableString *message = [NSMutableString stringWithCapacity:format.length];
+
+    const HLSLoggerConversion *conversions = callSite.conversionsData.bytes;
+    NSUInteger conversionCount = callSite.conversionsData.length / sizeof(HLSLoggerConversion);
+    NSUInteger location = 0;
+    for (NSUInteger i = 0; i < conversionCount; ++i) {
+        HLSLoggerConversion conversion = conversions[i];
+        [message appendString:[format substringWithRange:NSMakeRange(location, conversion.location - location)]];
+        location = conversion.location + conversion.length;
+
+        if (conversion.kind == HLSLoggerConversionKindPercent) {
+            [message appendString:@"%"];
+            continue;
+        }
+
+        // Negative widths obtained from arguments mean left justification, negative precisions are ignored
+        int width = conversion.width;
+        if (width == HLSLoggerConversionValueFromArgument) {
+            int64_t value = 0;
+            if (! HLSLoggerReadIntegerArgument(&cursor, end, &value)) {
+                return nil;
+            }
+            if (value < 0) {
+                conversion.flags |= HLSLoggerConversionFlagLeftJustify;
+                value = (value < -INT16_MAX) ? INT16_MAX : -value;
+            }
+            width = (int)MIN(value, INT16_MAX);
+        }
+
+        int precision = conversion.precision;
+        if (precision == HLSLoggerConversionValueFromArgument) {
+            int64_t value = 0;
+            if (! HLSLoggerReadIntegerArgument(&cursor, end, &value)) {
+                return nil;
+            }
+            precision = (value < 0) ? HLSLoggerConversionValueNone : (int)MIN(value, INT16_MAX);
+        }
+
+        switch (conversion.kind) {
+            case HLSLoggerConversionKindSignedInteger: {
+                int64_t value = 0;
+                if (! HLSLoggerReadIntegerArgument(&cursor, end, &value)) {
+                    return nil;
+                }
+
+                if (conversion.conversion == 'c' || conversion.conversion == 'C') {
+                    NSString *specification = HLSLoggerSpecification(conversion, width, precision, @"", conversion.conversion);
+                    [message appendFormat:specification, (int)value];
+                }
+                else {
+                    unichar conversionCharacter = (conversion.conversion == 'D') ? 'd' : conversion.conversion;
+                    NSString *specification = HLSLoggerSpecification(conversion, width, precision, @"ll", conversionCharacter);
+                    [message appendFormat:specification, (long long)value];
+                }
+                break;
+            }
+
+            case HLSLoggerConversionKindUnsignedInteger: {
+                int64_t value = 0;
+                if (! HLSLoggerReadIntegerArgument(&cursor, end, &value)) {
+                    return nil;
+                }
+
+                unichar conversionCharacter = (conversion.conversion == 'O' || conversion.conversion == 'U') ? tolower(conversion.conversion) : conversion.conversion;
+                NSString *specification = HLSLoggerSpecification(conversion, width, precision, @"ll", conversionCharacter);
+                [message appendFormat:specification, (unsigned long long)value];
+                break;
+            }
+
+            case HLSLoggerConversionKindDouble: {
+                double value = 0.;
+                if (! HLSLoggerReadDoubleArgument(&cursor, end, &value)) {
+                    return nil;
+                }
+
+                NSString *specification = HLSLoggerSpecification(conversion, width, precision, @"", conversion.conversion);
+                [message appendFormat:specification, value];
+                break;
+            }
+
+            case HLSLoggerConversionKindPointer: {
+                int64_t value = 0;
+                if (! HLSLoggerReadIntegerArgument(&cursor, end, &value)) {
+                    return nil;
+                }
+
+                NSString *specification = HLSLoggerSpecification(conversion, width, HLSLoggerConversionValueNone, @"", 'p');
+                [message appendFormat:specification, (void *)(uintptr_t)value];
+                break;
+            }
+
+            case HLSLoggerConversionKindObject: {
+                NSString *value = HLSLoggerReadStringArgument(&cursor, end);
+                if (! value) {
+                    return nil;
+                }
+
+                // Widths are ignored for objects, as with NSString formatting
+                [message appendString:value];
+                break;
+            }
+
+            case HLSLoggerConversionKindCString:
+            case HLSLoggerConversionKindUnicharString: {
+                // Precisions have already been applied when logging
+                NSString *value = HLSLoggerReadStringArgument(&cursor, end);
+                if (! value) {
+                    return nil;
+                }
+
+                [message appendString:HLSLoggerPaddedString(value, conversion, width)];
+                break;
+            }
+
+            default: {
+                return nil;
+                break;
+            }
+        }
+    }
+
+    if (cursor != end) {
+        return nil;
+    }
+
+    [message appendString:[format substringFromIndex:location]];
+    return [message copy];
+}
+
+#pragma clang diagnostic pop
+
+#pragma mark Functions
+
+BOOL HLSLoggerDecodeBinaryLogFile(NSString *filePath, void (^block)(NSString *line, BOOL *pStop), NSError *__autoreleasing *pError)
+{
+    NSCParameterAssert(filePath);
+    NSCParameterAssert(block);
+
+    NSData *data = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedIfSafe error:pError];
+    if (! data) {
+        return NO;
+    }
+
+    const uint8_t *cursor = data.bytes;
+    const uint8_t *end = cursor + data.length;
+
+    char magic[sizeof(HLSLoggerBinaryMagic)];
+    uint16_t version = 0;
+    uint64_t referenceTimestamp = 0;
+    double referenceTime = 0.;
+    if (! HLSLoggerBinaryReadBytes(&cursor, end, magic, sizeof(magic)) || memcmp(magic, HLSLoggerBinaryMagic, sizeof(magic)) != 0
+            || ! HLSLoggerBinaryReadUInt16(&cursor, end, &version) || version == 0 || version > HLSLoggerBinaryVersion
+            || ! HLSLoggerBinaryReadUInt64(&cursor, end, &referenceTimestamp)
+            || ! HLSLoggerBinaryReadFloat64(&cursor, end, &referenceTime)) {
+        if (pError) {
+            *pError = HLSLoggerFileError(NSFileReadCorruptFileError, filePath);
+        }
+        return NO;
+    }
+
+    // Same as text log files
+    NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
+    dateFormatter.dateFormat = @"yyyy-MM-dd HH:mm:ss.SSS";
+
+    NSMutableDictionary<NSNumber *, HLSLoggerDecodedCallSite *> *callSites = [NSMutableDictionary dictionary];
+    BOOL corrupt = NO;
+    BOOL stop = NO;
+    while (! stop && cursor < end) {
+        @autoreleasepool {
+            uint8_t recordType = 0;
+            HLSLoggerBinaryReadUInt8(&cursor, end, &recordType);
+
+            // Incomplete records at the end of the file are ignored
+            if (recordType == HLSLoggerBinaryRecordTypeCallSite) {
+                uint32_t identifier = 0;
+                if (! HLSLoggerBinaryReadUInt32(&cursor, end, &identifier)) {
+                    break;
+                }
+
+                // Version 1 files have no categories
+                NSString *category = (version >= 2) ? HLSLoggerReadUTF8String(&cursor, end) : @"";
+                NSString *function = category ? HLSLoggerReadUTF8String(&cursor, end) : nil;
+                NSString *format = function ? HLSLoggerReadUTF8String(&cursor, end) : nil;
+                if (! format) {
+                    break;
+                }
+
+                HLSLoggerDecodedCallSite *callSite = [[HLSLoggerDecodedCallSite alloc] init];
+                callSite.category = category;
+                callSite.function = function;
+                callSite.format = format;
+                callSite.conversionsData = HLSLoggerConversionsForFormat(format);
+                if (! callSite.conversionsData) {
+                    corrupt = YES;
+                    break;
+                }
+                callSites[@(identifier)] = callSite;
+            }
+            else if (recordType == HLSLoggerBinaryRecordTypeEntry) {
+                uint8_t level = 0;
+                uint32_t identifier = 0;
+                uint32_t threadId = 0;
+                uint64_t timestamp = 0;
+                uint32_t argumentLength = 0;
+                if (! HLSLoggerBinaryReadUInt8(&cursor, end, &level)
+                        || ! HLSLoggerBinaryReadUInt32(&cursor, end, &identifier)
+                        || ! HLSLoggerBinaryReadUInt32(&cursor, end, &threadId)
+                        || ! HLSLoggerBinaryReadUInt64(&cursor, end, &timestamp)
+                        || ! HLSLoggerBinaryReadUInt32(&cursor, end, &argumentLength)
+                        || (size_t)(end - cursor) < argumentLength) {
+                    break;
+                }
+
+                HLSLoggerDecodedCallSite *callSite = callSites[@(identifier)];
+                NSString *message = callSite ? HLSLoggerDecodedMessage(callSite, cursor, cursor + argumentLength) : nil;
+                if (! message) {
+                    corrupt = YES;
+                    break;
+                }
+                cursor += argumentLength;
+
+                NSTimeInterval elapsedTime = (double)(int64_t)(timestamp - referenceTimestamp) / NSEC_PER_SEC;
+                NSDate *date = [NSDate dateWithTimeIntervalSinceReferenceDate:referenceTime + elapsedTime];
+                NSString *levelName = HLSLoggerBinaryLevelName(level);
+                NSString *categoryPrefix = (callSite.category.length != 0) ? [NSString stringWithFormat:@"[%@] ", callSite.category] : @"";
+
+                NSString *line = nil;
+                if (callSite.function.length != 0) {
+                    line = [NSString stringWithFormat:@"%@ [%x] [%@] %@(%@) - %@", [dateFormatter stringFromDate:date], threadId, levelName, categoryPrefix, callSite.function, message];
+                }
+                else {
+                    line = [NSString stringWithFormat:@"%@ [%x] [%@] %@%@", [dateFormatter stringFromDate:date], threadId, levelName, categoryPrefix, message];
+                }
+                block(line, &stop);
+            }
+            else {
+                corrupt = YES;
+                break;
+            }
+        }
+    }
+
+    if (corrupt) {
+        if (pError) {
+            *pError = HLSLoggerFileError(NSFileReadCorruptFileError, filePath);
+        }
+        return NO;
+    }
+
+    return YES;
+}
+
+BOOL HLSLoggerConvertBinaryLogFile(NSString *filePath, NSString *textFilePath, NSError *__autoreleasing *pError)
+{
+    NSCParameterAssert(filePath);
+    NSCParameterAssert(textFilePath);
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    if (! [fileManager createFileAtPath:textFilePath contents:nil attributes:nil]) {
+        if (pError) {
+            *pError = HLSLoggerFileError(NSFileWriteUnknownError, textFilePath);
+        }
+        return NO;
+    }
+
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:textFilePath];
+    NSMutableData *batchData = [NSMutableData dataWithCapacity:HLSLoggerDecoderBatchSize];
+    BOOL decoded = HLSLoggerDecodeBinaryLogFile(filePath, ^(NSString *line, BOOL *pStop) {
+        [batchData appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+        [batchData appendBytes:"\n" length:1];
+
+        if (batchData.length >= HLSLoggerDecoderBatchSize) {
+            [fileHandle writeData:batchData];
+            batchData.length = 0;
+        }
+    }, pError);
+    [fileHandle writeData:batchData];
+    [fileHandle closeFile];
+
+    if (! decoded) {
+        [fileManager removeItemAtPath:textFilePath error:NULL];
+        return NO;
+    }
+
+    return YES;
+}
@@ -0,0 +1,86 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLogger.h"
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Random access to the lines of a text log file. The file is memory-mapped and never loaded as a whole: Line offsets
+ * and levels are indexed in the background, and strings are only created for the lines which are actually requested.
+ * Thread-safe
+ *
+ * Lines are available as soon as they have been indexed, i.e. line counts and indexes returned by the methods below
+ * always refer to the lines indexed so far. Binary and compressed log files must be converted into text files first
+ * (see -[HLSLogger enumerateLinesOfLogFileAtPath:error:usingBlock:])
+ */
+@interface HLSLoggerFileReader : NSObject
+
+/**
+ * Create a reader for the specified text log file. Return nil if the file could not be mapped
+ */
+- (nullable instancetype)initWithFilePath:(NSString *)filePath NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The path of the file
+ */
+@property (nonatomic, readonly, copy) NSString *filePath;
+
+/**
+ * The number of lines indexed so far
+ */
+@property (nonatomic, readonly) NSUInteger lineCount;
+
+/**
+ * Return YES iff the whole file has been indexed
+ */
+@property (nonatomic, readonly, getter=isIndexed) BOOL indexed;
+
+/**
+ * Start indexing the file in the background. The progress block (if any) is called on the main thread each time a new
+ * chunk of the file has been indexed, and a last time with finished = YES. Subsequent calls have no effect
+ */
+- (void)indexWithProgressBlock:(nullable void (^)(NSUInteger lineCount, BOOL finished))progressBlock;
+
+/**
+ * Index the file if not already done, and wait until the whole file has been indexed
+ */
+- (void)waitUntilIndexed;
+
+/**
+ * Return the line at the specified index, nil if the index is not valid
+ */
+- (nullable NSString *)lineAtIndex:(NSUInteger)index;
+
+/**
+ * Return the lines in the specified range, which is clamped to the lines indexed so far
+ */
+- (NSArray<NSString *> *)linesInRange:(NSRange)range;
+
+/**
+ * Return the level of the line at the specified index. Lines which do not start with a log entry header (e.g. lines
+ * of multi-line messages) have the level of the preceding entry, or HLSLoggerLevelFatal if there is none, so that they
+ * are never filtered out. Return HLSLoggerLevelNone if the index is not valid
+ */
+- (HLSLoggerLevel)levelOfLineAtIndex:(NSUInteger)index;
+
+/**
+ * Return the indexes of the lines whose level is at least the specified one and, if a string is provided, which contain
+ * it (case-sensitive). Lines are filtered without creating any string
+ */
+- (NSIndexSet *)indexesOfLinesWithMinimumLevel:(HLSLoggerLevel)level containingString:(nullable NSString *)string;
+
+@end
+
+@interface HLSLoggerFileReader (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,303 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerFileReader.h"
+
+#import <pthread.h>
+#import <stdatomic.h>
+
+static const NSUInteger HLSLoggerFileReaderChunkSize = 1024 * 1024;
+static const NSUInteger HLSLoggerFileReaderHeaderLength = 64;           // Entry headers (date, thread and level) are shorter
+
+/**
+ * Return the level of a line starting with an entry header (yyyy-MM-dd HH:mm:ss.SSS [thread] [LEVEL]), or
+ * HLSLoggerLevelNone if the line has no such header
+ */
+static HLSLoggerLevel HLSLoggerFileReaderLevelOfLine(const char *bytes, NSUInteger length)
+{
+    static const struct {
+        const char *name;
+        HLSLoggerLevel level;
+    } s_levels[] = {
+        { "DEBUG]", HLSLoggerLevelDebug },
+        { "INFO]", HLSLoggerLevelInfo },
+        { "WARN]", HLSLoggerLevelWarn },
+        { "ERROR]", HLSLoggerLevelError },
+        { "FATAL]", HLSLoggerLevelFatal }
+    };
+
+    NSUInteger headerLength = MIN(length, HLSLoggerFileReaderHeaderLength);
+    const char *separator = memmem(bytes, headerLength, "] [", 3);
+    if (! separator) {
+        return HLSLoggerLevelNone;
+    }
+
+    const char *name = separator + 3;
+    size_t remainingLength = (size_t)(bytes + headerLength - name);
+    for (size_t i = 0; i < sizeof(s_levels) / sizeof(s_levels[0]); ++i) {
+        size_t nameLength = strlen(s_levels[i].name);
+        if (remainingLength >= nameLength && memcmp(name, s_levels[i].name, nameLength) == 0) {
+            return s_levels[i].level;
+        }
+    }
+    return HLSLoggerLevelNone;
+}
+
+@interface HLSLoggerFileReader () {
+@private
+    pthread_rwlock_t _lock;                     // Protects the index
+    NSUInteger *_lineEnds;                      // Offset of the line feed ending each line (or of the end of the file)
+    uint8_t *_lineLevels;
+    NSUInteger _lineCount;
+    NSUInteger _lineCapacity;
+    NSUInteger _indexedLength;                  // Only accessed from the indexing queue
+    HLSLoggerLevel _entryLevel;                 // Level of the last entry indexed. Only accessed from the indexing queue
+    _Atomic(BOOL) _indexingStarted;
+    _Atomic(BOOL) _indexed;
+}
+
+@property (nonatomic, copy) NSString *filePath;
+@property (nonatomic) NSData *data;
+@property (nonatomic) dispatch_queue_t indexingQueue;
+@property (nonatomic) dispatch_group_t indexingGroup;
+
+@end
+
+@implementation HLSLoggerFileReader
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithFilePath:(NSString *)filePath
+{
+    NSParameterAssert(filePath);
+
+    if (self = [super init]) {
+        // Pages are only loaded when accessed, and can be purged by the system under memory pressure
+        self.data = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedAlways error:NULL];
+        if (! self.data) {
+            return nil;
+        }
+        self.filePath = filePath;
+
+        pthread_rwlock_init(&_lock, NULL);
+        _entryLevel = HLSLoggerLevelFatal;
+        atomic_init(&_indexingStarted, NO);
+        atomic_init(&_indexed, NO);
+
+        self.indexingQueue = dispatch_queue_create("ch.defagos.CoconutKit.HLSLoggerFileReader.indexing", DISPATCH_QUEUE_SERIAL);
+        self.indexingGroup = dispatch_group_create();
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    free(_lineEnds);
+    free(_lineLevels);
+    pthread_rwlock_destroy(&_lock);
+}
+
+#pragma mark Accessors and mutators
+
+- (NSUInteger)lineCount
+{
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger lineCount = _lineCount;
+    pthread_rwlock_unlock(&_lock);
+    return lineCount;
+}
+
+- (BOOL)isIndexed
+{
+    return atomic_load(&_indexed);
+}
+
+#pragma mark Indexing
+
+- (void)indexWithProgressBlock:(void (^)(NSUInteger, BOOL))progressBlock
+{
+    if (atomic_exchange(&_indexingStarted, YES)) {
+        return;
+    }
+
+    // The file is indexed chunk by chunk. Indexing stops if the reader is deallocated
+    __weak __typeof(self) weakSelf = self;
+    dispatch_group_async(self.indexingGroup, self.indexingQueue, ^{
+        BOOL finished = NO;
+        while (! finished) {
+            @autoreleasepool {
+                __typeof(self) strongSelf = weakSelf;
+                if (! strongSelf) {
+                    return;
+                }
+
+                finished = [strongSelf indexNextChunk];
+                if (progressBlock) {
+                    NSUInteger lineCount = strongSelf.lineCount;
+                    BOOL indexed = finished;
+                    dispatch_async(dispatch_get_main_queue(), ^{
+                        progressBlock(lineCount, indexed);
+                    });
+                }
+            }
+        }
+    });
+}
+
+- (void)waitUntilIndexed
+{
+    [self indexWithProgressBlock:nil];
+    dispatch_group_wait(self.indexingGroup, DISPATCH_TIME_FOREVER);
+}
+
+/**
+ * Index the lines starting in the next chunk of the file. Return YES iff the whole file has been indexed. Must be
+ * called on the indexing queue
+ */
+- (BOOL)indexNextChunk
+{
+    const char *bytes = self.data.bytes;
+    NSUInteger length = self.data.length;
+    NSUInteger chunkEnd = MIN(_indexedLength + HLSLoggerFileReaderChunkSize, length);
+
+    // Lines are indexed without holding the lock, then added at once
+    NSMutableData *lineEndsData = [NSMutableData data];
+    NSMutableData *lineLevelsData = [NSMutableData data];
+    NSUInteger lineStart = _indexedLength;
+    while (lineStart < chunkEnd) {
+        // The last line of the chunk is read until its end
+        const char *lineFeed = memchr(bytes + lineStart, '\n', length - lineStart);
+        NSUInteger lineEnd = lineFeed ? (NSUInteger)(lineFeed - bytes) : length;
+
+        HLSLoggerLevel level = HLSLoggerFileReaderLevelOfLine(bytes + lineStart, lineEnd - lineStart);
+        if (level != HLSLoggerLevelNone) {
+            _entryLevel = level;
+        }
+
+        uint8_t lineLevel = (uint8_t)_entryLevel;
+        [lineEndsData appendBytes:&lineEnd length:sizeof(lineEnd)];
+        [lineLevelsData appendBytes:&lineLevel length:sizeof(lineLevel)];
+        lineStart = lineEnd + 1;
+    }
+    _indexedLength = MIN(lineStart, length);
+
+    NSUInteger chunkLineCount = lineLevelsData.length;
+    if (chunkLineCount != 0) {
+        pthread_rwlock_wrlock(&_lock);
+        if (_lineCount + chunkLineCount > _lineCapacity) {
+            _lineCapacity = MAX(2 * _lineCapacity, _lineCount + chunkLineCount);
+            _lineEnds = realloc(_lineEnds, _lineCapacity * sizeof(NSUInteger));
+            _lineLevels = realloc(_lineLevels, _lineCapacity * sizeof(uint8_t));
+        }
+        memcpy(_lineEnds + _lineCount, lineEndsData.bytes, lineEndsData.length);
+        memcpy(_lineLevels + _lineCount, lineLevelsData.bytes, lineLevelsData.length);
+        _lineCount += chunkLineCount;
+        pthread_rwlock_unlock(&_lock);
+    }
+
+    BOOL finished = (_indexedLength == length);
+    if (finished) {
+        atomic_store(&_indexed, YES);
+    }
+    return finished;
+}
+
+#pragma mark Reading lines
+
+/**
+ * Return the byte range of the line at the specified index. The lock must be held and the index must be valid
+ */
+- (NSRange)byteRangeOfLineAtIndex:(NSUInteger)index
+{
+    NSUInteger lineStart = (index == 0) ? 0 : _lineEnds[index - 1] + 1;
+    return NSMakeRange(lineStart, _lineEnds[index] - lineStart);
+}
+
+- (NSString *)lineWithByteRange:(NSRange)byteRange
+{
+    const char *bytes = (const char *)self.data.bytes + byteRange.location;
+
+    // Files might have been truncated in the middle of a character
+    return [[NSString alloc] initWithBytes:bytes length:byteRange.length encoding:NSUTF8StringEncoding]
+        ?: [[NSString alloc] initWithBytes:bytes length:byteRange.length encoding:NSISOLatin1StringEncoding];
+}
+
+- (NSString *)lineAtIndex:(NSUInteger)index
+{
+    pthread_rwlock_rdlock(&_lock);
+    if (index >= _lineCount) {
+        pthread_rwlock_unlock(&_lock);
+        return nil;
+    }
+    NSRange byteRange = [self byteRangeOfLineAtIndex:index];
+    pthread_rwlock_unlock(&_lock);
+
+    return [self lineWithByteRange:byteRange];
+}
+
+- (NSArray<NSString *> *)linesInRange:(NSRange)range
+{
+    NSMutableArray<NSString *> *lines = [NSMutableArray arrayWithCapacity:range.length];
+
+    pthread_rwlock_rdlock(&_lock);
+    NSUInteger end = MIN(NSMaxRange(range), _lineCount);
+    for (NSUInteger i = range.location; i < end; ++i) {
+        [lines addObject:[self lineWithByteRange:[self byteRangeOfLineAtIndex:i]]];
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    return [lines copy];
+}
+
+- (HLSLoggerLevel)levelOfLineAtIndex:(NSUInteger)index
+{
+    pthread_rwlock_rdlock(&_lock);
+    HLSLoggerLevel level = (index < _lineCount) ? (HLSLoggerLevel)_lineLevels[index] : HLSLoggerLevelNone;
+    pthread_rwlock_unlock(&_lock);
+    return level;
+}
+
+#pragma mark Filtering
+
+- (NSIndexSet *)indexesOfLinesWithMinimumLevel:(HLSLoggerLevel)level containingString:(NSString *)string
+{
+    // Search directly in the UTF-8 bytes of the file
+    NSData *stringData = (string.length != 0) ? [string dataUsingEncoding:NSUTF8StringEncoding] : nil;
+    const char *bytes = self.data.bytes;
+
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+
+    pthread_rwlock_rdlock(&_lock);
+    for (NSUInteger i = 0; i < _lineCount; ++i) {
+        if (_lineLevels[i] < level) {
+            continue;
+        }
+
+        if (stringData) {
+            NSRange byteRange = [self byteRangeOfLineAtIndex:i];
+            if (! memmem(bytes + byteRange.location, byteRange.length, stringData.bytes, stringData.length)) {
+                continue;
+            }
+        }
+
+        [indexes addIndex:i];
+    }
+    pthread_rwlock_unlock(&_lock);
+
+    return [indexes copy];
+}
+
+@end
@@ -0,0 +1,56 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+#import <mach/mach.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * A log entry waiting to be written. The message is a retained CFStringRef (use CFBridgingRetain / CFBridgingRelease)
+ */
+typedef struct {
+    CFAbsoluteTime timestamp;
+    mach_port_t threadId;
+    CFTypeRef message;
+} HLSLoggerRecord;
+
+/**
+ * Private bounded lock-free queue of log records. Any number of threads can enqueue and dequeue records concurrently
+ * (enqueuing threads dequeue records themselves when dropping the oldest ones). No lock is ever taken, and no memory
+ * is allocated once the buffer has been created
+ */
+@interface HLSLoggerRingBuffer : NSObject
+
+/**
+ * Create a buffer able to hold the specified number of records, which must be a power of 2
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity NS_DESIGNATED_INITIALIZER;
+
+/**
+ * The number of records which the buffer can hold
+ */
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ * Add a record at the end of the buffer. Return NO if the buffer is full
+ */
+- (BOOL)enqueueRecord:(HLSLoggerRecord)record;
+
+/**
+ * Remove the oldest record from the buffer. Return NO if the buffer is empty
+ */
+- (BOOL)dequeueRecord:(HLSLoggerRecord *)pRecord;
+
+@end
+
+@interface HLSLoggerRingBuffer (UnavailableMethods)
+
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
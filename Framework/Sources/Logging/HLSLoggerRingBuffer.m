@@ -0,0 +1,145 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerRingBuffer.h"
+
+#import <stdatomic.h>
+
+/**
+ * Each slot carries a sequence number telling whether it can be written (sequence == position) or read (sequence ==
+ * position + 1) at a given queue position, see http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+typedef struct {
+    _Atomic(NSUInteger) sequence;
+    HLSLoggerRecord record;
+} HLSLoggerRingBufferSlot;
+
+@interface HLSLoggerRingBuffer () {
+@private
+    HLSLoggerRingBufferSlot *_slots;
+    NSUInteger _mask;
+    _Atomic(NSUInteger) _enqueuePosition;
+    _Atomic(NSUInteger) _dequeuePosition;
+}
+
+@end
+
+@implementation HLSLoggerRingBuffer
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+    NSParameterAssert(capacity >= 2 && (capacity & (capacity - 1)) == 0);
+
+    if (self = [super init]) {
+        _slots = calloc(capacity, sizeof(HLSLoggerRingBufferSlot));
+        for (NSUInteger i = 0; i < capacity; ++i) {
+            atomic_init(&_slots[i].sequence, i);
+        }
+        _mask = capacity - 1;
+        atomic_init(&_enqueuePosition, 0);
+        atomic_init(&_dequeuePosition, 0);
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
+}
+
+#pragma clang diagnostic pop
+
+- (void)dealloc
+{
+    HLSLoggerRecord record;
+    while ([self dequeueRecord:&record]) {
+        if (record.message) {
+            CFRelease(record.message);
+        }
+    }
+    free(_slots);
+}
+
+#pragma mark Accessors and mutators
+
+- (NSUInteger)capacity
+{
+    return _mask + 1;
+}
+
+#pragma mark Queue operations
+
+- (BOOL)enqueueRecord:(HLSLoggerRecord)record
+{
+    HLSLoggerRingBufferSlot *slot = NULL;
+    NSUInteger position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+    while (YES) {
+        slot = &_slots[position & _mask];
+        NSUInteger sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            // On failure, the current position is loaded again
+            if (atomic_compare_exchange_weak_explicit(&_enqueuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return NO;
+        }
+        else {
+            position = atomic_load_explicit(&_enqueuePosition, memory_order_relaxed);
+        }
+    }
+
+    slot->record = record;
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+    return YES;
+}
+
+- (BOOL)dequeueRecord:(HLSLoggerRecord *)pRecord
+{
+    NSParameterAssert(pRecord);
+
+    HLSLoggerRingBufferSlot *slot = NULL;
+    NSUInteger position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+    while (YES) {
+        slot = &_slots[position & _mask];
+        NSUInteger sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_dequeuePosition, &position, position + 1, memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        }
+        else if (difference < 0) {
+            return NO;
+        }
+        else {
+            position = atomic_load_explicit(&_dequeuePosition, memory_order_relaxed);
+        }
+    }
+
+    *pRecord = slot->record;
+    atomic_store_explicit(&slot->sequence, position + _mask + 1, memory_order_release);
+    return YES;
+}
+
+#pragma mark Description
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@: %p; capacity: %@>",
+            [self class],
+            self,
+            @(self.capacity)];
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Lightweight tracing, meant to profile real sessions (not only Instruments runs). Intervals and counters are recorded
+ * with monotonic timestamps into buffers preallocated for each thread, without any lock or allocation, and can be
+ * exported in the Chrome trace event format (open the file with chrome://tracing or https://ui.perfetto.dev)
+ *
+ * Tracing is disabled by default. When disabled, recording an event costs a single branch. Event names must be string
+ * literals (or strings living as long as the process), since only their address is recorded
+ *
+ * Example:
+ *   - (void)reloadData
+ *   {
+ *       HLSTraceInterval("MyViewController.reloadData");
+ *       ...                // Recorded until the end of the scope, even when returning early
+ *   }
+ */
+
+typedef NS_ENUM(uint8_t, HLSTraceEventType) {
+    HLSTraceEventTypeEnumBegin = 0,
+    HLSTraceEventTypeBegin = HLSTraceEventTypeEnumBegin,    // Interval begin, nested on the current thread
+    HLSTraceEventTypeEnd,                                   // Interval end, nested on the current thread
+    HLSTraceEventTypeAsyncBegin,                            // Interval begin, identified by a value (e.g. object address)
+    HLSTraceEventTypeAsyncEnd,                              // Interval end, identified by a value
+    HLSTraceEventTypeCounter,                               // Counter value
+    HLSTraceEventTypeEnumEnd,
+    HLSTraceEventTypeEnumSize = HLSTraceEventTypeEnumEnd - HLSTraceEventTypeEnumBegin
+};
+
+/**
+ * YES iff tracing is enabled. Read-only, use HLSTracingSetEnabled() to change it
+ */
+OBJC_EXPORT BOOL HLSTracingEnabled;
+
+/**
+ * Enable or disable tracing. Events recorded so far are kept
+ */
+OBJC_EXPORT void HLSTracingSetEnabled(BOOL enabled);
+
+/**
+ * Discard all events recorded so far
+ */
+OBJC_EXPORT void HLSTracingReset(void);
+
+/**
+ * The number of events which could not be recorded since the last reset, because the buffer of their thread was full or
+ * because too many threads were recording events
+ */
+OBJC_EXPORT NSUInteger HLSTracingDroppedEventCount(void);
+
+/**
+ * Return the events recorded so far in the Chrome trace event JSON format. Can be called while events are recorded.
+ * Events of exited threads might not be exported again, since their buffers can then be reused by new threads
+ */
+OBJC_EXPORT NSData *HLSTracingChromeTraceData(void);
+
+/**
+ * Write the events recorded so far in the Chrome trace event JSON format. The file is replaced if it already exists
+ */
+OBJC_EXPORT BOOL HLSTracingWriteChromeTraceToFile(NSString *filePath, NSError *__autoreleasing *pError);
+
+/**
+ * Record an event. Do not call directly, use the macros below, which check whether tracing is enabled first
+ */
+OBJC_EXPORT void HLSTraceRecordEvent(HLSTraceEventType type, const char *name, int64_t value);
+
+// Intervals on the current thread. Must be properly nested
+#define HLSTraceBegin(name)                         HLSTraceRecordEventIfEnabled(HLSTraceEventTypeBegin, name, 0)
+#define HLSTraceEnd(name)                           HLSTraceRecordEventIfEnabled(HLSTraceEventTypeEnd, name, 0)
+
+// Interval lasting until the end of the current scope
+#define HLSTraceInterval(name)                                                                                          \
+    __attribute__((cleanup(HLSTraceIntervalEnd), unused)) const char *hls_trace_interval = HLSTraceIntervalBegin(name)
+
+// Intervals spanning several threads or run loop iterations (e.g. network requests). Intervals with the same name are
+// matched by identifier (e.g. the address of the object whose lifetime is traced)
+#define HLSTraceAsyncBegin(name, identifier)        HLSTraceRecordEventIfEnabled(HLSTraceEventTypeAsyncBegin, name, (int64_t)(identifier))
+#define HLSTraceAsyncEnd(name, identifier)          HLSTraceRecordEventIfEnabled(HLSTraceEventTypeAsyncEnd, name, (int64_t)(identifier))
+
+// Counter values
+#define HLSTraceCounter(name, value)                HLSTraceRecordEventIfEnabled(HLSTraceEventTypeCounter, name, (int64_t)(value))
+
+#define HLSTraceRecordEventIfEnabled(type, name, value)                                                                 \
+    do {                                                                                                                \
+        if (__builtin_expect(HLSTracingEnabled, NO)) {                                                                  \
+            HLSTraceRecordEvent(type, name, value);                                                                     \
+        }                                                                                                               \
+    } while (0)
+
+// Implementation of HLSTraceInterval. An interval is only ended if it was begun, even if tracing is toggled meanwhile
+static inline const char * _Nullable HLSTraceIntervalBegin(const char *name)
+{
+    if (__builtin_expect(HLSTracingEnabled, NO)) {
+        HLSTraceRecordEvent(HLSTraceEventTypeBegin, name, 0);
+        return name;
+    }
+    else {
+        return NULL;
+    }
+}
+
+static inline void HLSTraceIntervalEnd(const char * _Nullable *pName)
+{
+    if (*pName) {
+        HLSTraceRecordEvent(HLSTraceEventTypeEnd, *pName, 0);
+    }
+}
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,265 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSTracing.h"
+
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdatomic.h>
+#import <unistd.h>
+
+static const NSUInteger HLSTraceBufferCapacity = 8192;                  // Events per thread (256 KB)
+static const NSUInteger HLSTraceMaximumBufferCount = 64;                // Threads recording events at the same time (16 MB)
+
+typedef struct {
+    uint64_t time;                                                      // Mach absolute time
+    const char *name;
+    int64_t value;                                                      // Counter value or async identifier
+    HLSTraceEventType type;
+} HLSTraceEvent;
+
+/**
+ * Buffer owned by a thread. Buffers are never freed, so that events of exited threads can still be exported, but are
+ * reused by new threads once their events have been exported or discarded. Their generation and event count are packed
+ * together so that both can be read at once
+ */
+typedef struct HLSTraceBuffer {
+    HLSTraceEvent *events;
+    _Atomic(uint64_t) state;                                            // Generation (high 32 bits) and event count
+    _Atomic(BOOL) retired;                                              // Set when the owner thread exits
+    BOOL exported;                                                      // Protected by s_buffersLock
+    uint64_t threadIdentifier;                                          // Protected by s_buffersLock
+    char threadName[64];                                                // Protected by s_buffersLock
+    struct HLSTraceBuffer *next;
+} HLSTraceBuffer;
+
+BOOL HLSTracingEnabled = NO;
+
+static pthread_mutex_t s_buffersLock = PTHREAD_MUTEX_INITIALIZER;
+static HLSTraceBuffer *s_buffers = NULL;                                // Protected by s_buffersLock
+static NSUInteger s_bufferCount = 0;                                    // Protected by s_buffersLock
+static __thread uint32_t s_deniedGeneration = 0;                        // Generation in which no buffer was available
+static pthread_key_t s_bufferKey;
+static _Atomic(uint32_t) s_generation = 1;
+static _Atomic(NSUInteger) s_droppedEventCount = 0;
+
+static inline uint64_t HLSTraceBufferState(uint32_t generation, uint32_t count)
+{
+    return ((uint64_t)generation << 32) | count;
+}
+
+static void HLSTraceBufferRetire(void *buffer)
+{
+    atomic_store(&((HLSTraceBuffer *)buffer)->retired, YES);
+}
+
+/**
+ * Return the buffer of the current thread, reusing the buffer of an exited thread whose events have been exported or
+ * discarded. Return NULL if no buffer is available, in which case the thread tries again after the next reset
+ */
+static HLSTraceBuffer *HLSTraceCurrentBuffer(void)
+{
+    static dispatch_once_t s_onceToken;
+    dispatch_once(&s_onceToken, ^{
+        pthread_key_create(&s_bufferKey, HLSTraceBufferRetire);
+    });
+
+    HLSTraceBuffer *buffer = pthread_getspecific(s_bufferKey);
+    if (buffer) {
+        return buffer;
+    }
+
+    uint32_t generation = atomic_load(&s_generation);
+    if (s_deniedGeneration == generation) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s_buffersLock);
+    for (HLSTraceBuffer *retiredBuffer = s_buffers; retiredBuffer; retiredBuffer = retiredBuffer->next) {
+        if (atomic_load(&retiredBuffer->retired)
+                && (retiredBuffer->exported || (uint32_t)(atomic_load(&retiredBuffer->state) >> 32) != generation)) {
+            buffer = retiredBuffer;
+            break;
+        }
+    }
+    if (! buffer && s_bufferCount < HLSTraceMaximumBufferCount) {
+        buffer = calloc(1, sizeof(HLSTraceBuffer));
+        HLSTraceEvent *events = malloc(HLSTraceBufferCapacity * sizeof(HLSTraceEvent));
+        if (buffer && events) {
+            buffer->events = events;
+            buffer->next = s_buffers;
+            s_buffers = buffer;
+            ++s_bufferCount;
+        }
+        else {
+            free(buffer);
+            free(events);
+            buffer = NULL;
+        }
+    }
+    if (! buffer) {
+        pthread_mutex_unlock(&s_buffersLock);
+        s_deniedGeneration = generation;
+        return NULL;
+    }
+
+    // The main thread has no name
+    pthread_threadid_np(NULL, &buffer->threadIdentifier);
+    if (pthread_main_np()) {
+        strlcpy(buffer->threadName, "main", sizeof(buffer->threadName));
+    }
+    else {
+        pthread_getname_np(pthread_self(), buffer->threadName, sizeof(buffer->threadName));
+    }
+    atomic_store(&buffer->state, HLSTraceBufferState(generation, 0));
+    atomic_store(&buffer->retired, NO);
+    buffer->exported = NO;
+    pthread_mutex_unlock(&s_buffersLock);
+
+    pthread_setspecific(s_bufferKey, buffer);
+    return buffer;
+}
+
+#pragma mark Recording
+
+void HLSTraceRecordEvent(HLSTraceEventType type, const char *name, int64_t value)
+{
+    HLSTraceBuffer *buffer = HLSTraceCurrentBuffer();
+    if (! buffer) {
+        atomic_fetch_add_explicit(&s_droppedEventCount, 1, memory_order_relaxed);
+        return;
+    }
+
+    // Only the owner thread writes to its buffer. Events from previous generations are overwritten
+    uint32_t generation = atomic_load_explicit(&s_generation, memory_order_relaxed);
+    uint64_t state = atomic_load_explicit(&buffer->state, memory_order_relaxed);
+    uint32_t count = ((uint32_t)(state >> 32) == generation) ? (uint32_t)state : 0;
+    if (count == HLSTraceBufferCapacity) {
+        atomic_fetch_add_explicit(&s_droppedEventCount, 1, memory_order_relaxed);
+        return;
+    }
+
+    HLSTraceEvent *event = &buffer->events[count];
+    event->time = mach_absolute_time();
+    event->name = name;
+    event->value = value;
+    event->type = type;
+
+    // Publish the event
+    atomic_store_explicit(&buffer->state, HLSTraceBufferState(generation, count + 1), memory_order_release);
+}
+
+#pragma mark Settings
+
+void HLSTracingSetEnabled(BOOL enabled)
+{
+    __atomic_store_n(&HLSTracingEnabled, enabled, __ATOMIC_RELAXED);
+}
+
+void HLSTracingReset(void)
+{
+    // Buffers are lazily emptied by their owner threads when they record their next event
+    atomic_fetch_add(&s_generation, 1);
+    atomic_store(&s_droppedEventCount, 0);
+}
+
+NSUInteger HLSTracingDroppedEventCount(void)
+{
+    return atomic_load(&s_droppedEventCount);
+}
+
+#pragma mark Export
+
+static NSDictionary<NSString *, id> *HLSTraceChromeEvent(const HLSTraceEvent *event, double nanosecondsPerTick, uint64_t threadIdentifier)
+{
+    static NSString * const s_phases[] = {
+        [HLSTraceEventTypeBegin] = @"B",
+        [HLSTraceEventTypeEnd] = @"E",
+        [HLSTraceEventTypeAsyncBegin] = @"b",
+        [HLSTraceEventTypeAsyncEnd] = @"e",
+        [HLSTraceEventTypeCounter] = @"C"
+    };
+
+    NSMutableDictionary<NSString *, id> *chromeEvent = [@{ @"name" : @(event->name),
+                                                           @"cat" : @"CoconutKit",
+                                                           @"ph" : s_phases[event->type],
+                                                           @"ts" : @(event->time * nanosecondsPerTick / 1000.),        // In microseconds
+                                                           @"pid" : @(getpid()),
+                                                           @"tid" : @(threadIdentifier) } mutableCopy];
+    switch (event->type) {
+        case HLSTraceEventTypeAsyncBegin:
+        case HLSTraceEventTypeAsyncEnd: {
+            chromeEvent[@"id"] = [NSString stringWithFormat:@"0x%llx", (unsigned long long)event->value];
+            break;
+        }
+
+        case HLSTraceEventTypeCounter: {
+            chromeEvent[@"args"] = @{ @"value" : @(event->value) };
+            break;
+        }
+
+        default: {
+            break;
+        }
+    }
+    return [chromeEvent copy];
+}
+
+NSData *HLSTracingChromeTraceData(void)
+{
+    mach_timebase_info_data_t timebaseInfo;
+    mach_timebase_info(&timebaseInfo);
+    double nanosecondsPerTick = (double)timebaseInfo.numer / timebaseInfo.denom;
+
+    uint32_t generation = atomic_load(&s_generation);
+    NSMutableArray<NSDictionary<NSString *, id> *> *chromeEvents = [NSMutableArray array];
+
+    pthread_mutex_lock(&s_buffersLock);
+    for (HLSTraceBuffer *buffer = s_buffers; buffer; buffer = buffer->next) {
+        uint64_t state = atomic_load_explicit(&buffer->state, memory_order_acquire);
+        if ((uint32_t)(state >> 32) != generation) {
+            continue;
+        }
+
+        // Published events are not modified until the next generation. Copy them first and discard everything if a reset
+        // occurred meanwhile
+        uint32_t count = (uint32_t)state;
+        NSData *eventsData = [NSData dataWithBytes:buffer->events length:count * sizeof(HLSTraceEvent)];
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&s_generation, memory_order_relaxed) != generation) {
+            [chromeEvents removeAllObjects];
+            break;
+        }
+
+        // Buffers of exited threads can be reused once exported
+        if (atomic_load(&buffer->retired)) {
+            buffer->exported = YES;
+        }
+
+        [chromeEvents addObject:@{ @"name" : @"thread_name",
+                                   @"ph" : @"M",
+                                   @"pid" : @(getpid()),
+                                   @"tid" : @(buffer->threadIdentifier),
+                                   @"args" : @{ @"name" : @(buffer->threadName) ?: @"" } }];
+
+        const HLSTraceEvent *events = eventsData.bytes;
+        for (uint32_t i = 0; i < count; ++i) {
+            [chromeEvents addObject:HLSTraceChromeEvent(&events[i], nanosecondsPerTick, buffer->threadIdentifier)];
+        }
+    }
+    pthread_mutex_unlock(&s_buffersLock);
+
+    NSDictionary *trace = @{ @"traceEvents" : [chromeEvents copy],
+                             @"displayTimeUnit" : @"ns" };
+    return [NSJSONSerialization dataWithJSONObject:trace options:0 error:NULL];
+}
+
+BOOL HLSTracingWriteChromeTraceToFile(NSString *filePath, NSError *__autoreleasing *pError)
+{
+    NSCParameterAssert(filePath);
+
+    return [HLSTracingChromeTraceData() writeToFile:filePath options:NSDataWritingAtomic error:pError];
+}
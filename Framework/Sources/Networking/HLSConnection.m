@@ -7,8 +7,10 @@
 #import "HLSConnection.h"
 
 #import "HLSLogger.h"
+#import "HLSTracing.h"
 #import "HLSTransformer.h"
 #import "NSError+HLSExtensions.h"
+#import <objc/runtime.h>
 
 @interface HLSConnection ()
 
@@ -89,6 +91,8 @@
         return;
     }
     
+    HLSTraceAsyncBegin(class_getName([self class]), self);
+    
     self.selfRunning = YES;
     self.finished = NO;
     self.runLoopModes = runLoopModes;
@@ -220,6 +224,8 @@
     }
     [self updateProgressWithCompletedUnitCount:self.progress.totalUnitCount];
     
+    HLSTraceAsyncEnd(class_getName([self class]), self);
+    
     self.finished = YES;
     self.error = error;
     self.completionBlock ? self.completionBlock(self, responseObject, error) : nil;
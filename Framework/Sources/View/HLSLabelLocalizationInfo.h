@@ -35,6 +35,12 @@ typedef NS_ENUM(NSInteger, HLSLabelRepresentation) {
  */
 - (instancetype)initWithAttributedText:(nullable NSAttributedString *)attributedText text:(nullable NSString *)text tableName:(nullable NSString *)tableName bundleName:(nullable NSString *)bundleName NS_DESIGNATED_INITIALIZER;
 
+/**
+ * The table and bundle names used for lookup
+ */
+@property (nonatomic, readonly, copy, nullable) NSString *tableName;
+@property (nonatomic, readonly, copy, nullable) NSString *bundleName;
+
 /**
  * Return YES iff the information object corresponds to localized content
  */
@@ -62,6 +68,14 @@ typedef NS_ENUM(NSInteger, HLSLabelRepresentation) {
  */
 @property (nonatomic, readonly, copy, nullable) NSAttributedString *localizedAttributedText;
 
+/**
+ * Same as the properties above, but looking up strings in a bundle which has already been resolved from the bundle name
+ * (nil if the bundle was not found). Use when localizing several labels at once
+ */
+- (BOOL)isIncompleteInBundle:(nullable NSBundle *)bundle;
+- (nullable NSString *)localizedTextInBundle:(nullable NSBundle *)bundle;
+- (nullable NSAttributedString *)localizedAttributedTextInBundle:(nullable NSBundle *)bundle;
+
 @end
 
 @interface HLSLabelLocalizationInfo (UnavailableMethods)
@@ -104,6 +104,11 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
 }
 
 - (BOOL)isIncomplete
+{
+    return [self isIncompleteInBundle:[NSBundle bundleWithName:self.bundleName]];
+}
+
+- (BOOL)isIncompleteInBundle:(NSBundle *)bundle
 {
     // Missing localization key
     if (self.localizationKey.length == 0) {
@@ -111,7 +116,6 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
     }
     
     // Missing translation
-    NSBundle *bundle = [NSBundle bundleWithName:self.bundleName];
     if (! bundle) {
         HLSLoggerWarn(@"The bundle %@ was not found", self.bundleName);
         return NO;
@@ -129,13 +133,23 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
 
 - (NSAttributedString *)localizedAttributedText
 {
-    NSString *text = [self localizedText];
+    return [self localizedAttributedTextInBundle:[NSBundle bundleWithName:self.bundleName]];
+}
+
+- (NSAttributedString *)localizedAttributedTextInBundle:(NSBundle *)bundle
+{
+    NSString *text = [self localizedTextInBundle:bundle];
     NSMutableAttributedString *attributedText = [self.originalAttributedText mutableCopy];
     [attributedText replaceCharactersInRange:NSMakeRange(0, attributedText.length) withString:text];
     return [attributedText copy];
 }
 
 - (NSString *)localizedText
+{
+    return [self localizedTextInBundle:[NSBundle bundleWithName:self.bundleName]];
+}
+
+- (NSString *)localizedTextInBundle:(NSBundle *)bundle
 {
     if (! self.localizationKey) {
         return nil;
@@ -148,7 +162,6 @@ static NSString *stringForLabelRepresentation(HLSLabelRepresentation representat
     else {
         // We use an explicit constant string for missing localizations since otherwise the localization key itself would
         // be returned by the localizedStringForKey:value:table method
-        NSBundle *bundle = [NSBundle bundleWithName:self.bundleName];
         if (! bundle) {
             HLSLoggerWarn(@"The bundle %@ was not found", self.bundleName);
             return self.localizationKey;
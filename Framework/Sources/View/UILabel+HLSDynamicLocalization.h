@@ -52,7 +52,8 @@ NS_ASSUME_NONNULL_BEGIN
  *   [[NSUserDefaults standardUserDefaults] setValue:[NSNumber numberWithBool:YES] forKey:@"NSShowNonLocalizedStrings"];
  *
  * This category integrates with HLSBundle+HLSDynamicLocalization so that localized labels are updated when the 
- * localization language is changed at runtime.
+ * localization language is changed at runtime. All displayed labels are updated at once, labels which are not
+ * displayed when the language changes are updated when they appear.
  *
  * This category currently has some limitations, but which should not be real issues:
  *   - no comment can be provided. This would have been too verbose, and in my experience comments added
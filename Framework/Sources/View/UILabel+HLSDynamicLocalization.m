@@ -8,33 +8,52 @@
 
 #import "HLSLabelLocalizationInfo.h"
 #import "HLSLogger.h"
+#import "HLSObjectState.h"
 #import "HLSRuntime.h"
 #import "NSBundle+HLSDynamicLocalization.h"
+#import "NSBundle+HLSExtensions.h"
 #import "NSDictionary+HLSExtensions.h"
 #import "NSString+HLSExtensions.h"
+#import <QuartzCore/QuartzCore.h>
 
 static BOOL s_missingLocalizationsVisible = NO;
 
-// Keys for associated objects
-static void *s_localizationInfosKey = &s_localizationInfosKey;
-static void *s_originalBackgroundColorKey = &s_originalBackgroundColorKey;
+// Labels localized with prefixes, and those which must be localized again when they appear. Main thread only
+static NSHashTable<UILabel *> *s_localizedLabels = nil;
+static NSHashTable<UILabel *> *s_pendingLabels = nil;
 
-static void *s_localizationTableNameKey = &s_localizationTableNameKey;
-static void *s_localizationBundleNameKey = &s_localizationBundleNameKey;
+// Incremented when table or bundle settings, or the view hierarchy, change. Main thread only
+static NSUInteger s_localizationSettingsGeneration = 1;
 
 // Original implementation of the methods we swizzle
-static void (*s_dealloc)(__unsafe_unretained id, SEL) = NULL;
 static void (*s_awakeFromNib)(id, SEL) = NULL;
+static void (*s_didMoveToWindow)(id, SEL) = NULL;
 static void (*s_setText)(id, SEL, id) = NULL;
 static void (*s_setAttributedText)(id, SEL, id) = NULL;
 static void (*s_setBackgroundColor)(id, SEL, id) = NULL;
+static void (*s_UIView_didMoveToSuperview)(id, SEL) = NULL;
 
 // Swizzled method implementations
-static void swizzle_dealloc(__unsafe_unretained UILabel *self, SEL _cmd);
 static void swizzle_awakeFromNib(UILabel *self, SEL _cmd);
+static void swizzle_didMoveToWindow(UILabel *self, SEL _cmd);
 static void swizzle_setText(UILabel *self, SEL _cmd, NSString *text);
 static void swizzle_setAttributedText(UILabel *self, SEL _cmd, NSAttributedString *attributedText);
 static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgroundColor);
+static void swizzle_UIView_didMoveToSuperview(UIView *self, SEL _cmd);
+
+/**
+ * Table and bundle names resolved for a view from its own settings and those of its ancestors. Cached on views so that
+ * the settings of a view hierarchy are resolved once, whatever the number of labels it contains
+ */
+@interface HLSResolvedLocalizationSettings : NSObject
+
+- (instancetype)initWithTableName:(NSString *)tableName bundleName:(NSString *)bundleName NS_DESIGNATED_INITIALIZER;
+
+@property (nonatomic, readonly, copy) NSString *tableName;
+@property (nonatomic, readonly, copy) NSString *bundleName;
+@property (nonatomic, readonly) NSUInteger generation;
+
+@end
 
 @interface UILabel (HLSDynamicLocalizationPrivate)
 
@@ -42,8 +61,9 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
 
 - (void)setAndLocalizeAttributedText:(NSAttributedString *)attributedText text:(NSString *)text;
 - (void)localizeWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo;
+- (void)localizeWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo bundle:(NSBundle *)bundle;
 
-- (void)currentLocalizationDidChange:(NSNotification *)notification;
++ (void)currentLocalizationDidChange:(NSNotification *)notification;
 
 @end
 
@@ -52,6 +72,8 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
 @property (nonatomic, copy) NSString *locTable;
 @property (nonatomic, copy) NSString *locBundle;
 
+@property (nonatomic, readonly) HLSResolvedLocalizationSettings *resolvedLocalizationSettings;
+
 @end
 
 @implementation UILabel (HLSDynamicLocalization)
@@ -79,11 +101,20 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
 
 + (void)load
 {
-    HLSSwizzleSelector(self, sel_getUid("dealloc"), swizzle_dealloc, &s_dealloc);
-    HLSSwizzleSelector(self, @selector(awakeFromNib), swizzle_awakeFromNib, &s_awakeFromNib);
-    HLSSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
-    HLSSwizzleSelector(self, @selector(setAttributedText:), swizzle_setAttributedText, &s_setAttributedText);
-    HLSSwizzleSelector(self, @selector(setBackgroundColor:), swizzle_setBackgroundColor, &s_setBackgroundColor);
+    s_localizedLabels = [NSHashTable weakObjectsHashTable];
+    s_pendingLabels = [NSHashTable weakObjectsHashTable];
+    
+    // A single observer for all labels
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(currentLocalizationDidChange:)
+                                                 name:HLSCurrentLocalizationDidChangeNotification
+                                               object:nil];
+    
+    HLSRegisterSwizzleSelector(self, @selector(awakeFromNib), swizzle_awakeFromNib, &s_awakeFromNib);
+    HLSRegisterSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
+    HLSRegisterSwizzleSelector(self, @selector(setText:), swizzle_setText, &s_setText);
+    HLSRegisterSwizzleSelector(self, @selector(setAttributedText:), swizzle_setAttributedText, &s_setAttributedText);
+    HLSRegisterSwizzleSelector(self, @selector(setBackgroundColor:), swizzle_setBackgroundColor, &s_setBackgroundColor);
 }
 
 #pragma mark Localization
@@ -95,7 +126,7 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
         UIButton *button = (UIButton *)self.superview;
         
         // Get localization info for all states. Attached to the button (because it carries the states)
-        NSDictionary *buttonStateToLocalizationInfoMap = hls_getAssociatedObject(button, s_localizationInfosKey);
+        NSDictionary *buttonStateToLocalizationInfoMap = HLSObjectStateForObject(button).localizationInfosByState;
         if (! buttonStateToLocalizationInfoMap) {
             return nil;
         }
@@ -106,7 +137,7 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
     }
     // Standalone label
     else {
-        return hls_getAssociatedObject(self, s_localizationInfosKey);
+        return HLSObjectStateForObject(self).localizationInfo;
     }
 }
 
@@ -117,7 +148,8 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
         UIButton *button = (UIButton *)self.superview;
         
         // Get localization info for all states (lazily added if needed). Attached to the button (because it carries the states)
-        NSDictionary *buttonStateToLocalizationInfoMap = hls_getAssociatedObject(button, s_localizationInfosKey);
+        HLSObjectState *buttonState = HLSObjectStateCreateForObject(button);
+        NSDictionary *buttonStateToLocalizationInfoMap = buttonState.localizationInfosByState;
         if (! buttonStateToLocalizationInfoMap) {
             buttonStateToLocalizationInfoMap = @{};
         }
@@ -127,11 +159,11 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
         buttonStateToLocalizationInfoMap = [buttonStateToLocalizationInfoMap dictionaryBySettingObject:localizationInfo 
                                                                                                 forKey:buttonStateKey];
         
-        hls_setAssociatedObject(button, s_localizationInfosKey, buttonStateToLocalizationInfoMap, HLS_ASSOCIATION_STRONG_NONATOMIC);
+        buttonState.localizationInfosByState = buttonStateToLocalizationInfoMap;
     }
     // Standalone label
     else {
-        hls_setAssociatedObject(self, s_localizationInfosKey, localizationInfo, HLS_ASSOCIATION_STRONG_NONATOMIC);
+        HLSObjectStateCreateForObject(self).localizationInfo = localizationInfo;
     }
 }
 
@@ -162,32 +194,19 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
     HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
     if (! localizationInfo) {
         NSString *tableName = self.locTable;
-        if (! tableName) {
-            UIView *parentView = self.superview;
-            while (parentView && ! parentView.locTable.filled) {
-                parentView = parentView.superview;
-            }
-            tableName = parentView.locTable;
-        }
-        
         NSString *bundleName = self.locBundle;
-        if (! bundleName) {
-            UIView *parentView = self.superview;
-            while (parentView && ! parentView.locBundle.filled) {
-                parentView = parentView.superview;
-            }
-            bundleName = parentView.locBundle;
+        if (! tableName || ! bundleName) {
+            HLSResolvedLocalizationSettings *parentSettings = self.superview.resolvedLocalizationSettings;
+            tableName = tableName ?: parentSettings.tableName;
+            bundleName = bundleName ?: parentSettings.bundleName;
         }
         
         localizationInfo = [[HLSLabelLocalizationInfo alloc] initWithAttributedText:attributedText text:text tableName:tableName bundleName:bundleName];
         [self setLocalizationInfo:localizationInfo];
         
-        // For labels localized with prefixes only: Listen to localization change notifications
+        // For labels localized with prefixes only: Relocalize when the localization changes
         if (localizationInfo.localized) {
-            [[NSNotificationCenter defaultCenter] addObserver:self 
-                                                     selector:@selector(currentLocalizationDidChange:) 
-                                                         name:HLSCurrentLocalizationDidChangeNotification 
-                                                       object:nil];
+            [s_localizedLabels addObject:self];
         }
     }
     
@@ -205,8 +224,21 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
 
 - (void)localizeWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo
 {
+    [self localizeWithLocalizationInfo:localizationInfo bundle:[NSBundle bundleWithName:localizationInfo.bundleName]];
+}
+
+- (void)localizeWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo bundle:(NSBundle *)bundle
+{
+    [s_pendingLabels removeObject:self];
+    
+    // Texts are only set if they changed, so that labels whose text is the same in both languages are not laid out again
     if (localizationInfo.attributed) {
-        NSAttributedString *localizedAttributedText = localizationInfo.localizedAttributedText;
+        NSAttributedString *localizedAttributedText = [localizationInfo localizedAttributedTextInBundle:bundle];
+        if ([localizedAttributedText isEqualToAttributedString:self.attributedText]) {
+            [self updateMissingLocalizationBackgroundWithLocalizationInfo:localizationInfo bundle:bundle];
+            return;
+        }
+        
         s_setAttributedText(self, @selector(setAttributedText:), localizedAttributedText);
         
         // Avoid button label truncation when the localization changes (setting the title triggers a sizeToFit), and fixes
@@ -224,7 +256,12 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
         }
     }
     else {
-        NSString *localizedText = localizationInfo.localizedText;
+        NSString *localizedText = [localizationInfo localizedTextInBundle:bundle];
+        if ([localizedText isEqualToString:self.text]) {
+            [self updateMissingLocalizationBackgroundWithLocalizationInfo:localizationInfo bundle:bundle];
+            return;
+        }
+        
         s_setText(self, @selector(setText:), localizedText);
         
         // See above
@@ -234,13 +271,18 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
         }
     }
     
+    [self updateMissingLocalizationBackgroundWithLocalizationInfo:localizationInfo bundle:bundle];
+}
+
+- (void)updateMissingLocalizationBackgroundWithLocalizationInfo:(HLSLabelLocalizationInfo *)localizationInfo bundle:(NSBundle *)bundle
+{
     // Restore the original background color if it had been altered
-    UIColor *originalBackgroundColor = hls_getAssociatedObject(self, s_originalBackgroundColorKey);
+    UIColor *originalBackgroundColor = HLSObjectStateForObject(self).originalBackgroundColor;
     s_setBackgroundColor(self, @selector(setBackgroundColor:), originalBackgroundColor);
     
     // Make labels with missing localizations visible (saving the original color first)
     if (s_missingLocalizationsVisible) {
-        if (localizationInfo.incomplete) {
+        if ([localizationInfo isIncompleteInBundle:bundle]) {
             // Using the original implementation here. We do not want to update the color stored in the information object
             s_setBackgroundColor(self, @selector(setBackgroundColor:), [UIColor yellowColor]);
         }
@@ -249,54 +291,138 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
 
 #pragma mark Notification callbacks
 
-- (void)currentLocalizationDidChange:(NSNotification *)notification
+/**
+ * Relocalize all labels in a single pass. Labels are grouped by bundle and table, so that each bundle is resolved
+ * once. Labels which are not displayed are only relocalized when they appear
+ */
++ (void)currentLocalizationDidChange:(NSNotification *)notification
 {
-    HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
-    if (localizationInfo.localized) {
-        [self localizeWithLocalizationInfo:localizationInfo];
+    NSMutableDictionary<NSArray *, NSMutableArray<UILabel *> *> *labelsByTable = [NSMutableDictionary dictionary];
+    for (UILabel *label in s_localizedLabels.allObjects) {
+        if (! label.window) {
+            [s_pendingLabels addObject:label];
+            continue;
+        }
+        
+        HLSLabelLocalizationInfo *localizationInfo = [label localizationInfo];
+        if (! localizationInfo.localized) {
+            continue;
+        }
+        
+        NSArray *tableKey = @[localizationInfo.bundleName ?: [NSNull null], localizationInfo.tableName ?: [NSNull null]];
+        NSMutableArray<UILabel *> *labels = labelsByTable[tableKey];
+        if (! labels) {
+            labels = [NSMutableArray array];
+            labelsByTable[tableKey] = labels;
+        }
+        [labels addObject:label];
     }
+    
+    // Commit all changes at once, without implicit animations
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    
+    [labelsByTable enumerateKeysAndObjectsUsingBlock:^(NSArray *tableKey, NSMutableArray<UILabel *> *labels, BOOL *stop) {
+        NSString *bundleName = [tableKey.firstObject isKindOfClass:[NSString class]] ? tableKey.firstObject : nil;
+        NSBundle *bundle = [NSBundle bundleWithName:bundleName];
+        for (UILabel *label in labels) {
+            [label localizeWithLocalizationInfo:[label localizationInfo] bundle:bundle];
+        }
+    }];
+    
+    [CATransaction commit];
 }
 
 @end
 
 @implementation UIView (HLSDynamicLocalizationPrivate)
 
+#pragma mark Class methods
+
++ (void)load
+{
+    HLSRegisterSwizzleSelector(self, @selector(didMoveToSuperview), swizzle_UIView_didMoveToSuperview, &s_UIView_didMoveToSuperview);
+}
+
 #pragma mark Accessors and mutators
 
 - (NSString *)locTable
 {
-    return hls_getAssociatedObject(self, s_localizationTableNameKey);
+    return HLSObjectStateForObject(self).locTable;
 }
 
 - (void)setLocTable:(NSString *)locTable
 {
-    hls_setAssociatedObject(self, s_localizationTableNameKey, locTable, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).locTable = locTable;
+    ++s_localizationSettingsGeneration;
 }
 
 - (NSString *)locBundle
 {
-    return hls_getAssociatedObject(self, s_localizationBundleNameKey);
+    return HLSObjectStateForObject(self).locBundle;
 }
 
 - (void)setLocBundle:(NSString *)locBundle
 {
-    hls_setAssociatedObject(self, s_localizationBundleNameKey, locBundle, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).locBundle = locBundle;
+    ++s_localizationSettingsGeneration;
+}
+
+// The nearest table and bundle names set on the view or its ancestors. Ancestors are only visited until one with
+// up-to-date settings is found, and their settings are cached on the way back
+- (HLSResolvedLocalizationSettings *)resolvedLocalizationSettings
+{
+    NSMutableArray<UIView *> *unresolvedViews = [NSMutableArray array];
+    HLSResolvedLocalizationSettings *settings = nil;
+    for (UIView *view = self; view; view = view.superview) {
+        HLSResolvedLocalizationSettings *viewSettings = HLSObjectStateForObject(view).resolvedLocalizationSettings;
+        if (viewSettings.generation == s_localizationSettingsGeneration) {
+            settings = viewSettings;
+            break;
+        }
+        [unresolvedViews addObject:view];
+    }
+    
+    for (UIView *view in [unresolvedViews reverseObjectEnumerator]) {
+        NSString *tableName = view.locTable.filled ? view.locTable : settings.tableName;
+        NSString *bundleName = view.locBundle.filled ? view.locBundle : settings.bundleName;
+        settings = [[HLSResolvedLocalizationSettings alloc] initWithTableName:tableName bundleName:bundleName];
+        HLSObjectStateCreateForObject(view).resolvedLocalizationSettings = settings;
+    }
+    
+    return settings;
 }
 
 @end
 
-#pragma mark Swizzled method implementations
+@implementation HLSResolvedLocalizationSettings
 
-// Marked as __unsafe_unretained to avoid ARC inserting incorrect memory management calls leading to crashes for -dealloc
-static void swizzle_dealloc(__unsafe_unretained UILabel *self, SEL _cmd)
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithTableName:(NSString *)tableName bundleName:(NSString *)bundleName
 {
-    [[NSNotificationCenter defaultCenter] removeObserver:self 
-                                                    name:HLSCurrentLocalizationDidChangeNotification 
-                                                  object:nil];
-    
-    s_dealloc(self, _cmd);
+    if (self = [super init]) {
+        _tableName = [tableName copy];
+        _bundleName = [bundleName copy];
+        _generation = s_localizationSettingsGeneration;
+    }
+    return self;
+}
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+
+- (instancetype)init
+{
+    return nil;
 }
 
+#pragma clang diagnostic pop
+
+@end
+
+#pragma mark Swizzled method implementations
+
 static void swizzle_awakeFromNib(UILabel *self, SEL _cmd)
 {
     s_awakeFromNib(self, _cmd);
@@ -305,6 +431,19 @@ static void swizzle_awakeFromNib(UILabel *self, SEL _cmd)
     [self setAndLocalizeAttributedText:self.attributedText text:self.text];
 }
 
+static void swizzle_didMoveToWindow(UILabel *self, SEL _cmd)
+{
+    s_didMoveToWindow(self, _cmd);
+    
+    // Labels which were not displayed when the localization changed
+    if (self.window && s_pendingLabels.count != 0 && [s_pendingLabels containsObject:self]) {
+        HLSLabelLocalizationInfo *localizationInfo = [self localizationInfo];
+        if (localizationInfo.localized) {
+            [self localizeWithLocalizationInfo:localizationInfo];
+        }
+    }
+}
+
 // Swizzled for UIButton support (!)
 static void swizzle_setText(UILabel *self, SEL _cmd, NSString *text)
 {
@@ -316,6 +455,18 @@ static void swizzle_setAttributedText(UILabel *self, SEL _cmd, NSAttributedStrin
     [self setAndLocalizeAttributedText:attributedText text:nil];
 }
 
+// Settings resolved for the view and its descendants might not be valid anymore. Since settings are resolved for
+// all ancestors of a view at once, descendants cannot have up-to-date settings if the view itself has none
+static void swizzle_UIView_didMoveToSuperview(UIView *self, SEL _cmd)
+{
+    s_UIView_didMoveToSuperview(self, _cmd);
+    
+    HLSResolvedLocalizationSettings *settings = HLSObjectStateForObject(self).resolvedLocalizationSettings;
+    if (settings.generation == s_localizationSettingsGeneration) {
+        ++s_localizationSettingsGeneration;
+    }
+}
+
 static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgroundColor)
 {
     s_setBackgroundColor(self, _cmd, backgroundColor);
@@ -323,5 +474,5 @@ static void swizzle_setBackgroundColor(UILabel *self, SEL _cmd, UIColor *backgro
     // The background color is stored as separate associated object, not in the HLSLabelLocalizationInfo object. The reason
     // is that the HLSLabelLocalizationInfo is only attached when the text is first set, while the background color is
     // usually set earlier (i.e. when this object is not available)
-    hls_setAssociatedObject(self, s_originalBackgroundColorKey, backgroundColor, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    HLSObjectStateCreateForObject(self).originalBackgroundColor = backgroundColor;
 }
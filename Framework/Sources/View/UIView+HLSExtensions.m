@@ -41,8 +41,8 @@ static void swizzle_didMoveToWindow(UIView *self, SEL _cmd);
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(becomeFirstResponder), swizzle_becomeFirstResponder, &s_becomeFirstResponder);
-    HLSSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
+    HLSRegisterSwizzleSelector(self, @selector(becomeFirstResponder), swizzle_becomeFirstResponder, &s_becomeFirstResponder);
+    HLSRegisterSwizzleSelector(self, @selector(didMoveToWindow), swizzle_didMoveToWindow, &s_didMoveToWindow);
 }
 
 #pragma mark Accessors and mutators
@@ -10,6 +10,7 @@
 #import "HLSContainerStackView.h"
 #import "HLSLayerAnimationStep.h"
 #import "HLSLogger.h"
+#import "HLSTracing.h"
 #import "NSArray+HLSExtensions.h"
 #import "UIViewController+HLSExtensions.h"
 
@@ -299,6 +300,8 @@ static NSString * const HLSContainerStackPopAnimationName = @"pop_animation";
 {
     NSParameterAssert(viewController);
     
+    HLSTraceInterval("HLSContainerStack.insert");
+    
     if (index > self.containerContents.count) {
         HLSLoggerError(@"Invalid index %@. Expected in [0;%@]", @(index), @(self.containerContents.count));
         return;
@@ -412,6 +415,8 @@ static NSString * const HLSContainerStackPopAnimationName = @"pop_animation";
 
 - (void)removeViewControllerAtIndex:(NSUInteger)index animated:(BOOL)animated
 {
+    HLSTraceInterval("HLSContainerStack.remove");
+    
     if (index >= self.containerContents.count) {
         HLSLoggerError(@"Invalid index %@. Expected in [0;%@]", @(index), @(self.containerContents.count - 1));
         return;
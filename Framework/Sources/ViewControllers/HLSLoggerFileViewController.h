@@ -0,0 +1,33 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerFileReader.h"
+#import "HLSTableViewController.h"
+
+#import <Foundation/Foundation.h>
+#import <UIKit/UIKit.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ * Display the lines of a log file, which are only read when displayed. Lines can be filtered by level and searched
+ */
+@interface HLSLoggerFileViewController : HLSTableViewController <UISearchBarDelegate>
+
+- (instancetype)initWithFileReader:(HLSLoggerFileReader *)fileReader NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@interface HLSLoggerFileViewController (UnavailableMethods)
+
+- (instancetype)initWithNibName:(nullable NSString *)nibNameOrNil bundle:(nullable NSBundle *)nibBundleOrNil NS_UNAVAILABLE;
+- (nullable instancetype)initWithCoder:(NSCoder *)aDecoder NS_UNAVAILABLE;
+- (instancetype)initWithBundle:(nullable NSBundle *)bundle NS_UNAVAILABLE;
+- (instancetype)init NS_UNAVAILABLE;
+
+@end
+
+NS_ASSUME_NONNULL_END
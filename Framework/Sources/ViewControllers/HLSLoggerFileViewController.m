@@ -0,0 +1,233 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerFileViewController.h"
+
+#import "NSBundle+HLSExtensions.h"
+
+static NSString * const HLSLoggerFileViewControllerCellIdentifier = @"LineCell";
+
+static const NSUInteger HLSLoggerFileViewControllerPageSize = 256;
+
+@interface HLSLoggerFileViewController ()
+
+@property (nonatomic) HLSLoggerFileReader *fileReader;
+
+@property (nonatomic) NSCache<NSNumber *, NSArray<NSString *> *> *pages;      // Lines read from the file, by page index
+@property (nonatomic) NSUInteger lineCount;                                    // Number of lines indexed so far
+
+@property (nonatomic) HLSLoggerLevel minimumLevel;
+@property (nonatomic, copy) NSString *searchString;
+@property (nonatomic) NSData *filteredLineIndexesData;                         // Indexes (NSUInteger) of the lines displayed when filtering
+@property (nonatomic) NSUInteger filterGeneration;                             // Identifies the latest filter
+
+@property (nonatomic) UISearchBar *searchBar;
+
+@end
+
+@implementation HLSLoggerFileViewController
+
+#pragma mark Object creation and destruction
+
+- (instancetype)initWithFileReader:(HLSLoggerFileReader *)fileReader
+{
+    NSParameterAssert(fileReader);
+
+    if (self = [super initWithBundle:[NSBundle coconutKitBundle]]) {
+        self.fileReader = fileReader;
+        self.pages = [[NSCache alloc] init];
+        self.minimumLevel = HLSLoggerLevelDebug;
+        self.title = fileReader.filePath.lastPathComponent;
+    }
+    return self;
+}
+
+#pragma mark View lifecycle
+
+- (void)loadView
+{
+    [super loadView];
+
+    self.searchBar = [[UISearchBar alloc] init];
+    self.searchBar.delegate = self;
+    self.searchBar.scopeButtonTitles = @[@"Debug", @"Info", @"Warn", @"Error", @"Fatal"];
+    self.searchBar.showsScopeBar = YES;
+    self.searchBar.autocapitalizationType = UITextAutocapitalizationTypeNone;
+    self.searchBar.autocorrectionType = UITextAutocorrectionTypeNo;
+    [self.searchBar sizeToFit];
+    self.tableView.tableHeaderView = self.searchBar;
+}
+
+- (void)viewDidLoad
+{
+    [super viewDidLoad];
+
+    // Lines have varying heights, which are only calculated when displayed
+    self.tableView.estimatedRowHeight = 30.f;
+    self.tableView.rowHeight = UITableViewAutomaticDimension;
+    self.tableView.keyboardDismissMode = UIScrollViewKeyboardDismissModeOnDrag;
+    [self.tableView registerClass:[UITableViewCell class] forCellReuseIdentifier:HLSLoggerFileViewControllerCellIdentifier];
+
+    __weak __typeof(self) weakSelf = self;
+    [self.fileReader indexWithProgressBlock:^(NSUInteger lineCount, BOOL finished) {
+        [weakSelf fileReaderDidIndexLineCount:lineCount finished:finished];
+    }];
+    self.lineCount = self.fileReader.lineCount;
+}
+
+#pragma mark Localization
+
+- (void)localize
+{
+    [super localize];
+
+    self.searchBar.placeholder = CoconutKitLocalizedString(@"Search", nil);
+}
+
+#pragma mark Lines
+
+- (BOOL)isFiltering
+{
+    return self.minimumLevel != HLSLoggerLevelDebug || self.searchString.length != 0;
+}
+
+- (NSUInteger)lineIndexForRow:(NSInteger)row
+{
+    if (self.filteredLineIndexesData) {
+        const NSUInteger *lineIndexes = self.filteredLineIndexesData.bytes;
+        return lineIndexes[row];
+    }
+    else {
+        return (NSUInteger)row;
+    }
+}
+
+- (NSString *)lineAtIndex:(NSUInteger)lineIndex
+{
+    // Lines are read by pages. Incomplete pages (at the end of the indexed lines) are not cached
+    NSUInteger pageIndex = lineIndex / HLSLoggerFileViewControllerPageSize;
+    NSArray<NSString *> *page = [self.pages objectForKey:@(pageIndex)];
+    if (! page) {
+        page = [self.fileReader linesInRange:NSMakeRange(pageIndex * HLSLoggerFileViewControllerPageSize, HLSLoggerFileViewControllerPageSize)];
+        if (page.count == HLSLoggerFileViewControllerPageSize || self.fileReader.indexed) {
+            [self.pages setObject:page forKey:@(pageIndex)];
+        }
+    }
+
+    NSUInteger indexInPage = lineIndex % HLSLoggerFileViewControllerPageSize;
+    return (indexInPage < page.count) ? page[indexInPage] : @"";
+}
+
+- (void)fileReaderDidIndexLineCount:(NSUInteger)lineCount finished:(BOOL)finished
+{
+    self.lineCount = lineCount;
+
+    if ([self isFiltering]) {
+        if (finished) {
+            [self updateFilter];
+        }
+    }
+    else {
+        [self.tableView reloadData];
+    }
+}
+
+- (void)updateFilter
+{
+    NSUInteger filterGeneration = ++self.filterGeneration;
+
+    if (! [self isFiltering]) {
+        self.filteredLineIndexesData = nil;
+        [self.tableView reloadData];
+        return;
+    }
+
+    // Filter in the background. Results of outdated filters are discarded
+    HLSLoggerFileReader *fileReader = self.fileReader;
+    HLSLoggerLevel minimumLevel = self.minimumLevel;
+    NSString *searchString = self.searchString;
+    __weak __typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSIndexSet *lineIndexes = [fileReader indexesOfLinesWithMinimumLevel:minimumLevel containingString:searchString];
+        NSMutableData *lineIndexesData = [NSMutableData dataWithLength:lineIndexes.count * sizeof(NSUInteger)];
+        [lineIndexes getIndexes:lineIndexesData.mutableBytes maxCount:lineIndexes.count inIndexRange:NULL];
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __typeof(self) strongSelf = weakSelf;
+            if (! strongSelf || strongSelf.filterGeneration != filterGeneration) {
+                return;
+            }
+
+            strongSelf.filteredLineIndexesData = lineIndexesData;
+            [strongSelf.tableView reloadData];
+        });
+    });
+}
+
+#pragma mark UISearchBarDelegate protocol implementation
+
+- (void)searchBar:(UISearchBar *)searchBar textDidChange:(NSString *)searchText
+{
+    self.searchString = searchText;
+    [self updateFilter];
+}
+
+- (void)searchBar:(UISearchBar *)searchBar selectedScopeButtonIndexDidChange:(NSInteger)selectedScope
+{
+    self.minimumLevel = HLSLoggerLevelDebug + selectedScope;
+    [self updateFilter];
+}
+
+- (void)searchBarSearchButtonClicked:(UISearchBar *)searchBar
+{
+    [searchBar resignFirstResponder];
+}
+
+#pragma mark UITableViewDataSource protocol implementation
+
+- (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
+{
+    if (self.filteredLineIndexesData) {
+        return self.filteredLineIndexesData.length / sizeof(NSUInteger);
+    }
+    else {
+        return self.lineCount;
+    }
+}
+
+- (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
+{
+    UITableViewCell *cell = [tableView dequeueReusableCellWithIdentifier:HLSLoggerFileViewControllerCellIdentifier forIndexPath:indexPath];
+    cell.selectionStyle = UITableViewCellSelectionStyleNone;
+    cell.textLabel.font = [UIFont fontWithName:@"Menlo" size:11.f];
+    cell.textLabel.numberOfLines = 0;
+
+    NSUInteger lineIndex = [self lineIndexForRow:indexPath.row];
+    cell.textLabel.text = [self lineAtIndex:lineIndex];
+
+    // Same colors as in the console
+    switch ([self.fileReader levelOfLineAtIndex:lineIndex]) {
+        case HLSLoggerLevelWarn: {
+            cell.textLabel.textColor = [UIColor colorWithRed:1.f green:120.f / 255.f blue:0.f alpha:1.f];
+            break;
+        }
+
+        case HLSLoggerLevelError:
+        case HLSLoggerLevelFatal: {
+            cell.textLabel.textColor = [UIColor redColor];
+            break;
+        }
+
+        default: {
+            cell.textLabel.textColor = [UIColor blackColor];
+            break;
+        }
+    }
+
+    return cell;
+}
+
+@end
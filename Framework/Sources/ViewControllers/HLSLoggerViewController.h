@@ -8,12 +8,11 @@
 #import "HLSViewController.h"
 
 #import <Foundation/Foundation.h>
-#import <QuickLook/QuickLook.h>
 #import <UIKit/UIKit.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface HLSLoggerViewController : HLSViewController <QLPreviewControllerDataSource, UITableViewDataSource, UITableViewDelegate>
+@interface HLSLoggerViewController : HLSViewController <UITableViewDataSource, UITableViewDelegate>
 
 - (instancetype)initWithLogger:(HLSLogger *)logger NS_DESIGNATED_INITIALIZER;
 
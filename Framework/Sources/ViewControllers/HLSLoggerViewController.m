@@ -8,7 +8,7 @@
 
 #import "HLSLogger.h"
 #import "HLSLogger+Friend.h"
-#import "HLSPreviewItem.h"
+#import "HLSLoggerFileViewController.h"
 #import "HLSTableViewCell.h"
 #import "NSBundle+HLSExtensions.h"
 
@@ -17,13 +17,13 @@
 @property (nonatomic) HLSLogger *logger;
 
 @property (nonatomic) NSArray<NSString *> *logFilePaths;
+@property (nonatomic, copy) NSString *convertedLogFilePath;            // Log file being converted into a text file, if any
+@property (nonatomic, copy) NSString *textFilePath;                    // Temporary text file currently displayed, if any
 
 @property (nonatomic, weak) IBOutlet UISegmentedControl *levelSegmentedControl;
 @property (nonatomic, weak) IBOutlet UISwitch *enabledSwitch;
 @property (nonatomic, weak) IBOutlet UITableView *tableView;
 
-@property (nonatomic) NSURL *currentLogFileURL;
-
 @end
 
 @implementation HLSLoggerViewController
@@ -41,6 +41,11 @@
     return self;
 }
 
+- (void)dealloc
+{
+    [self removeTextFile];
+}
+
 #pragma mark View lifecycle
 
 - (void)viewDidLoad
@@ -64,6 +69,14 @@
     [self reloadData];
 }
 
+- (void)viewWillAppear:(BOOL)animated
+{
+    [super viewWillAppear:animated];
+    
+    // The temporary text file is not needed anymore when returning from the file viewer
+    [self removeTextFile];
+}
+
 #pragma mark Reloading the screen
 
 - (void)reloadData
@@ -73,16 +86,54 @@
     [self.tableView reloadData];
 }
 
-#pragma mark QLPreviewControllerDataSource protocol implementation
+#pragma mark Log files
 
-- (NSInteger)numberOfPreviewItemsInPreviewController:(QLPreviewController *)controller
+- (BOOL)writeLinesOfLogFileAtPath:(NSString *)logFilePath toTextFileAtPath:(NSString *)textFilePath error:(NSError *__autoreleasing *)pError
 {
-    return 1;
+    if (! [[NSFileManager defaultManager] createFileAtPath:textFilePath contents:nil attributes:nil]) {
+        if (pError) {
+            *pError = [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:@{ NSFilePathErrorKey : textFilePath }];
+        }
+        return NO;
+    }
+    
+    // Lines are streamed to the text file in chunks
+    NSFileHandle *textFileHandle = [NSFileHandle fileHandleForWritingAtPath:textFilePath];
+    NSMutableData *chunkData = [NSMutableData data];
+    BOOL success = [self.logger enumerateLinesOfLogFileAtPath:logFilePath error:pError usingBlock:^(NSString *line, BOOL *pStop) {
+        [chunkData appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+        [chunkData appendBytes:"\n" length:1];
+        if (chunkData.length >= 64 * 1024) {
+            [textFileHandle writeData:chunkData];
+            chunkData.length = 0;
+        }
+    }];
+    [textFileHandle writeData:chunkData];
+    [textFileHandle closeFile];
+    return success;
 }
 
-- (id<QLPreviewItem>)previewController:(QLPreviewController *)controller previewItemAtIndex:(NSInteger)index
+- (void)removeTextFile
 {
-    return [[HLSPreviewItem alloc] initWithPreviewItemURL:self.currentLogFileURL];
+    if (! self.textFilePath) {
+        return;
+    }
+    
+    [[NSFileManager defaultManager] removeItemAtPath:self.textFilePath error:NULL];
+    self.textFilePath = nil;
+}
+
+- (void)displayLogFileAtPath:(NSString *)logFilePath
+{
+    // Lines are only read when displayed
+    HLSLoggerFileReader *fileReader = [[HLSLoggerFileReader alloc] initWithFilePath:logFilePath];
+    if (! fileReader) {
+        HLSLoggerError(@"Could not open log file %@", logFilePath);
+        return;
+    }
+    
+    HLSLoggerFileViewController *fileViewController = [[HLSLoggerFileViewController alloc] initWithFileReader:fileReader];
+    [self.navigationController pushViewController:fileViewController animated:YES];
 }
 
 #pragma mark UITableViewDataSource protocol implementation
@@ -101,17 +152,72 @@
 
 - (void)tableView:(UITableView *)tableView willDisplayCell:(UITableViewCell *)cell forRowAtIndexPath:(NSIndexPath *)indexPath
 {
-    cell.textLabel.text = self.logFilePaths[indexPath.row].lastPathComponent;
+    NSString *logFilePath = self.logFilePaths[indexPath.row];
+    cell.textLabel.text = logFilePath.lastPathComponent;
+    
+    // Display progress while the file is being converted
+    if ([logFilePath isEqualToString:self.convertedLogFilePath]) {
+        UIActivityIndicatorView *activityIndicatorView = [[UIActivityIndicatorView alloc] initWithActivityIndicatorStyle:UIActivityIndicatorViewStyleGray];
+        [activityIndicatorView startAnimating];
+        cell.accessoryView = activityIndicatorView;
+    }
+    else {
+        cell.accessoryView = nil;
+    }
+}
+
+- (NSIndexPath *)tableView:(UITableView *)tableView willSelectRowAtIndexPath:(NSIndexPath *)indexPath
+{
+    // Ignore selections while a file is being converted
+    return self.convertedLogFilePath ? nil : indexPath;
 }
 
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
     [tableView deselectRowAtIndexPath:indexPath animated:YES];
     
-    self.currentLogFileURL = [NSURL fileURLWithPath:self.logFilePaths[indexPath.row]];
-    QLPreviewController *previewController = [[QLPreviewController alloc] init];
-    previewController.dataSource = self;
-    [self.navigationController pushViewController:previewController animated:YES];
+    NSString *logFilePath = self.logFilePaths[indexPath.row];
+    if ([logFilePath.pathExtension isEqualToString:@"txt"]) {
+        [self.logger flush];
+        [self displayLogFileAtPath:logFilePath];
+        return;
+    }
+    
+    // Binary and compressed log files are converted into temporary text files first, in the background
+    NSString *textFileName = [[logFilePath.lastPathComponent stringByReplacingOccurrencesOfString:@"." withString:@"-"] stringByAppendingPathExtension:@"txt"];
+    NSString *textFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:textFileName];
+    
+    self.convertedLogFilePath = logFilePath;
+    [tableView reloadRowsAtIndexPaths:@[indexPath] withRowAnimation:UITableViewRowAnimationNone];
+    
+    __weak __typeof(self) weakSelf = self;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        NSError *error = nil;
+        BOOL success = [weakSelf writeLinesOfLogFileAtPath:logFilePath toTextFileAtPath:textFilePath error:&error];
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            __typeof(self) strongSelf = weakSelf;
+            if (! strongSelf || ! [strongSelf.convertedLogFilePath isEqualToString:logFilePath]) {
+                [[NSFileManager defaultManager] removeItemAtPath:textFilePath error:NULL];
+                return;
+            }
+            
+            strongSelf.convertedLogFilePath = nil;
+            [strongSelf.tableView reloadData];
+            
+            if (! success) {
+                HLSLoggerError(@"Could not read log file %@. Reason: %@", logFilePath, error);
+                [[NSFileManager defaultManager] removeItemAtPath:textFilePath error:NULL];
+                return;
+            }
+            
+            if (! [strongSelf.textFilePath isEqualToString:textFilePath]) {
+                [strongSelf removeTextFile];
+            }
+            strongSelf.textFilePath = textFilePath;
+            [strongSelf displayLogFileAtPath:textFilePath];
+        });
+    });
 }
 
 #pragma mark Action callbacks
@@ -128,12 +234,15 @@
 
 - (IBAction)clearLogs:(id)sender
 {
+    self.convertedLogFilePath = nil;
     [self.logger clearLogs];
     [self reloadData];
 }
 
 - (void)close:(id)sender
 {
+    self.convertedLogFilePath = nil;
+    [self removeTextFile];
     [self dismissViewControllerAnimated:YES completion:nil];
 }
 
@@ -28,9 +28,9 @@ static UIStatusBarStyle swizzle_preferredStatusBarStyle(UINavigationController *
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(shouldAutorotate), swizzle_shouldAutorotate, &s_shouldAutorotate);
-    HLSSwizzleSelector(self, @selector(supportedInterfaceOrientations), swizzle_supportedInterfaceOrientations, &s_supportedInterfaceOrientations);
-    HLSSwizzleSelector(self, @selector(preferredStatusBarStyle), swizzle_preferredStatusBarStyle, &s_preferredStatusBarStyle);
+    HLSRegisterSwizzleSelector(self, @selector(shouldAutorotate), swizzle_shouldAutorotate, &s_shouldAutorotate);
+    HLSRegisterSwizzleSelector(self, @selector(supportedInterfaceOrientations), swizzle_supportedInterfaceOrientations, &s_supportedInterfaceOrientations);
+    HLSRegisterSwizzleSelector(self, @selector(preferredStatusBarStyle), swizzle_preferredStatusBarStyle, &s_preferredStatusBarStyle);
 }
 
 #pragma mark Accessors and mutators
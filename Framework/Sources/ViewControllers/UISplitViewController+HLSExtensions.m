@@ -26,8 +26,8 @@ static NSUInteger swizzle_supportedInterfaceOrientations(UISplitViewController *
 + (void)load
 {
     // No swizzling occurs on iOS < 6 since those two methods do not exist
-    HLSSwizzleSelector(self, @selector(shouldAutorotate), swizzle_shouldAutorotate, &s_shouldAutorotate);
-    HLSSwizzleSelector(self, @selector(supportedInterfaceOrientations), swizzle_supportedInterfaceOrientations, &s_supportedInterfaceOrientations);
+    HLSRegisterSwizzleSelector(self, @selector(shouldAutorotate), swizzle_shouldAutorotate, &s_shouldAutorotate);
+    HLSRegisterSwizzleSelector(self, @selector(supportedInterfaceOrientations), swizzle_supportedInterfaceOrientations, &s_supportedInterfaceOrientations);
 }
 
 #pragma mark Accessors and mutators
@@ -125,13 +125,13 @@ static void swizzle_viewDidDisappear(UIViewController *self, SEL _cmd, BOOL anim
 
 + (void)load
 {
-    HLSSwizzleSelector(self, @selector(initWithNibName:bundle:), swizzle_initWithNibName_bundle, &s_initWithNibName_bundle);
-    HLSSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
-    HLSSwizzleSelector(self, @selector(viewDidLoad), swizzle_viewDidLoad, &s_viewDidLoad);
-    HLSSwizzleSelector(self, @selector(viewWillAppear:), swizzle_viewWillAppear, &s_viewWillAppear);
-    HLSSwizzleSelector(self, @selector(viewDidAppear:), swizzle_viewDidAppear, &s_viewDidAppear);
-    HLSSwizzleSelector(self, @selector(viewWillDisappear:), swizzle_viewWillDisappear, &s_viewWillDisappear);
-    HLSSwizzleSelector(self, @selector(viewDidDisappear:), swizzle_viewDidDisappear, &s_viewDidDisappear);
+    HLSRegisterSwizzleSelector(self, @selector(initWithNibName:bundle:), swizzle_initWithNibName_bundle, &s_initWithNibName_bundle);
+    HLSRegisterSwizzleSelector(self, @selector(initWithCoder:), swizzle_initWithCoder, &s_initWithCoder);
+    HLSRegisterSwizzleSelector(self, @selector(viewDidLoad), swizzle_viewDidLoad, &s_viewDidLoad);
+    HLSRegisterSwizzleSelector(self, @selector(viewWillAppear:), swizzle_viewWillAppear, &s_viewWillAppear);
+    HLSRegisterSwizzleSelector(self, @selector(viewDidAppear:), swizzle_viewDidAppear, &s_viewDidAppear);
+    HLSRegisterSwizzleSelector(self, @selector(viewWillDisappear:), swizzle_viewWillDisappear, &s_viewWillDisappear);
+    HLSRegisterSwizzleSelector(self, @selector(viewDidDisappear:), swizzle_viewDidDisappear, &s_viewDidDisappear);
 }
 
 #pragma mark Object creation and destruction
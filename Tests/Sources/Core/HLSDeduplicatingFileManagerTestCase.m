@@ -0,0 +1,227 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManagerTestCase.h"
+
+@interface HLSDeduplicatingFileManagerTestCase : HLSFileManagerTestCase
+@end
+
+@implementation HLSDeduplicatingFileManagerTestCase
+
+#pragma mark Class methods
+
++ (NSString *)rootFolderPath
+{
+    return [HLSApplicationTemporaryDirectoryPath() stringByAppendingPathComponent:@"deduplicatingFileManagerTests"];
+}
+
++ (HLSDeduplicatingFileManager *)deduplicatingFileManager
+{
+    HLSStandardFileManager *blobFileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:[HLSDeduplicatingFileManagerTestCase rootFolderPath]];
+    return [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:blobFileManager];
+}
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *rootFolderPath = [HLSDeduplicatingFileManagerTestCase rootFolderPath];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:rootFolderPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:rootFolderPath error:NULL];
+    }
+    [[NSFileManager defaultManager] createDirectoryAtPath:rootFolderPath withIntermediateDirectories:YES attributes:nil error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testCreationAndRemoval
+{
+    [self testCreationAndRemovalWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testContentsAndExistence
+{
+    [self testContentsAndExistenceWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testCopy
+{
+    [self testCopyWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testMove
+{
+    [self testMoveWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testEnumeration
+{
+    [self testEnumerationWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testRanges
+{
+    [self testRangesWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testStreams
+{
+    [self testStreamsWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testURLs
+{
+    [self testURLsWithFileManager:[HLSDeduplicatingFileManagerTestCase deduplicatingFileManager]];
+}
+
+- (void)testCreationAndRemovalWithInMemoryBlobs
+{
+    HLSDeduplicatingFileManager *fileManager = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:[[HLSInMemoryFileManager alloc] init]];
+    [self testCreationAndRemovalWithFileManager:fileManager];
+}
+
+- (void)testCopyWithInMemoryBlobs
+{
+    HLSDeduplicatingFileManager *fileManager = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:[[HLSInMemoryFileManager alloc] init]];
+    [self testCopyWithFileManager:fileManager];
+}
+
+- (void)testDeduplication
+{
+    HLSDeduplicatingFileManager *fileManager = [HLSDeduplicatingFileManagerTestCase deduplicatingFileManager];
+
+    NSData *data1 = [@"data1" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data2 = [@"data2" dataUsingEncoding:NSUTF8StringEncoding];
+
+    // Identical contents are stored once
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/folder" withIntermediateDirectories:YES error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/file1.txt" contents:data1 error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder/file1.txt" contents:data1 error:NULL]);
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)1);
+    XCTAssertEqual(fileManager.blobByteCount, (unsigned long long)data1.length);
+
+    // Copies do not store anything
+    XCTAssertTrue([fileManager copyItemAtPath:@"/folder" toPath:@"/folderCopy" error:NULL]);
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)1);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folderCopy/file1.txt" error:NULL], data1);
+
+    // Overwriting a file only affects the file itself
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder/file1.txt" contents:data2 error:NULL]);
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)2);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folder/file1.txt" error:NULL], data2);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folderCopy/file1.txt" error:NULL], data1);
+
+    // Rewriting the same contents keeps the blob
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder/file1.txt" contents:data2 error:NULL]);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folder/file1.txt" error:NULL], data2);
+
+    // Blobs are removed when not referenced anymore
+    XCTAssertTrue([fileManager removeItemAtPath:@"/folder" error:NULL]);
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)1);
+    XCTAssertTrue([fileManager removeItemAtPath:@"/" error:NULL]);
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)0);
+    XCTAssertEqual(fileManager.blobByteCount, (unsigned long long)0);
+    XCTAssertEqual([fileManager.blobFileManager contentsOfDirectoryAtPath:@"/Blobs" error:NULL].count, (NSUInteger)0);
+}
+
+- (void)testConcurrentOverwriteAndRead
+{
+    HLSDeduplicatingFileManager *fileManager = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:[[HLSInMemoryFileManager alloc] init]];
+
+    NSData *data1 = [@"data1" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *data2 = [@"data2" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/file.txt" contents:data1 error:NULL]);
+
+    // Blobs being read must not be removed by concurrent overwrites
+    __block NSUInteger failureCount = 0;
+    NSObject *failureCountLock = [[NSObject alloc] init];
+    dispatch_apply(2000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        if (i % 2 == 0) {
+            [fileManager createFileAtPath:@"/file.txt" contents:(i % 4 == 0) ? data2 : data1 error:NULL];
+        }
+        else {
+            NSData *contents = (i % 3 == 0) ? [fileManager contentsOfFileAtPath:@"/file.txt" error:NULL]
+                : [fileManager contentsOfFileAtPath:@"/file.txt" range:NSMakeRange(0, data1.length) error:NULL];
+            if (! [contents isEqualToData:data1] && ! [contents isEqualToData:data2]) {
+                @synchronized(failureCountLock) {
+                    ++failureCount;
+                }
+            }
+        }
+    });
+    XCTAssertEqual(failureCount, (NSUInteger)0);
+
+    // Pinned blobs are released once reads are complete
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)1);
+
+    // Streams keep their blob alive until they are released
+    @autoreleasepool {
+        NSInputStream *inputStream = [fileManager inputStreamWithFileAtPath:@"/file.txt"];
+        NSData *contents = [fileManager contentsOfFileAtPath:@"/file.txt" error:NULL];
+        XCTAssertTrue([fileManager removeItemAtPath:@"/file.txt" error:NULL]);
+        XCTAssertEqual(fileManager.blobCount, (NSUInteger)1);
+
+        [inputStream open];
+        uint8_t buffer[16];
+        NSInteger length = [inputStream read:buffer maxLength:sizeof(buffer)];
+        [inputStream close];
+        XCTAssertEqualObjects([NSData dataWithBytes:buffer length:MAX(length, 0)], contents);
+    }
+    XCTAssertEqual(fileManager.blobCount, (NSUInteger)0);
+}
+
+- (void)testPersistence
+{
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+
+    HLSDeduplicatingFileManager *fileManager1 = [HLSDeduplicatingFileManagerTestCase deduplicatingFileManager];
+    XCTAssertTrue([fileManager1 createDirectoryAtPath:@"/folder/subfolder" withIntermediateDirectories:YES error:NULL]);
+    XCTAssertTrue([fileManager1 createFileAtPath:@"/folder/file.txt" contents:data error:NULL]);
+    XCTAssertTrue([fileManager1 copyItemAtPath:@"/folder/file.txt" toPath:@"/file.txt" error:NULL]);
+    [fileManager1 synchronize];
+
+    // A new file manager on the same blobs restores the hierarchy
+    HLSDeduplicatingFileManager *fileManager2 = [HLSDeduplicatingFileManagerTestCase deduplicatingFileManager];
+    BOOL isDirectory = NO;
+    XCTAssertTrue([fileManager2 fileExistsAtPath:@"/folder/subfolder" isDirectory:&isDirectory]);
+    XCTAssertTrue(isDirectory);
+    XCTAssertEqualObjects([fileManager2 contentsOfFileAtPath:@"/folder/file.txt" error:NULL], data);
+    XCTAssertEqualObjects([fileManager2 contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+    XCTAssertEqual(fileManager2.blobCount, (NSUInteger)1);
+
+    // Blobs stored after the index was last saved are discarded
+    HLSStandardFileManager *blobFileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:[HLSDeduplicatingFileManagerTestCase rootFolderPath]];
+    XCTAssertTrue([blobFileManager createFileAtPath:@"/Blobs/orphan" contents:data error:NULL]);
+
+    HLSDeduplicatingFileManager *fileManager3 = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:blobFileManager];
+    XCTAssertEqual(fileManager3.blobCount, (NSUInteger)1);
+    XCTAssertFalse([blobFileManager fileExistsAtPath:@"/Blobs/orphan"]);
+}
+
+- (void)testCorruptIndex
+{
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+
+    HLSStandardFileManager *blobFileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:[HLSDeduplicatingFileManagerTestCase rootFolderPath]];
+    HLSDeduplicatingFileManager *fileManager1 = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:blobFileManager];
+    XCTAssertTrue([fileManager1 createFileAtPath:@"/file.txt" contents:data error:NULL]);
+    [fileManager1 synchronize];
+
+    // An index whose entries have unexpected types is discarded, as well as the blobs it references
+    NSDictionary *index = @{ @"directories" : @[ @"/folder" ],
+                             @"files" : @{ @"/file.txt" : @12 },
+                             @"blobs" : @[] };
+    NSData *indexData = [NSPropertyListSerialization dataWithPropertyList:index format:NSPropertyListBinaryFormat_v1_0 options:0 error:NULL];
+    XCTAssertTrue([blobFileManager createFileAtPath:@"/Index.plist" contents:indexData error:NULL]);
+
+    HLSDeduplicatingFileManager *fileManager2 = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:blobFileManager];
+    XCTAssertFalse([fileManager2 fileExistsAtPath:@"/file.txt"]);
+    XCTAssertFalse([fileManager2 fileExistsAtPath:@"/folder"]);
+    XCTAssertEqual(fileManager2.blobCount, (NSUInteger)0);
+    XCTAssertEqual([blobFileManager contentsOfDirectoryAtPath:@"/Blobs" error:NULL].count, (NSUInteger)0);
+}
+
+@end
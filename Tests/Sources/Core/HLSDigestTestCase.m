@@ -0,0 +1,106 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoconutKit/CoconutKit.h>
+#import <XCTest/XCTest.h>
+
+@interface HLSDigestTestCase : XCTestCase
+@end
+
+@implementation HLSDigestTestCase
+
+#pragma mark Tests
+
+- (void)testHexadecimalString
+{
+    const uint8_t bytes[] = { 0x00, 0x01, 0x7f, 0x80, 0xab, 0xff };
+    XCTAssertEqualObjects(HLSHexadecimalStringFromBytes(bytes, sizeof(bytes)), @"00017f80abff");
+    XCTAssertEqualObjects(HLSHexadecimalStringFromBytes(bytes, 0), @"");
+}
+
+- (void)testIncrementalDigest
+{
+    NSData *data = [@"Hello, World!" dataUsingEncoding:NSUTF8StringEncoding];
+
+    // Same results as the one-shot digests, whatever the way data is fed
+    HLSDigest *digest = [[HLSDigest alloc] initWithAlgorithm:HLSDigestAlgorithmSHA256];
+    [digest updateWithBytes:data.bytes length:5];
+    XCTAssertEqualObjects(digest.hexadecimalDigest, [data subdataWithRange:NSMakeRange(0, 5)].sha256hash);
+
+    [digest updateWithData:[data subdataWithRange:NSMakeRange(5, data.length - 5)]];
+    XCTAssertEqualObjects(digest.hexadecimalDigest, @"dffd6021bb2bd5b0af676290809ec3a53191dd81c7f70a4b28688a362182986f");
+    XCTAssertEqual(digest.digest.length, (NSUInteger)32);
+
+    for (HLSDigestAlgorithm algorithm = HLSDigestAlgorithmEnumBegin; algorithm < HLSDigestAlgorithmEnumEnd; ++algorithm) {
+        HLSDigest *algorithmDigest = [[HLSDigest alloc] initWithAlgorithm:algorithm];
+        for (NSUInteger i = 0; i < data.length; ++i) {
+            [algorithmDigest updateWithBytes:(const uint8_t *)data.bytes + i length:1];
+        }
+
+        HLSDigest *referenceDigest = [[HLSDigest alloc] initWithAlgorithm:algorithm];
+        [referenceDigest updateWithData:data];
+        XCTAssertEqualObjects(algorithmDigest.digest, referenceDigest.digest);
+    }
+}
+
+- (void)testStreamDigest
+{
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024 + 17];
+    arc4random_buf(data.mutableBytes, data.length);
+
+    NSInputStream *inputStream = [NSInputStream inputStreamWithData:data];
+    XCTAssertEqualObjects([HLSDigest hexadecimalDigestForInputStream:inputStream algorithm:HLSDigestAlgorithmSHA1 error:NULL], data.sha1hash);
+    XCTAssertEqual(inputStream.streamStatus, NSStreamStatusClosed);
+}
+
+- (void)testFileDigest
+{
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024 + 17];
+    arc4random_buf(data.mutableBytes, data.length);
+
+    // Directly and through another file manager
+    HLSInMemoryFileManager *inMemoryFileManager = [[HLSInMemoryFileManager alloc] init];
+    XCTAssertTrue([inMemoryFileManager createFileAtPath:@"/file.bin" contents:data error:NULL]);
+    XCTAssertEqualObjects([HLSDigest hexadecimalDigestForFileAtPath:@"/file.bin" inFileManager:inMemoryFileManager algorithm:HLSDigestAlgorithmMD5 error:NULL], data.md5hash);
+
+    HLSDeduplicatingFileManager *deduplicatingFileManager = [[HLSDeduplicatingFileManager alloc] initWithBlobFileManager:inMemoryFileManager];
+    XCTAssertTrue([deduplicatingFileManager createFileAtPath:@"/file.bin" contents:data error:NULL]);
+    XCTAssertEqualObjects([HLSDigest hexadecimalDigestForFileAtPath:@"/file.bin" inFileManager:deduplicatingFileManager algorithm:HLSDigestAlgorithmMD5 error:NULL], data.md5hash);
+
+    // Missing file
+    NSError *error = nil;
+    XCTAssertNil([HLSDigest hexadecimalDigestForFileAtPath:@"/invalid.bin" inFileManager:inMemoryFileManager algorithm:HLSDigestAlgorithmMD5 error:&error]);
+    XCTAssertNotNil(error);
+}
+
+#pragma mark Benchmarks
+
+- (void)testHexadecimalStringPerformance
+{
+    NSMutableData *data = [NSMutableData dataWithLength:64];
+    arc4random_buf(data.mutableBytes, data.length);
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            @autoreleasepool {
+                HLSHexadecimalStringFromBytes(data.bytes, data.length);
+            }
+        }
+    }];
+}
+
+- (void)testStreamDigestPerformance
+{
+    NSMutableData *data = [NSMutableData dataWithLength:64 * 1024 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+
+    [self measureBlock:^{
+        NSInputStream *inputStream = [NSInputStream inputStreamWithData:data];
+        [HLSDigest hexadecimalDigestForInputStream:inputStream algorithm:HLSDigestAlgorithmSHA256 error:NULL];
+    }];
+}
+
+@end
@@ -15,6 +15,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)testContentsAndExistenceWithFileManager:(HLSFileManager *)fileManager;
 - (void)testCopyWithFileManager:(HLSFileManager *)fileManager;
 - (void)testMoveWithFileManager:(HLSFileManager *)fileManager;
+- (void)testEnumerationWithFileManager:(HLSFileManager *)fileManager;
+- (void)testRangesWithFileManager:(HLSFileManager *)fileManager;
 - (void)testStreamsWithFileManager:(HLSFileManager *)fileManager;
 - (void)testURLsWithFileManager:(HLSFileManager *)fileManager;
 
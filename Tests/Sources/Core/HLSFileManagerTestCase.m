@@ -391,6 +391,119 @@
     XCTAssertNotNil(error11);
 }
 
+- (void)testEnumerationWithFileManager:(HLSFileManager *)fileManager
+{
+    NSParameterAssert(fileManager);
+    
+    // Create test hierarchy
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/folder1/folder11" withIntermediateDirectories:YES error:NULL]);
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/folder2" withIntermediateDirectories:YES error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/file1.txt" contents:[@"1" dataUsingEncoding:NSUTF8StringEncoding] error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder1/file11.txt" contents:[@"11" dataUsingEncoding:NSUTF8StringEncoding] error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder1/folder11/file111.txt" contents:[@"111" dataUsingEncoding:NSUTF8StringEncoding] error:NULL]);
+    
+    // Recursive enumeration. Must return all items with their attributes, directories before their contents
+    NSMutableDictionary<NSString *, HLSFileItem *> *items1 = [NSMutableDictionary dictionary];
+    NSMutableArray<NSString *> *paths1 = [NSMutableArray array];
+    NSError *error1 = nil;
+    XCTAssertTrue([fileManager enumerateItemsAtPath:@"/" maximumDepth:0 error:&error1 usingBlock:^(HLSFileItem *item, BOOL *pStop) {
+        items1[item.path] = item;
+        [paths1 addObject:item.path];
+    }]);
+    XCTAssertNil(error1);
+    XCTAssertEqualObjects([NSSet setWithArray:items1.allKeys], ([NSSet setWithObjects:@"/folder1", @"/folder1/folder11", @"/folder2", @"/file1.txt", @"/folder1/file11.txt", @"/folder1/folder11/file111.txt", nil]));
+    XCTAssertEqual(paths1.count, 6);
+    XCTAssertTrue([paths1 indexOfObject:@"/folder1"] < [paths1 indexOfObject:@"/folder1/folder11"]);
+    XCTAssertTrue([paths1 indexOfObject:@"/folder1/folder11"] < [paths1 indexOfObject:@"/folder1/folder11/file111.txt"]);
+    
+    XCTAssertTrue(items1[@"/folder1"].directory);
+    XCTAssertEqual(items1[@"/folder1"].depth, 1);
+    XCTAssertEqualObjects(items1[@"/folder1/folder11"].name, @"folder11");
+    XCTAssertEqual(items1[@"/folder1/folder11"].depth, 2);
+    XCTAssertFalse(items1[@"/file1.txt"].directory);
+    XCTAssertEqual(items1[@"/file1.txt"].size, 1);
+    XCTAssertEqual(items1[@"/folder1/file11.txt"].size, 2);
+    XCTAssertEqual(items1[@"/folder1/folder11/file111.txt"].size, 3);
+    XCTAssertEqual(items1[@"/folder1/folder11/file111.txt"].depth, 3);
+    
+    // Enumeration limited to direct contents
+    NSMutableSet<NSString *> *paths2 = [NSMutableSet set];
+    XCTAssertTrue([fileManager enumerateItemsAtPath:@"/folder1" maximumDepth:1 error:NULL usingBlock:^(HLSFileItem *item, BOOL *pStop) {
+        [paths2 addObject:item.path];
+    }]);
+    XCTAssertEqualObjects(paths2, ([NSSet setWithObjects:@"/folder1/folder11", @"/folder1/file11.txt", nil]));
+    
+    // Empty directory
+    __block NSUInteger count3 = 0;
+    XCTAssertTrue([fileManager enumerateItemsAtPath:@"/folder2" maximumDepth:0 error:NULL usingBlock:^(HLSFileItem *item, BOOL *pStop) {
+        ++count3;
+    }]);
+    XCTAssertEqual(count3, 0);
+    
+    // Stop after the first item
+    __block NSUInteger count4 = 0;
+    XCTAssertTrue([fileManager enumerateItemsAtPath:@"/" maximumDepth:0 error:NULL usingBlock:^(HLSFileItem *item, BOOL *pStop) {
+        ++count4;
+        *pStop = YES;
+    }]);
+    XCTAssertEqual(count4, 1);
+    
+    // Invalid path. Must fail
+    NSError *error5 = nil;
+    XCTAssertFalse([fileManager enumerateItemsAtPath:@"folder1" maximumDepth:0 error:&error5 usingBlock:^(HLSFileItem *item, BOOL *pStop) {}]);
+    XCTAssertNotNil(error5);
+    
+    // Non-existing directory. Must fail
+    NSError *error6 = nil;
+    XCTAssertFalse([fileManager enumerateItemsAtPath:@"/invalid" maximumDepth:0 error:&error6 usingBlock:^(HLSFileItem *item, BOOL *pStop) {}]);
+    XCTAssertNotNil(error6);
+    
+    // File. Must fail
+    NSError *error7 = nil;
+    XCTAssertFalse([fileManager enumerateItemsAtPath:@"/file1.txt" maximumDepth:0 error:&error7 usingBlock:^(HLSFileItem *item, BOOL *pStop) {}]);
+    XCTAssertNotNil(error7);
+}
+
+- (void)testRangesWithFileManager:(HLSFileManager *)fileManager
+{
+    NSParameterAssert(fileManager);
+    
+    // Create test file and folder
+    NSData *data = [@"0123456789" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/file1.txt" contents:data error:NULL]);
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/folder2" withIntermediateDirectories:YES error:NULL]);
+    
+    // Range within the file. Must succeed
+    NSError *error1 = nil;
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file1.txt" range:NSMakeRange(2, 3) error:&error1], [@"234" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertNil(error1);
+    
+    // Range extending past the end of the file. Must succeed and return the available bytes
+    NSError *error2 = nil;
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file1.txt" range:NSMakeRange(8, 10) error:&error2], [@"89" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertNil(error2);
+    
+    // Empty range at the end of the file. Must succeed and return empty data
+    NSError *error3 = nil;
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file1.txt" range:NSMakeRange(10, 5) error:&error3], [NSData data]);
+    XCTAssertNil(error3);
+    
+    // Range beginning past the end of the file. Must fail
+    NSError *error4 = nil;
+    XCTAssertNil([fileManager contentsOfFileAtPath:@"/file1.txt" range:NSMakeRange(11, 1) error:&error4]);
+    XCTAssertNotNil(error4);
+    
+    // Non-existing file. Must fail
+    NSError *error5 = nil;
+    XCTAssertNil([fileManager contentsOfFileAtPath:@"/invalid.txt" range:NSMakeRange(0, 1) error:&error5]);
+    XCTAssertNotNil(error5);
+    
+    // Folder. Must fail
+    NSError *error6 = nil;
+    XCTAssertNil([fileManager contentsOfFileAtPath:@"/folder2" range:NSMakeRange(0, 1) error:&error6]);
+    XCTAssertNotNil(error6);
+}
+
 - (void)testStreamsWithFileManager:(HLSFileManager *)fileManager
 {
     NSParameterAssert(fileManager);
@@ -37,6 +37,18 @@
     [self testMoveWithFileManager:fileManager];
 }
 
+- (void)testEnumeration
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
+    [self testEnumerationWithFileManager:fileManager];
+}
+
+- (void)testRanges
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
+    [self testRangesWithFileManager:fileManager];
+}
+
 - (void)testStreams
 {
     HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
@@ -49,4 +61,281 @@
     [self testURLsWithFileManager:fileManager];
 }
 
+- (void)testCreationAndRemovalWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testCreationAndRemovalWithFileManager:fileManager];
+}
+
+- (void)testContentsAndExistenceWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testContentsAndExistenceWithFileManager:fileManager];
+}
+
+- (void)testCopyWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testCopyWithFileManager:fileManager];
+}
+
+- (void)testMoveWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testMoveWithFileManager:fileManager];
+}
+
+- (void)testEnumerationWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testEnumerationWithFileManager:fileManager];
+}
+
+- (void)testRangesWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testRangesWithFileManager:fileManager];
+}
+
+- (void)testStreamsWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testStreamsWithFileManager:fileManager];
+}
+
+- (void)testURLsWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testURLsWithFileManager:fileManager];
+}
+
+- (void)testConcurrentAccess
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
+    [self testConcurrentAccessWithFileManager:fileManager];
+}
+
+- (void)testConcurrentAccessWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testConcurrentAccessWithFileManager:fileManager];
+}
+
+- (void)testLargeStreams
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
+    
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    arc4random_buf(data.mutableBytes, data.length);
+    
+    // Nothing is committed before the output stream is closed
+    NSOutputStream *outputStream = [fileManager outputStreamToFileAtPath:@"/large.bin" append:NO];
+    [outputStream open];
+    XCTAssertEqual([outputStream write:data.bytes maxLength:data.length], (NSInteger)data.length);
+    XCTAssertFalse([fileManager fileExistsAtPath:@"/large.bin"]);
+    [outputStream close];
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/large.bin" error:NULL], data);
+    
+    NSInputStream *inputStream = [fileManager inputStreamWithFileAtPath:@"/large.bin"];
+    NSOutputStream *memoryOutputStream = [NSOutputStream outputStreamToMemory];
+    XCTAssertTrue([inputStream writeToOutputStream:memoryOutputStream error:NULL]);
+    XCTAssertEqualObjects([memoryOutputStream propertyForKey:NSStreamDataWrittenToMemoryStreamKey], data);
+}
+
+- (void)testCopyOnWrite
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] init];
+    [self testCopyOnWriteWithFileManager:fileManager];
+}
+
+- (void)testCopyOnWriteWithFlatStorage
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self testCopyOnWriteWithFileManager:fileManager];
+}
+
+- (void)testHierarchicalStoragePerformance
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeHierarchical];
+    [self measureLookupPerformanceWithFileManager:fileManager];
+}
+
+- (void)testFlatStoragePerformance
+{
+    HLSInMemoryFileManager *fileManager = [[HLSInMemoryFileManager alloc] initWithStorageMode:HLSInMemoryFileManagerStorageModeFlat];
+    [self measureLookupPerformanceWithFileManager:fileManager];
+}
+
+#pragma mark Common test code
+
+/**
+ * Mix reads, writes, copies, removals and evictions from several threads. The cost limit is small so that the cache
+ * evicts entries all the time
+ */
+- (void)testConcurrentAccessWithFileManager:(HLSInMemoryFileManager *)fileManager
+{
+    static const NSUInteger kFolderCount = 10;
+    static const NSUInteger kFileCount = 20;
+    
+    fileManager.byteCostLimit = 4096;
+    
+    for (NSUInteger i = 0; i < kFolderCount; ++i) {
+        NSString *folderPath = [NSString stringWithFormat:@"/folder%@", @(i)];
+        XCTAssertTrue([fileManager createDirectoryAtPath:folderPath withIntermediateDirectories:NO error:NULL]);
+    }
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/copy" withIntermediateDirectories:NO error:NULL]);
+    
+    dispatch_apply(10000, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t iteration) {
+        NSString *folderPath = [NSString stringWithFormat:@"/folder%@", @(iteration % kFolderCount)];
+        NSString *filePath = [folderPath stringByAppendingPathComponent:[NSString stringWithFormat:@"file%@.txt", @(iteration % kFileCount)]];
+        
+        // The content of a file only depends on its path, so that reads can be checked
+        NSData *data = [[filePath stringByPaddingToLength:256 withString:@"*" startingAtIndex:0] dataUsingEncoding:NSUTF8StringEncoding];
+        
+        switch (iteration % 8) {
+            case 0:
+            case 1:
+            case 2: {
+                NSData *readData = [fileManager contentsOfFileAtPath:filePath error:NULL];
+                if (readData) {
+                    XCTAssertEqualObjects(readData, data);
+                }
+                break;
+            }
+                
+            case 3: {
+                XCTAssertNotNil([fileManager contentsOfDirectoryAtPath:folderPath error:NULL]);
+                XCTAssertTrue([fileManager fileExistsAtPath:folderPath]);
+                break;
+            }
+                
+            case 4:
+            case 5: {
+                XCTAssertTrue([fileManager createFileAtPath:filePath contents:data error:NULL]);
+                break;
+            }
+                
+            case 6: {
+                NSString *copyPath = [NSString stringWithFormat:@"/copy/%@", [NSUUID UUID].UUIDString];
+                [fileManager copyItemAtPath:folderPath toPath:copyPath error:NULL];
+                [fileManager removeItemAtPath:copyPath error:NULL];
+                [fileManager removeItemAtPath:filePath error:NULL];
+                break;
+            }
+                
+            case 7: {
+                if (iteration % 1000 == 7) {
+                    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+                }
+                break;
+            }
+                
+            default: {
+                break;
+            }
+        }
+    });
+    
+    // The hierarchy must still be consistent
+    for (NSUInteger i = 0; i < kFolderCount; ++i) {
+        NSString *folderPath = [NSString stringWithFormat:@"/folder%@", @(i)];
+        XCTAssertTrue([fileManager fileExistsAtPath:folderPath]);
+    }
+    XCTAssertTrue([fileManager removeItemAtPath:@"/" error:NULL]);
+    XCTAssertEqual([fileManager contentsOfDirectoryAtPath:@"/" error:NULL].count, (NSUInteger)0);
+}
+
+/**
+ * Build a tree of large files filling half of the cache, and copy it several times. Since copies share their data,
+ * nothing must be evicted
+ */
+- (void)testCopyOnWriteWithFileManager:(HLSInMemoryFileManager *)fileManager
+{
+    static const NSUInteger kFileSize = 1024 * 1024;
+    static const NSUInteger kFolderCount = 4;
+    static const NSUInteger kFileCount = 4;
+    static const NSUInteger kCopyCount = 10;
+    
+    fileManager.byteCostLimit = 2 * kFolderCount * kFileCount * kFileSize;
+    
+    for (NSUInteger i = 0; i < kFolderCount; ++i) {
+        for (NSUInteger j = 0; j < kFileCount; ++j) {
+            NSString *filePath = [NSString stringWithFormat:@"/tree/folder%@/file%@.bin", @(i), @(j)];
+            XCTAssertTrue([fileManager createDirectoryAtPath:filePath.stringByDeletingLastPathComponent withIntermediateDirectories:YES error:NULL]);
+            
+            NSMutableData *data = [NSMutableData dataWithLength:kFileSize];
+            arc4random_buf(data.mutableBytes, data.length);
+            XCTAssertTrue([fileManager createFileAtPath:filePath contents:data error:NULL]);
+        }
+    }
+    
+    for (NSUInteger k = 0; k < kCopyCount; ++k) {
+        NSString *copyPath = [NSString stringWithFormat:@"/copy%@", @(k)];
+        XCTAssertTrue([fileManager copyItemAtPath:@"/tree" toPath:copyPath error:NULL]);
+    }
+    
+    for (NSUInteger i = 0; i < kFolderCount; ++i) {
+        for (NSUInteger j = 0; j < kFileCount; ++j) {
+            NSString *relativeFilePath = [NSString stringWithFormat:@"folder%@/file%@.bin", @(i), @(j)];
+            NSData *data = [fileManager contentsOfFileAtPath:[@"/tree" stringByAppendingPathComponent:relativeFilePath] error:NULL];
+            XCTAssertNotNil(data);
+            
+            // Copies share the original bytes
+            for (NSUInteger k = 0; k < kCopyCount; ++k) {
+                NSString *copyPath = [NSString stringWithFormat:@"/copy%@", @(k)];
+                NSData *copyData = [fileManager contentsOfFileAtPath:[copyPath stringByAppendingPathComponent:relativeFilePath] error:NULL];
+                XCTAssertEqual(copyData.bytes, data.bytes);
+            }
+        }
+    }
+    
+    // Overwriting a copy does not affect the original or other copies
+    NSData *originalData = [fileManager contentsOfFileAtPath:@"/tree/folder0/file0.bin" error:NULL];
+    NSData *newData = [@"new" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/copy0/folder0/file0.bin" contents:newData error:NULL]);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/copy0/folder0/file0.bin" error:NULL], newData);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/tree/folder0/file0.bin" error:NULL], originalData);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/copy1/folder0/file0.bin" error:NULL], originalData);
+    
+    // Removing the original does not affect copies
+    XCTAssertTrue([fileManager removeItemAtPath:@"/tree" error:NULL]);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/copy1/folder0/file0.bin" error:NULL], originalData);
+}
+
+#pragma mark Benchmarks
+
+/**
+ * Build a deep hierarchy, then measure existence checks, reads and writes at its deepest level
+ */
+- (void)measureLookupPerformanceWithFileManager:(HLSInMemoryFileManager *)fileManager
+{
+    static const NSUInteger kDepth = 32;
+    static const NSUInteger kFileCount = 100;
+    
+    NSMutableString *directoryPath = [NSMutableString string];
+    for (NSUInteger i = 0; i < kDepth; ++i) {
+        [directoryPath appendFormat:@"/folder%@", @(i)];
+    }
+    XCTAssertTrue([fileManager createDirectoryAtPath:directoryPath withIntermediateDirectories:YES error:NULL]);
+    
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableArray<NSString *> *filePaths = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kFileCount; ++i) {
+        NSString *filePath = [directoryPath stringByAppendingPathComponent:[NSString stringWithFormat:@"file%@.txt", @(i)]];
+        XCTAssertTrue([fileManager createFileAtPath:filePath contents:data error:NULL]);
+        [filePaths addObject:filePath];
+    }
+    
+    [self measureBlock:^{
+        for (NSUInteger j = 0; j < 100; ++j) {
+            for (NSString *filePath in filePaths) {
+                [fileManager fileExistsAtPath:filePath];
+                [fileManager contentsOfFileAtPath:filePath error:NULL];
+                [fileManager createFileAtPath:filePath contents:data error:NULL];
+            }
+            [fileManager contentsOfDirectoryAtPath:directoryPath error:NULL];
+        }
+    }];
+}
+
 @end
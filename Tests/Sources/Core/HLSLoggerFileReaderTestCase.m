@@ -0,0 +1,119 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoconutKit/CoconutKit.h>
+#import <XCTest/XCTest.h>
+
+@interface HLSLoggerFileReaderTestCase : XCTestCase
+
+@property (nonatomic, copy) NSString *filePath;
+
+@end
+
+@implementation HLSLoggerFileReaderTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:self.filePath error:NULL];
+}
+
+#pragma mark Helpers
+
+- (void)writeLogFileWithContents:(NSString *)contents
+{
+    XCTAssertTrue([[contents dataUsingEncoding:NSUTF8StringEncoding] writeToFile:self.filePath atomically:YES]);
+}
+
+#pragma mark Tests
+
+- (void)testLines
+{
+    [self writeLogFileWithContents:@"Preamble\n"
+        "2017-01-01 12:00:00.000 [a03] [INFO] First entry\n"
+        "2017-01-01 12:00:00.001 [a03] [WARN] Second entry, éàü\n"
+        "continued\n"
+        "2017-01-01 12:00:00.002 [b07] [ERROR] Third entry"];
+
+    HLSLoggerFileReader *fileReader = [[HLSLoggerFileReader alloc] initWithFilePath:self.filePath];
+    XCTAssertNotNil(fileReader);
+    [fileReader waitUntilIndexed];
+    XCTAssertTrue(fileReader.indexed);
+
+    XCTAssertEqual(fileReader.lineCount, (NSUInteger)5);
+    XCTAssertEqualObjects([fileReader lineAtIndex:0], @"Preamble");
+    XCTAssertEqualObjects([fileReader lineAtIndex:2], @"2017-01-01 12:00:00.001 [a03] [WARN] Second entry, éàü");
+    XCTAssertEqualObjects([fileReader lineAtIndex:4], @"2017-01-01 12:00:00.002 [b07] [ERROR] Third entry");
+    XCTAssertNil([fileReader lineAtIndex:5]);
+
+    NSArray<NSString *> *lines = [fileReader linesInRange:NSMakeRange(3, 10)];
+    XCTAssertEqual(lines.count, (NSUInteger)2);
+    XCTAssertEqualObjects(lines.firstObject, @"continued");
+
+    XCTAssertEqual([fileReader levelOfLineAtIndex:0], HLSLoggerLevelFatal);
+    XCTAssertEqual([fileReader levelOfLineAtIndex:1], HLSLoggerLevelInfo);
+    XCTAssertEqual([fileReader levelOfLineAtIndex:3], HLSLoggerLevelWarn);
+    XCTAssertEqual([fileReader levelOfLineAtIndex:5], HLSLoggerLevelNone);
+}
+
+- (void)testFiltering
+{
+    [self writeLogFileWithContents:@"2017-01-01 12:00:00.000 [a03] [DEBUG] Loading\n"
+        "2017-01-01 12:00:00.001 [a03] [INFO] Loaded\n"
+        "2017-01-01 12:00:00.002 [a03] [WARN] Slow loading\n"
+        "2017-01-01 12:00:00.003 [a03] [ERROR] Failed\n"];
+
+    HLSLoggerFileReader *fileReader = [[HLSLoggerFileReader alloc] initWithFilePath:self.filePath];
+    [fileReader waitUntilIndexed];
+
+    XCTAssertEqual(fileReader.lineCount, (NSUInteger)4);
+    XCTAssertEqualObjects([fileReader indexesOfLinesWithMinimumLevel:HLSLoggerLevelDebug containingString:nil], [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 4)]);
+    XCTAssertEqualObjects([fileReader indexesOfLinesWithMinimumLevel:HLSLoggerLevelWarn containingString:nil], [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(2, 2)]);
+    XCTAssertEqualObjects([fileReader indexesOfLinesWithMinimumLevel:HLSLoggerLevelDebug containingString:@"oad"], [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 3)]);
+    XCTAssertEqualObjects([fileReader indexesOfLinesWithMinimumLevel:HLSLoggerLevelInfo containingString:@"Load"], [NSIndexSet indexSetWithIndex:1]);
+}
+
+- (void)testEmptyFile
+{
+    [self writeLogFileWithContents:@""];
+
+    HLSLoggerFileReader *fileReader = [[HLSLoggerFileReader alloc] initWithFilePath:self.filePath];
+    [fileReader waitUntilIndexed];
+    XCTAssertEqual(fileReader.lineCount, (NSUInteger)0);
+    XCTAssertEqual([fileReader linesInRange:NSMakeRange(0, 10)].count, (NSUInteger)0);
+}
+
+- (void)testMissingFile
+{
+    XCTAssertNil([[HLSLoggerFileReader alloc] initWithFilePath:self.filePath]);
+}
+
+#pragma mark Benchmarks
+
+- (void)testIndexingAndFilteringPerformance
+{
+    // About 20 MB
+    NSMutableString *contents = [NSMutableString string];
+    for (NSUInteger i = 0; i < 200000; ++i) {
+        [contents appendFormat:@"2017-01-01 12:00:00.000 [a03] [%@] (-[HLSBenchmark run]) - Entry %@ with some payload\n", (i % 10 == 0) ? @"ERROR" : @"INFO", @(i)];
+    }
+    [self writeLogFileWithContents:contents];
+
+    [self measureBlock:^{
+        HLSLoggerFileReader *fileReader = [[HLSLoggerFileReader alloc] initWithFilePath:self.filePath];
+        [fileReader waitUntilIndexed];
+        XCTAssertEqual([fileReader indexesOfLinesWithMinimumLevel:HLSLoggerLevelError containingString:@"Entry 12340 "].count, (NSUInteger)1);
+        XCTAssertEqual([fileReader linesInRange:NSMakeRange(100000, 50)].count, (NSUInteger)50);
+    }];
+}
+
+@end
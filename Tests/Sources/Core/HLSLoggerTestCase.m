@@ -0,0 +1,370 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoconutKit/CoconutKit.h>
+#import <XCTest/XCTest.h>
+
+@interface HLSLoggerTestCase : XCTestCase
+
+@property (nonatomic) HLSLoggerLevel originalLevel;
+@property (nonatomic, getter=isOriginalFileLoggingEnabled) BOOL originalFileLoggingEnabled;
+
+@end
+
+@implementation HLSLoggerTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    self.originalLevel = logger.level;
+    self.originalFileLoggingEnabled = logger.fileLoggingEnabled;
+}
+
+- (void)tearDown
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.fileLoggingAsynchronous = NO;
+    logger.fileFormat = HLSLoggerFileFormatText;
+    logger.consoleLoggingEnabled = YES;
+    logger.overflowPolicy = HLSLoggerOverflowPolicyDropOldest;
+    logger.maximumFileSize = 2 * 1024 * 1024;
+    logger.maximumDiskUsage = 20 * 1024 * 1024;
+    logger.compressingClosedFiles = YES;
+    for (HLSLoggerCategory *category in logger.categories) {
+        if ([category.name hasPrefix:NSStringFromClass([self class])]) {
+            [category resetLevel];
+        }
+    }
+    logger.level = self.originalLevel;
+    logger.fileLoggingEnabled = self.originalFileLoggingEnabled;
+}
+
+#pragma mark Tests
+
+- (void)testAsynchronousFileLogging
+{
+    static const NSUInteger kThreadCount = 8;
+    static const NSUInteger kEntryCount = 5000;
+
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.fileLoggingAsynchronous = YES;
+    logger.overflowPolicy = HLSLoggerOverflowPolicyBlock;
+
+    // No entry can be lost when blocking, even with far more entries than the buffer can hold
+    NSUInteger droppedEntryCount = logger.droppedEntryCount;
+    dispatch_apply(kThreadCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        for (NSUInteger j = 0; j < kEntryCount; ++j) {
+            [logger info:[NSString stringWithFormat:@"Thread %@, entry %@", @(i), @(j)]];
+        }
+    });
+    [logger flush];
+    XCTAssertEqual(logger.droppedEntryCount, droppedEntryCount);
+}
+
+- (void)testLevelCheck
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelWarn;
+    XCTAssertFalse([logger isEnabledForLevel:HLSLoggerLevelDebug]);
+    XCTAssertFalse([logger isEnabledForLevel:HLSLoggerLevelInfo]);
+    XCTAssertTrue([logger isEnabledForLevel:HLSLoggerLevelWarn]);
+    XCTAssertTrue([logger isEnabledForLevel:HLSLoggerLevelFatal]);
+}
+
+- (void)testCategoryLevels
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelWarn;
+
+    HLSLoggerCategory *category = [logger categoryWithName:@"HLSLoggerTestCase.levels"];
+    XCTAssertEqual([logger categoryWithName:@"HLSLoggerTestCase.levels"], category);
+    XCTAssertTrue([logger.categories containsObject:category]);
+
+    // Inherited from the logger
+    XCTAssertFalse(category.hasOwnLevel);
+    XCTAssertEqual(category.level, HLSLoggerLevelWarn);
+    XCTAssertFalse([category isEnabledForLevel:HLSLoggerLevelInfo]);
+
+    logger.level = HLSLoggerLevelError;
+    XCTAssertEqual(category.level, HLSLoggerLevelError);
+
+    // Own level, independent of the logger
+    category.level = HLSLoggerLevelDebug;
+    XCTAssertTrue(category.hasOwnLevel);
+    XCTAssertTrue([category isEnabledForLevel:HLSLoggerLevelDebug]);
+    XCTAssertFalse([logger isEnabledForLevel:HLSLoggerLevelDebug]);
+
+    logger.level = HLSLoggerLevelFatal;
+    XCTAssertEqual(category.level, HLSLoggerLevelDebug);
+
+    [category resetLevel];
+    XCTAssertFalse(category.hasOwnLevel);
+    XCTAssertEqual(category.level, HLSLoggerLevelFatal);
+}
+
+- (void)testBinaryFileLoggingWithCategory
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelError;
+    logger.fileLoggingEnabled = YES;
+    logger.fileFormat = HLSLoggerFileFormatBinary;
+
+    HLSLoggerCategory *category = [logger categoryWithName:@"HLSLoggerTestCase.binary"];
+    category.level = HLSLoggerLevelInfo;
+
+    NSString *marker = [NSUUID UUID].UUIDString;
+    [logger logWithLevel:HLSLoggerLevelWarn category:category function:__PRETTY_FUNCTION__ format:@"%@ %d", marker, 42];
+    [logger logWithLevel:HLSLoggerLevelDebug category:category function:__PRETTY_FUNCTION__ format:@"%@ disabled", marker];
+    [logger flush];
+
+    NSMutableArray<NSString *> *lines = [NSMutableArray array];
+    for (NSString *logFilePath in logger.availableLogFilePaths) {
+        if (! [logFilePath.pathExtension isEqualToString:HLSLoggerBinaryLogFileExtension]) {
+            continue;
+        }
+
+        HLSLoggerDecodeBinaryLogFile(logFilePath, ^(NSString *line, BOOL *pStop) {
+            if ([line containsString:marker]) {
+                [lines addObject:line];
+            }
+        }, NULL);
+    }
+
+    XCTAssertEqual(lines.count, (NSUInteger)1);
+    NSString *expectedSuffix = [NSString stringWithFormat:@"[WARN] [HLSLoggerTestCase.binary] (-[HLSLoggerTestCase testBinaryFileLoggingWithCategory]) - %@ 42", marker];
+    XCTAssertTrue([lines.firstObject hasSuffix:expectedSuffix]);
+}
+
+- (void)testBinaryFileLogging
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.fileFormat = HLSLoggerFileFormatBinary;
+
+    NSString *marker = [NSUUID UUID].UUIDString;
+    [logger logWithLevel:HLSLoggerLevelWarn function:__PRETTY_FUNCTION__ format:@"%@ %d|%5.1f|%-4s|%x|%%", marker, -42, 3.14159, "ab", 255U];
+    [logger info:[NSString stringWithFormat:@"%@ message", marker]];
+
+    // Formats built at runtime are not interned, but logged as messages
+    NSString *format = [NSString stringWithFormat:@"%@ runtime %%d", marker];
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wformat-nonliteral"
+    [logger logWithLevel:HLSLoggerLevelWarn function:__PRETTY_FUNCTION__ format:format, 7];
+#pragma clang diagnostic pop
+    [logger flush];
+
+    NSString *logDirectoryPath = [HLSApplicationLibraryDirectoryPath() stringByAppendingPathComponent:@"HLSLogger"];
+    NSArray<NSString *> *logFileNames = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:logDirectoryPath error:NULL];
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"pathExtension == %@", HLSLoggerBinaryLogFileExtension];
+    NSString *logFileName = [[logFileNames filteredArrayUsingPredicate:predicate] sortedArrayUsingSelector:@selector(compare:)].lastObject;
+    XCTAssertNotNil(logFileName);
+
+    NSMutableArray<NSString *> *lines = [NSMutableArray array];
+    NSString *logFilePath = [logDirectoryPath stringByAppendingPathComponent:logFileName];
+    XCTAssertTrue(HLSLoggerDecodeBinaryLogFile(logFilePath, ^(NSString *line, BOOL *pStop) {
+        if ([line containsString:marker]) {
+            [lines addObject:line];
+        }
+    }, NULL));
+
+    // Same entries as in text files
+    XCTAssertEqual(lines.count, (NSUInteger)3);
+    NSString *expectedSuffix1 = [NSString stringWithFormat:@"[WARN] (-[HLSLoggerTestCase testBinaryFileLogging]) - %@ -42|  3.1|ab  |ff|%%", marker];
+    XCTAssertTrue([lines[0] hasSuffix:expectedSuffix1]);
+    NSString *expectedSuffix2 = [NSString stringWithFormat:@"[INFO] %@ message", marker];
+    XCTAssertTrue([lines[1] hasSuffix:expectedSuffix2]);
+    NSString *expectedSuffix3 = [NSString stringWithFormat:@"[WARN] (-[HLSLoggerTestCase testBinaryFileLogging]) - %@ runtime 7", marker];
+    XCTAssertTrue([lines[2] hasSuffix:expectedSuffix3]);
+}
+
+- (void)testInvalidBinaryLogFile
+{
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue([[@"Not a log file" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:filePath atomically:YES]);
+
+    NSError *error = nil;
+    XCTAssertFalse(HLSLoggerDecodeBinaryLogFile(filePath, ^(NSString *line, BOOL *pStop) {
+        XCTFail(@"No entry expected");
+    }, &error));
+    XCTAssertEqual(error.code, NSFileReadCorruptFileError);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:NULL];
+}
+
+- (void)testFileRotation
+{
+    static const NSUInteger kEntryCount = 500;
+
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.compressingClosedFiles = NO;
+    logger.maximumDiskUsage = 0;
+    logger.maximumFileSize = 4 * 1024;
+
+    NSString *marker = [NSUUID UUID].UUIDString;
+    for (NSUInteger i = 0; i < kEntryCount; ++i) {
+        [logger info:[NSString stringWithFormat:@"%@ entry %@", marker, @(i)]];
+    }
+
+    // No entry is lost, but entries are spread over several files
+    __block NSUInteger entryCount = 0;
+    NSUInteger logFileCount = 0;
+    for (NSString *logFilePath in logger.availableLogFilePaths) {
+        __block BOOL found = NO;
+        [logger enumerateLinesOfLogFileAtPath:logFilePath error:NULL usingBlock:^(NSString *line, BOOL *pStop) {
+            if ([line containsString:marker]) {
+                ++entryCount;
+                found = YES;
+            }
+        }];
+        if (found) {
+            ++logFileCount;
+        }
+    }
+    XCTAssertEqual(entryCount, kEntryCount);
+    XCTAssertGreaterThan(logFileCount, (NSUInteger)1);
+}
+
+- (void)testLastLines
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.maximumFileSize = 0;
+
+    NSString *marker = [NSUUID UUID].UUIDString;
+    for (NSUInteger i = 0; i < 100; ++i) {
+        [logger info:[NSString stringWithFormat:@"%@ entry %@", marker, @(i)]];
+    }
+
+    NSString *logFilePath = logger.availableLogFilePaths.firstObject;
+    NSArray<NSString *> *lines = [logger lastLines:3 ofLogFileAtPath:logFilePath error:NULL];
+    XCTAssertEqual(lines.count, (NSUInteger)3);
+    XCTAssertTrue([lines[0] hasSuffix:[NSString stringWithFormat:@"%@ entry 97", marker]]);
+    XCTAssertTrue([lines[2] hasSuffix:[NSString stringWithFormat:@"%@ entry 99", marker]]);
+
+    XCTAssertEqual([logger lastLines:0 ofLogFileAtPath:logFilePath error:NULL].count, (NSUInteger)0);
+
+    NSError *error = nil;
+    NSString *missingLogFilePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertNil([logger lastLines:3 ofLogFileAtPath:missingLogFilePath error:&error]);
+    XCTAssertNotNil(error);
+}
+
+#pragma mark Benchmarks
+
+- (void)measureFileLoggingAsynchronously:(BOOL)asynchronously
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.fileLoggingAsynchronous = asynchronously;
+
+    [self measureBlock:^{
+        dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+            for (NSUInteger j = 0; j < 1000; ++j) {
+                [logger info:@"Benchmark entry"];
+            }
+        });
+        [logger flush];
+    }];
+}
+
+- (void)testSynchronousFileLoggingPerformance
+{
+    [self measureFileLoggingAsynchronously:NO];
+}
+
+- (void)testAsynchronousFileLoggingPerformance
+{
+    [self measureFileLoggingAsynchronously:YES];
+}
+
+- (void)measureFileLoggingWithFormat:(HLSLoggerFileFormat)format
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelInfo;
+    logger.fileLoggingEnabled = YES;
+    logger.consoleLoggingEnabled = NO;
+    logger.fileFormat = format;
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; ++i) {
+            @autoreleasepool {
+                [logger logWithLevel:HLSLoggerLevelInfo function:__PRETTY_FUNCTION__ format:@"Entry %@, value %.3f", @(i), i * 0.5];
+            }
+        }
+        [logger flush];
+    }];
+}
+
+- (void)testTextFileLoggingPerformance
+{
+    [self measureFileLoggingWithFormat:HLSLoggerFileFormatText];
+}
+
+- (void)testBinaryFileLoggingPerformance
+{
+    [self measureFileLoggingWithFormat:HLSLoggerFileFormatBinary];
+}
+
+// Disabled entries, as the former macros logged them (message formatted first, level checked last)
+- (void)testEagerDisabledLoggingPerformance
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelError;
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            @autoreleasepool {
+                [logger debug:[NSString stringWithFormat:@"(%s) - %@", __PRETTY_FUNCTION__, [NSString stringWithFormat:@"Entry %@", @(i)]]];
+            }
+        }
+    }];
+}
+
+// Disabled entries, as the macros now log them (level checked first, nothing formatted)
+- (void)testDeferredDisabledLoggingPerformance
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelError;
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            @autoreleasepool {
+                if ([logger isEnabledForLevel:HLSLoggerLevelDebug]) {
+                    [logger logWithLevel:HLSLoggerLevelDebug function:__PRETTY_FUNCTION__ format:@"Entry %@", @(i)];
+                }
+            }
+        }
+    }];
+}
+
+// Disabled entries of a category, checked against its level only
+- (void)testDisabledCategoryLoggingPerformance
+{
+    HLSLogger *logger = [HLSLogger sharedLogger];
+    logger.level = HLSLoggerLevelError;
+    HLSLoggerCategory *category = [logger categoryWithName:@"HLSLoggerTestCase.performance"];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            @autoreleasepool {
+                if ([category isEnabledForLevel:HLSLoggerLevelDebug]) {
+                    [logger logWithLevel:HLSLoggerLevelDebug category:category function:__PRETTY_FUNCTION__ format:@"Entry %@", @(i)];
+                }
+            }
+        }
+    }];
+}
+
+@end
@@ -1121,6 +1121,23 @@ typedef union LargeUnion_ {
     free(RuntimeTestCompositeProtocol_optionalInstanceMethodDescriptions);
 }
 
+- (void)testProtocolDeclaresSelector
+{
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(methodC1), YES, YES));
+    XCTAssertFalse(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(methodC1), NO, YES));
+    XCTAssertFalse(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(methodC1), YES, NO));
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(classMethodC2), NO, NO));
+    
+    // Parent protocols
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(methodA1), YES, YES));
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(classMethodB2), NO, NO));
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestCompositeProtocol), @selector(isEqual:), YES, YES));
+    XCTAssertTrue(hls_protocol_declaresSelector(@protocol(RuntimeTestFormalSubProtocolA), @selector(methodA2), NO, YES));
+    
+    XCTAssertFalse(hls_protocol_declaresSelector(@protocol(RuntimeTestFormalProtocolA), @selector(methodA3), YES, YES));
+    XCTAssertFalse(hls_protocol_declaresSelector(@protocol(RuntimeTestFormalProtocolA), @selector(methodB1), YES, YES));
+}
+
 - (void)testClassConformsToProtocol
 {
     XCTAssertTrue(hls_class_conformsToProtocol([RuntimeTestClass1 class], @protocol(NSObject)));
@@ -1370,6 +1387,21 @@ typedef union LargeUnion_ {
     XCTAssertTrue(hls_class_swizzleSelector([RuntimeTestClass11 class], NSSelectorFromString(@"unknownSelector"), (IMP)0x1) == NULL);
 }
 
+- (void)testSwizzleRegistry
+{
+    // Swizzles registered by CoconutKit +load methods have been installed
+    NSArray<NSString *> *swizzleDescriptions = hls_swizzleDescriptions();
+    XCTAssertTrue([swizzleDescriptions containsObject:@"-[UILabel setText:]"]);
+    XCTAssertFalse([[swizzleDescriptions componentsJoinedByString:@"\n"] containsString:@"(pending)"]);
+    XCTAssertGreaterThan(hls_swizzlesInstallationDuration(), 0.);
+    
+    // Swizzles registered later are installed immediately
+    IMP previousImplementation = NULL;
+    hls_class_registerSwizzleSelector([RuntimeTestClass11 class], NSSelectorFromString(@"unknownSelector"), (IMP)0x1, &previousImplementation);
+    XCTAssertTrue(previousImplementation == NULL);
+    XCTAssertEqualObjects(hls_swizzleDescriptions().lastObject, @"-[RuntimeTestClass11 unknownSelector] (not found)");
+}
+
 - (void)testClassIsSubclassOfClass
 {
     XCTAssertTrue(hls_class_isSubclassOfClass([UIView class], [NSObject class]));
@@ -1437,4 +1469,48 @@ typedef union LargeUnion_ {
     objc_removeAssociatedObjects(self);
 }
 
+#pragma mark Benchmarks
+
+- (void)testClassConformsToInformalProtocolPerformance
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100000; ++i) {
+            hls_class_conformsToInformalProtocol([RuntimeTestClass7 class], @protocol(RuntimeTestInformalProtocolA));
+        }
+    }];
+}
+
+- (void)testAssociatedObjectAccessPerformance
+{
+    static void *kAssociatedObjectKey = &kAssociatedObjectKey;
+    NSObject *object = [[NSObject alloc] init];
+    hls_setAssociatedObject(self, kAssociatedObjectKey, object, HLS_ASSOCIATION_STRONG_NONATOMIC);
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000000; ++i) {
+            hls_getAssociatedObject(self, kAssociatedObjectKey);
+        }
+    }];
+    
+    objc_removeAssociatedObjects(self);
+}
+
+- (void)testFormattedKeyAssociatedObjectAccessPerformance
+{
+    // Reference: Hidden keys formerly derived from a formatted string
+    static void *kAssociatedObjectKey = &kAssociatedObjectKey;
+    NSObject *object = [[NSObject alloc] init];
+    objc_setAssociatedObject(self, (void *)[NSString stringWithFormat:@"hls_%p", kAssociatedObjectKey].hash, object, OBJC_ASSOCIATION_RETAIN_NONATOMIC);
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000000; ++i) {
+            @autoreleasepool {
+                objc_getAssociatedObject(self, (void *)[NSString stringWithFormat:@"hls_%p", kAssociatedObjectKey].hash);
+            }
+        }
+    }];
+    
+    objc_removeAssociatedObjects(self);
+}
+
 @end
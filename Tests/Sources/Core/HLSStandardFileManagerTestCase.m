@@ -59,6 +59,20 @@
     [self testMoveWithFileManager:fileManager];
 }
 
+- (void)testEnumeration
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    [self testEnumerationWithFileManager:fileManager];
+}
+
+- (void)testRanges
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    [self testRangesWithFileManager:fileManager];
+}
+
 - (void)testStreams
 {
     NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
@@ -73,4 +87,260 @@
     [self testURLsWithFileManager:fileManager];
 }
 
+- (void)testCreationAndRemovalWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testCreationAndRemovalWithFileManager:fileManager];
+}
+
+- (void)testContentsAndExistenceWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testContentsAndExistenceWithFileManager:fileManager];
+}
+
+- (void)testCopyWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testCopyWithFileManager:fileManager];
+}
+
+- (void)testMoveWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testMoveWithFileManager:fileManager];
+}
+
+- (void)testEnumerationWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testEnumerationWithFileManager:fileManager];
+}
+
+- (void)testRangesWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testRangesWithFileManager:fileManager];
+}
+
+- (void)testStreamsWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testStreamsWithFileManager:fileManager];
+}
+
+- (void)testURLsWithAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self testURLsWithFileManager:fileManager];
+}
+
+- (void)testAsynchronousWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    
+    // Repeated writes to the same file. The most recent data must always be read
+    for (NSUInteger i = 0; i < 100; ++i) {
+        NSData *data = [[NSString stringWithFormat:@"data%@", @(i)] dataUsingEncoding:NSUTF8StringEncoding];
+        XCTAssertTrue([fileManager createFileAtPath:@"/file.txt" contents:data error:NULL]);
+        XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+        XCTAssertTrue([fileManager fileExistsAtPath:@"/file.txt"]);
+    }
+    
+    // Invalid locations are detected immediately
+    NSError *error = nil;
+    XCTAssertFalse([fileManager createFileAtPath:@"/invalid/file.txt" contents:[NSData data] error:&error]);
+    XCTAssertNotNil(error);
+    
+    [fileManager flush];
+    
+    NSString *fullPath = [rootFolderPath stringByAppendingPathComponent:@"file.txt"];
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:fullPath], [@"data99" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testDeferredWrites
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writeDurability = HLSFileWriteDurabilityDeferred;
+    
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/file.txt" contents:data error:NULL]);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+    XCTAssertEqual([fileManager contentsOfDirectoryAtPath:@"/" error:NULL].count, (NSUInteger)1);
+    
+    // Nothing written until the file manager is flushed
+    NSString *fullPath = [rootFolderPath stringByAppendingPathComponent:@"file.txt"];
+    XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:fullPath]);
+    
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Flushed"];
+    [fileManager flushWithCompletionBlock:^{
+        XCTAssertEqualObjects([NSData dataWithContentsOfFile:fullPath], data);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithTimeout:10. handler:nil];
+}
+
+- (void)testDeferredWritesOnDeallocation
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    NSString *fullPath = [rootFolderPath stringByAppendingPathComponent:@"file.txt"];
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    
+    // Pending data must not be lost when a file manager is released without being flushed
+    @autoreleasepool {
+        HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+        fileManager.writeDurability = HLSFileWriteDurabilityDeferred;
+        XCTAssertTrue([fileManager createFileAtPath:@"/file.txt" contents:data error:NULL]);
+        XCTAssertFalse([[NSFileManager defaultManager] fileExistsAtPath:fullPath]);
+    }
+    XCTAssertEqualObjects([NSData dataWithContentsOfFile:fullPath], data);
+}
+
+- (void)testReadPolicies
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.mappingThreshold = 1024;
+    
+    NSMutableData *data = [NSMutableData dataWithLength:4096];
+    arc4random_buf(data.mutableBytes, data.length);
+    XCTAssertTrue([fileManager createFileAtPath:@"/file.bin" contents:data error:NULL]);
+    
+    for (HLSFileReadPolicy readPolicy = HLSFileReadPolicyEnumBegin; readPolicy < HLSFileReadPolicyEnumEnd; ++readPolicy) {
+        XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.bin" readPolicy:readPolicy error:NULL], data);
+        
+        fileManager.readPolicy = readPolicy;
+        XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.bin" error:NULL], data);
+    }
+}
+
+- (void)testReadPerformance1KBMapped
+{
+    [self measureReadsWithFileSize:1024 readPolicy:HLSFileReadPolicyMapped];
+}
+
+- (void)testReadPerformance1KBRead
+{
+    [self measureReadsWithFileSize:1024 readPolicy:HLSFileReadPolicyRead];
+}
+
+- (void)testReadPerformance1MBMapped
+{
+    [self measureReadsWithFileSize:1024 * 1024 readPolicy:HLSFileReadPolicyMapped];
+}
+
+- (void)testReadPerformance1MBRead
+{
+    [self measureReadsWithFileSize:1024 * 1024 readPolicy:HLSFileReadPolicyRead];
+}
+
+- (void)testReadPerformance500MBMapped
+{
+    [self measureReadsWithFileSize:500 * 1024 * 1024 readPolicy:HLSFileReadPolicyMapped];
+}
+
+- (void)testReadPerformance500MBRead
+{
+    [self measureReadsWithFileSize:500 * 1024 * 1024 readPolicy:HLSFileReadPolicyRead];
+}
+
+- (void)testRangeReadPerformance500MB
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    [self createFileAtPath:@"/file.bin" size:500 * 1024 * 1024 withFileManager:fileManager];
+    
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 100; ++i) {
+            NSRange range = NSMakeRange(i * 5 * 1024 * 1024, 64 * 1024);
+            XCTAssertEqual([fileManager contentsOfFileAtPath:@"/file.bin" range:range error:NULL].length, range.length);
+        }
+    }];
+}
+
+- (void)testSynchronousWritePerformance
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    [self measureSmallWritesWithFileManager:fileManager];
+}
+
+- (void)testAsynchronousWritePerformance
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    fileManager.writingAsynchronously = YES;
+    [self measureSmallWritesWithFileManager:fileManager];
+    [fileManager flush];
+}
+
+#pragma mark Benchmarks
+
+- (void)createFileAtPath:(NSString *)path size:(unsigned long long)size withFileManager:(HLSStandardFileManager *)fileManager
+{
+    // Sparse file, quickly created
+    XCTAssertTrue([fileManager createFileAtPath:path contents:[NSData data] error:NULL]);
+    NSURL *fileURL = [fileManager URLForFileAtPath:path];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:fileURL error:NULL];
+    [fileHandle truncateFileAtOffset:size];
+    [fileHandle closeFile];
+}
+
+/**
+ * Measure the time needed to read a file and access all its pages
+ */
+- (void)measureReadsWithFileSize:(unsigned long long)fileSize readPolicy:(HLSFileReadPolicy)readPolicy
+{
+    NSString *rootFolderPath = [HLSStandardFileManagerTestCase rootFolderPath];
+    HLSStandardFileManager *fileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:rootFolderPath];
+    [self createFileAtPath:@"/file.bin" size:fileSize withFileManager:fileManager];
+    
+    [self measureBlock:^{
+        @autoreleasepool {
+            NSData *data = [fileManager contentsOfFileAtPath:@"/file.bin" readPolicy:readPolicy error:NULL];
+            XCTAssertEqual(data.length, fileSize);
+            
+            const uint8_t *bytes = data.bytes;
+            uint8_t sum = 0;
+            for (NSUInteger i = 0; i < data.length; i += 4096) {
+                sum += bytes[i];
+            }
+            XCTAssertEqual(sum, 0);
+        }
+    }];
+}
+
+/**
+ * Measure the time spent by the caller writing small JSON-like blobs, several times to the same files
+ */
+- (void)measureSmallWritesWithFileManager:(HLSStandardFileManager *)fileManager
+{
+    NSData *data = [@"{\"key\": \"value\"}" dataUsingEncoding:NSUTF8StringEncoding];
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000; ++i) {
+            NSString *path = [NSString stringWithFormat:@"/file%@.json", @(i % 100)];
+            [fileManager createFileAtPath:path contents:data error:NULL];
+        }
+    }];
+}
+
 @end
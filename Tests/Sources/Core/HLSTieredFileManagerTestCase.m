@@ -0,0 +1,174 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSFileManagerTestCase.h"
+
+@interface HLSTieredFileManagerTestCase : HLSFileManagerTestCase
+@end
+
+@implementation HLSTieredFileManagerTestCase
+
+#pragma mark Class methods
+
++ (NSString *)rootFolderPath
+{
+    return [HLSApplicationTemporaryDirectoryPath() stringByAppendingPathComponent:@"tieredFileManagerTests"];
+}
+
++ (HLSTieredFileManager *)tieredFileManager
+{
+    HLSStandardFileManager *diskFileManager = [[HLSStandardFileManager alloc] initWithRootFolderPath:[HLSTieredFileManagerTestCase rootFolderPath]];
+    return [[HLSTieredFileManager alloc] initWithDiskFileManager:diskFileManager];
+}
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    NSString *rootFolderPath = [HLSTieredFileManagerTestCase rootFolderPath];
+    if ([[NSFileManager defaultManager] fileExistsAtPath:rootFolderPath]) {
+        [[NSFileManager defaultManager] removeItemAtPath:rootFolderPath error:NULL];
+    }
+    [[NSFileManager defaultManager] createDirectoryAtPath:rootFolderPath withIntermediateDirectories:YES attributes:nil error:NULL];
+}
+
+#pragma mark Tests
+
+- (void)testCreationAndRemoval
+{
+    [self testCreationAndRemovalWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testContentsAndExistence
+{
+    [self testContentsAndExistenceWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testCopy
+{
+    [self testCopyWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testMove
+{
+    [self testMoveWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testEnumeration
+{
+    [self testEnumerationWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testRanges
+{
+    [self testRangesWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testStreams
+{
+    [self testStreamsWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testURLs
+{
+    [self testURLsWithFileManager:[HLSTieredFileManagerTestCase tieredFileManager]];
+}
+
+- (void)testWriteBackAndPromotion
+{
+    static const NSUInteger kFileCount = 100;
+    static const NSUInteger kFileSize = 1024;
+    
+    HLSTieredFileManager *fileManager = [HLSTieredFileManagerTestCase tieredFileManager];
+    fileManager.byteCostLimit = 10 * kFileSize;
+    
+    NSMutableArray<NSData *> *datas = [NSMutableArray array];
+    for (NSUInteger i = 0; i < kFileCount; ++i) {
+        NSMutableData *data = [NSMutableData dataWithLength:kFileSize];
+        arc4random_buf(data.mutableBytes, data.length);
+        [datas addObject:data];
+        
+        NSString *path = [NSString stringWithFormat:@"/file%@.bin", @(i)];
+        XCTAssertTrue([fileManager createFileAtPath:path contents:data error:NULL]);
+    }
+    
+    // Files which did not fit in memory have been written back to disk
+    XCTAssertTrue(fileManager.writeBackCount > 0);
+    XCTAssertEqual([fileManager contentsOfDirectoryAtPath:@"/" error:NULL].count, kFileCount);
+    
+    // Nothing is lost, whether the data is still in memory, currently being written or read from disk
+    [fileManager resetStatistics];
+    for (NSUInteger i = 0; i < kFileCount; ++i) {
+        NSString *path = [NSString stringWithFormat:@"/file%@.bin", @(i)];
+        XCTAssertEqualObjects([fileManager contentsOfFileAtPath:path error:NULL], datas[i]);
+    }
+    XCTAssertEqual(fileManager.hitCount + fileManager.missCount, kFileCount);
+    
+    // After a flush, all files are available from the disk tier
+    [fileManager flush];
+    for (NSUInteger i = 0; i < kFileCount; ++i) {
+        NSString *path = [NSString stringWithFormat:@"/file%@.bin", @(i)];
+        XCTAssertEqualObjects([fileManager.diskFileManager contentsOfFileAtPath:path error:NULL], datas[i]);
+    }
+    
+    // Files read from disk are promoted, and read from memory afterwards
+    XCTAssertTrue([fileManager removeItemAtPath:@"/" error:NULL]);
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager.diskFileManager createFileAtPath:@"/file.txt" contents:data error:NULL]);
+    
+    [fileManager resetStatistics];
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+    XCTAssertEqual(fileManager.missCount, (NSUInteger)1);
+    XCTAssertEqual(fileManager.promotionCount, (NSUInteger)1);
+    
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+    XCTAssertEqual(fileManager.hitCount, (NSUInteger)1);
+    XCTAssertEqual(fileManager.missCount, (NSUInteger)1);
+}
+
+- (void)testMemoryWarning
+{
+    HLSTieredFileManager *fileManager = [HLSTieredFileManagerTestCase tieredFileManager];
+    
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createDirectoryAtPath:@"/folder" withIntermediateDirectories:YES error:NULL]);
+    XCTAssertTrue([fileManager createFileAtPath:@"/folder/file.txt" contents:data error:NULL]);
+    XCTAssertFalse([fileManager.diskFileManager fileExistsAtPath:@"/folder/file.txt"]);
+    
+    // Data is spilled to disk instead of being lost
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    [fileManager flush];
+    
+    XCTAssertEqual(fileManager.writeBackCount, (NSUInteger)1);
+    XCTAssertEqualObjects([fileManager.diskFileManager contentsOfFileAtPath:@"/folder/file.txt" error:NULL], data);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/folder/file.txt" error:NULL], data);
+    XCTAssertEqual(fileManager.promotionCount, (NSUInteger)1);
+}
+
+- (void)testReadAfterMemoryWarning
+{
+    HLSTieredFileManager *fileManager = [HLSTieredFileManagerTestCase tieredFileManager];
+    
+    NSData *data = [@"data" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/file.txt" contents:data error:NULL]);
+    
+    // Data being spilled to disk must remain readable, without any flush
+    [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    XCTAssertTrue([fileManager fileExistsAtPath:@"/file.txt"]);
+    XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/file.txt" error:NULL], data);
+    
+    // Including when the memory tier is cleared from another thread
+    NSData *otherData = [@"otherData" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertTrue([fileManager createFileAtPath:@"/otherFile.txt" contents:otherData error:NULL]);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [[NSNotificationCenter defaultCenter] postNotificationName:UIApplicationDidReceiveMemoryWarningNotification object:nil];
+    });
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        XCTAssertEqualObjects([fileManager contentsOfFileAtPath:@"/otherFile.txt" error:NULL], otherData);
+    }
+}
+
+@end
@@ -0,0 +1,189 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoconutKit/CoconutKit.h>
+#import <XCTest/XCTest.h>
+#import <pthread.h>
+
+static void *HLSTracingTestThreadMain(void *context)
+{
+    HLSTraceCounter("HLSTracingTestCase.thread", (intptr_t)context);
+    return NULL;
+}
+
+@interface HLSTracingTestCase : XCTestCase
+
+@end
+
+@implementation HLSTracingTestCase
+
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    HLSTracingReset();
+}
+
+- (void)tearDown
+{
+    HLSTracingSetEnabled(NO);
+    HLSTracingReset();
+}
+
+#pragma mark Helpers
+
+- (NSArray<NSDictionary *> *)tracedEventsWithName:(NSString *)name
+{
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:HLSTracingChromeTraceData() options:0 error:NULL];
+    XCTAssertNotNil(trace);
+
+    NSPredicate *predicate = [NSPredicate predicateWithFormat:@"name == %@", name];
+    return [trace[@"traceEvents"] filteredArrayUsingPredicate:predicate];
+}
+
+// Run threads one after the other, each recording a single event. Optionally export events after each thread exits
+- (void)recordEventsOnThreadCount:(NSUInteger)threadCount exporting:(BOOL)exporting
+{
+    for (NSUInteger i = 0; i < threadCount; ++i) {
+        pthread_t thread;
+        XCTAssertEqual(pthread_create(&thread, NULL, HLSTracingTestThreadMain, (void *)(intptr_t)i), 0);
+        pthread_join(thread, NULL);
+
+        if (exporting) {
+            XCTAssertNotEqual([self tracedEventsWithName:@"HLSTracingTestCase.thread"].count, (NSUInteger)0);
+        }
+    }
+}
+
+#pragma mark Tests
+
+- (void)testIntervals
+{
+    HLSTracingSetEnabled(YES);
+
+    dispatch_apply(4, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        for (NSUInteger j = 0; j < 100; ++j) {
+            HLSTraceInterval("HLSTracingTestCase.interval");
+        }
+    });
+
+    // Intervals are properly nested on each thread, with increasing timestamps
+    NSArray<NSDictionary *> *events = [self tracedEventsWithName:@"HLSTracingTestCase.interval"];
+    XCTAssertEqual(events.count, (NSUInteger)800);
+
+    NSMutableDictionary<NSNumber *, NSDictionary *> *lastEvents = [NSMutableDictionary dictionary];
+    for (NSDictionary *event in events) {
+        NSDictionary *lastEvent = lastEvents[event[@"tid"]];
+        XCTAssertEqualObjects(event[@"ph"], [lastEvent[@"ph"] isEqualToString:@"B"] ? @"E" : @"B");
+        XCTAssertGreaterThanOrEqual([event[@"ts"] doubleValue], [lastEvent[@"ts"] doubleValue]);
+        lastEvents[event[@"tid"]] = event;
+    }
+}
+
+- (void)testAsyncIntervalsAndCounters
+{
+    HLSTracingSetEnabled(YES);
+
+    NSObject *object = [[NSObject alloc] init];
+    HLSTraceAsyncBegin("HLSTracingTestCase.async", object);
+    HLSTraceCounter("HLSTracingTestCase.counter", 42);
+    HLSTraceAsyncEnd("HLSTracingTestCase.async", object);
+
+    NSArray<NSDictionary *> *asyncEvents = [self tracedEventsWithName:@"HLSTracingTestCase.async"];
+    XCTAssertEqual(asyncEvents.count, (NSUInteger)2);
+    XCTAssertEqualObjects(asyncEvents.firstObject[@"ph"], @"b");
+    XCTAssertEqualObjects(asyncEvents.lastObject[@"ph"], @"e");
+    XCTAssertEqualObjects(asyncEvents.firstObject[@"id"], asyncEvents.lastObject[@"id"]);
+
+    NSArray<NSDictionary *> *counterEvents = [self tracedEventsWithName:@"HLSTracingTestCase.counter"];
+    XCTAssertEqual(counterEvents.count, (NSUInteger)1);
+    XCTAssertEqualObjects(counterEvents.firstObject[@"args"][@"value"], @42);
+}
+
+- (void)testDisabledAndReset
+{
+    HLSTraceBegin("HLSTracingTestCase.disabled");
+    HLSTraceEnd("HLSTracingTestCase.disabled");
+    XCTAssertEqual([self tracedEventsWithName:@"HLSTracingTestCase.disabled"].count, (NSUInteger)0);
+
+    HLSTracingSetEnabled(YES);
+    HLSTraceCounter("HLSTracingTestCase.reset", 1);
+    XCTAssertEqual([self tracedEventsWithName:@"HLSTracingTestCase.reset"].count, (NSUInteger)1);
+
+    HLSTracingReset();
+    XCTAssertEqual([self tracedEventsWithName:@"HLSTracingTestCase.reset"].count, (NSUInteger)0);
+}
+
+- (void)testFullBuffer
+{
+    HLSTracingSetEnabled(YES);
+
+    // Events are dropped, not recorded over older ones
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        HLSTraceCounter("HLSTracingTestCase.full", i);
+    }
+    NSArray<NSDictionary *> *events = [self tracedEventsWithName:@"HLSTracingTestCase.full"];
+    XCTAssertEqual(events.count + HLSTracingDroppedEventCount(), (NSUInteger)10000);
+    XCTAssertEqualObjects(events.firstObject[@"args"][@"value"], @0);
+}
+
+- (void)testChromeTraceFile
+{
+    HLSTracingSetEnabled(YES);
+    HLSTraceCounter("HLSTracingTestCase.file", 1);
+
+    NSString *filePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue(HLSTracingWriteChromeTraceToFile(filePath, NULL));
+
+    NSDictionary *trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:filePath] options:0 error:NULL];
+    XCTAssertNotNil(trace[@"traceEvents"]);
+
+    [[NSFileManager defaultManager] removeItemAtPath:filePath error:NULL];
+}
+
+- (void)testBufferCount
+{
+    HLSTracingSetEnabled(YES);
+
+    // Buffers of exited threads are not reused until exported, and the number of buffers is bounded
+    [self recordEventsOnThreadCount:200 exporting:NO];
+    XCTAssertGreaterThan(HLSTracingDroppedEventCount(), (NSUInteger)0);
+    XCTAssertLessThan([self tracedEventsWithName:@"HLSTracingTestCase.thread"].count, (NSUInteger)200);
+}
+
+- (void)testBufferReuseAfterExport
+{
+    HLSTracingSetEnabled(YES);
+
+    // Buffers of exited threads are reused once exported, so that no event is dropped
+    [self recordEventsOnThreadCount:200 exporting:YES];
+    XCTAssertEqual(HLSTracingDroppedEventCount(), (NSUInteger)0);
+}
+
+#pragma mark Benchmarks
+
+- (void)testDisabledTracingPerformance
+{
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 1000000; ++i) {
+            HLSTraceInterval("HLSTracingTestCase.performance");
+        }
+    }];
+}
+
+- (void)testEnabledTracingPerformance
+{
+    HLSTracingSetEnabled(YES);
+
+    [self measureBlock:^{
+        HLSTracingReset();
+        for (NSUInteger i = 0; i < 4000; ++i) {
+            HLSTraceInterval("HLSTracingTestCase.performance");
+        }
+    }];
+}
+
+@end
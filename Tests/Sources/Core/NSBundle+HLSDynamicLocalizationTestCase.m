@@ -9,10 +9,50 @@
 #import <XCTest/XCTest.h>
 
 @interface NSBundle_HLSDynamicLocalizationTestCase : XCTestCase
+
+@property (nonatomic, copy) NSString *originalLocalization;
+@property (nonatomic, copy) NSString *bundlePath;
+
 @end
 
 @implementation NSBundle_HLSDynamicLocalizationTestCase
 
+#pragma mark Setup and teardown
+
+- (void)setUp
+{
+    self.originalLocalization = [NSBundle localization];
+    self.bundlePath = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.bundle", [NSUUID UUID].UUIDString]];
+}
+
+- (void)tearDown
+{
+    [NSBundle setLocalization:self.originalLocalization];
+    [[NSFileManager defaultManager] removeItemAtPath:self.bundlePath error:NULL];
+}
+
+#pragma mark Helpers
+
+- (NSBundle *)bundleWithStringsTables:(NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *)stringsTables
+{
+    return [self bundleWithStringsTables:stringsTables names:@[@"Localizable"]];
+}
+
+- (NSBundle *)bundleWithStringsTables:(NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *)stringsTables names:(NSArray<NSString *> *)names
+{
+    [stringsTables enumerateKeysAndObjectsUsingBlock:^(NSString *localization, NSDictionary<NSString *, NSString *> *stringsTable, BOOL *stop) {
+        NSString *lprojPath = [self.bundlePath stringByAppendingPathComponent:[localization stringByAppendingPathExtension:@"lproj"]];
+        XCTAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath:lprojPath withIntermediateDirectories:YES attributes:nil error:NULL]);
+        for (NSString *name in names) {
+            NSString *stringsFileName = [name stringByAppendingPathExtension:@"strings"];
+            XCTAssertTrue([stringsTable writeToFile:[lprojPath stringByAppendingPathComponent:stringsFileName] atomically:YES]);
+        }
+    }];
+    return [NSBundle bundleWithPath:self.bundlePath];
+}
+
+#pragma mark Tests
+
 - (void)testLanguageForLocalization
 {
     XCTAssertEqualObjects(HLSLanguageForLocalization(@"de"), @"Deutsch");
@@ -25,4 +65,86 @@
     XCTAssertEqualObjects(HLSLocalizedDescriptionForCFNetworkError(123456), HLSMissingLocalization);
 }
 
+- (void)testLocalizationChange
+{
+    NSBundle *bundle = [self bundleWithStringsTables:@{ @"en" : @{ @"Hello" : @"Hello" },
+                                                        @"fr" : @{ @"Hello" : @"Bonjour" } }];
+
+    [NSBundle setLocalization:@"en"];
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:nil table:nil], @"Hello");
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Missing" value:@"Default" table:nil], @"Default");
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:nil table:@"MissingTable"], @"Hello");
+
+    // Cached tables must not be used anymore
+    [NSBundle setLocalization:@"fr"];
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:nil table:nil], @"Bonjour");
+
+    // Unsupported localization
+    [NSBundle setLocalization:@"de"];
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:@"Default" table:nil], @"Default");
+}
+
+- (void)testModifiedStringsFile
+{
+    NSBundle *bundle = [self bundleWithStringsTables:@{ @"en" : @{ @"Hello" : @"Hello" },
+                                                        @"fr" : @{ @"Hello" : @"Bonjour" } }];
+
+    [NSBundle setLocalization:@"en"];
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:nil table:nil], @"Hello");
+
+    // Compiled tables must be updated
+    [self bundleWithStringsTables:@{ @"en" : @{ @"Hello" : @"Hello, world" } }];
+    [NSBundle setLocalization:@"fr"];
+    [NSBundle setLocalization:@"en"];
+    XCTAssertEqualObjects([bundle localizedStringForKey:@"Hello" value:nil table:nil], @"Hello, world");
+}
+
+#pragma mark Benchmarks
+
+- (void)testLocalizedStringLookupPerformance
+{
+    NSMutableDictionary<NSString *, NSString *> *stringsTable = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 10000; ++i) {
+        stringsTable[[NSString stringWithFormat:@"Key %@", @(i)]] = [NSString stringWithFormat:@"Value %@", @(i)];
+    }
+    NSBundle *bundle = [self bundleWithStringsTables:@{ @"en" : stringsTable }];
+    [NSBundle setLocalization:@"en"];
+
+    [self measureBlock:^{
+        for (NSUInteger i = 0; i < 10000; ++i) {
+            @autoreleasepool {
+                NSString *key = [NSString stringWithFormat:@"Key %@", @(i)];
+                XCTAssertNotEqualObjects([bundle localizedStringForKey:key value:nil table:nil], key);
+            }
+        }
+    }];
+}
+
+- (void)testLocalizationSwitchPerformance
+{
+    NSMutableArray<NSString *> *names = [NSMutableArray array];
+    for (NSUInteger i = 0; i < 30; ++i) {
+        [names addObject:[NSString stringWithFormat:@"Table%@", @(i)]];
+    }
+
+    NSMutableDictionary<NSString *, NSString *> *englishStringsTable = [NSMutableDictionary dictionary];
+    NSMutableDictionary<NSString *, NSString *> *frenchStringsTable = [NSMutableDictionary dictionary];
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        NSString *key = [NSString stringWithFormat:@"Key %@", @(i)];
+        englishStringsTable[key] = [NSString stringWithFormat:@"Value %@", @(i)];
+        frenchStringsTable[key] = [NSString stringWithFormat:@"Valeur %@", @(i)];
+    }
+    NSBundle *bundle = [self bundleWithStringsTables:@{ @"en" : englishStringsTable, @"fr" : frenchStringsTable } names:names];
+
+    // Switch languages and look up one string in each table, as a screen being relocalized does
+    [self measureBlock:^{
+        for (NSString *localization in @[@"en", @"fr", @"en", @"fr"]) {
+            [NSBundle setLocalization:localization];
+            for (NSString *name in names) {
+                XCTAssertNotEqualObjects([bundle localizedStringForKey:@"Key 500" value:nil table:name], @"Key 500");
+            }
+        }
+    }];
+}
+
 @end
@@ -0,0 +1,210 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import <CoconutKit/CoconutKit.h>
+#import <XCTest/XCTest.h>
+
+// Bundles are looked up by name in the Library directory, among others
+static NSString * const HLSDynamicLocalizationTestBundleName = @"HLSDynamicLocalizationTestCase.bundle";
+static NSString * const HLSDynamicLocalizationTestOtherBundleName = @"HLSDynamicLocalizationTestCaseOther.bundle";
+
+@interface UILabel_HLSDynamicLocalizationTestCase : XCTestCase
+
+@property (nonatomic, copy) NSString *originalLocalization;
+
+@end
+
+@implementation UILabel_HLSDynamicLocalizationTestCase
+
+#pragma mark Class methods
+
++ (NSString *)bundlePathWithName:(NSString *)name
+{
+    return [HLSApplicationLibraryDirectoryPath() stringByAppendingPathComponent:name];
+}
+
+// Tables are given by localization, then by name
++ (void)createBundleWithName:(NSString *)name stringsTables:(NSDictionary<NSString *, NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *> *)stringsTables
+{
+    NSString *bundlePath = [self bundlePathWithName:name];
+    [stringsTables enumerateKeysAndObjectsUsingBlock:^(NSString *localization, NSDictionary<NSString *, NSDictionary<NSString *, NSString *> *> *namedStringsTables, BOOL *pStop) {
+        NSString *lprojPath = [bundlePath stringByAppendingPathComponent:[localization stringByAppendingPathExtension:@"lproj"]];
+        [[NSFileManager defaultManager] createDirectoryAtPath:lprojPath withIntermediateDirectories:YES attributes:nil error:NULL];
+        [namedStringsTables enumerateKeysAndObjectsUsingBlock:^(NSString *tableName, NSDictionary<NSString *, NSString *> *stringsTable, BOOL *pStop) {
+            [stringsTable writeToFile:[lprojPath stringByAppendingPathComponent:[tableName stringByAppendingPathExtension:@"strings"]] atomically:YES];
+        }];
+    }];
+}
+
+#pragma mark Setup and teardown
+
++ (void)setUp
+{
+    [super setUp];
+
+    // The same key has different values in each table and bundle
+    [self createBundleWithName:HLSDynamicLocalizationTestBundleName stringsTables:@{ @"en" : @{ @"Table" : @{ @"Greeting" : @"Hello" },
+                                                                                                   @"OtherTable" : @{ @"Greeting" : @"Hi" } },
+                                                                                       @"fr" : @{ @"Table" : @{ @"Greeting" : @"Bonjour" },
+                                                                                                  @"OtherTable" : @{ @"Greeting" : @"Salut" } } }];
+    [self createBundleWithName:HLSDynamicLocalizationTestOtherBundleName stringsTables:@{ @"en" : @{ @"Table" : @{ @"Greeting" : @"Howdy" } },
+                                                                                            @"fr" : @{ @"Table" : @{ @"Greeting" : @"Coucou" } } }];
+}
+
++ (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:[self bundlePathWithName:HLSDynamicLocalizationTestBundleName] error:NULL];
+    [[NSFileManager defaultManager] removeItemAtPath:[self bundlePathWithName:HLSDynamicLocalizationTestOtherBundleName] error:NULL];
+
+    [super tearDown];
+}
+
+- (void)setUp
+{
+    self.originalLocalization = [NSBundle localization];
+    [NSBundle setLocalization:@"en"];
+}
+
+- (void)tearDown
+{
+    [NSBundle setLocalization:self.originalLocalization];
+}
+
+#pragma mark Helpers
+
+// Return the root of a chain of nested views, which has localization settings. The root must be kept alive
+- (UIView *)rootViewOfHierarchyWithDepth:(NSUInteger)depth
+{
+    UIView *rootView = [[UIView alloc] init];
+    [rootView setValue:@"Table" forKey:@"locTable"];
+    [rootView setValue:HLSDynamicLocalizationTestBundleName forKey:@"locBundle"];
+
+    UIView *view = rootView;
+    for (NSUInteger i = 0; i < depth; ++i) {
+        UIView *subview = [[UIView alloc] init];
+        [view addSubview:subview];
+        view = subview;
+    }
+    return rootView;
+}
+
+- (UIView *)deepestViewInView:(UIView *)view
+{
+    while (view.subviews.count != 0) {
+        view = view.subviews.firstObject;
+    }
+    return view;
+}
+
+- (UILabel *)labelInView:(UIView *)view
+{
+    UILabel *label = [[UILabel alloc] init];
+    [view addSubview:label];
+    label.text = @"LS/Greeting";
+    return label;
+}
+
+- (UILabel *)localizedLabel
+{
+    UILabel *label = [[UILabel alloc] init];
+    [label setValue:@"Table" forKey:@"locTable"];
+    [label setValue:HLSDynamicLocalizationTestBundleName forKey:@"locBundle"];
+    label.text = @"LS/Greeting";
+    return label;
+}
+
+#pragma mark Tests
+
+- (void)testLocalizationSettingsChange
+{
+    UIView *rootView = [self rootViewOfHierarchyWithDepth:10];
+    UIView *view = [self deepestViewInView:rootView];
+    XCTAssertEqualObjects([self labelInView:view].text, @"Hello");
+
+    // Settings resolved before must not be used once changed
+    [view.superview setValue:@"OtherTable" forKey:@"locTable"];
+    XCTAssertEqualObjects([self labelInView:view].text, @"Hi");
+
+    [view.superview setValue:@"Table" forKey:@"locTable"];
+    [view.superview setValue:HLSDynamicLocalizationTestOtherBundleName forKey:@"locBundle"];
+    XCTAssertEqualObjects([self labelInView:view].text, @"Howdy");
+}
+
+- (void)testViewHierarchyChange
+{
+    UIView *rootView = [self rootViewOfHierarchyWithDepth:10];
+    UIView *view = [self deepestViewInView:rootView];
+    XCTAssertEqualObjects([self labelInView:view].text, @"Hello");
+
+    UIView *otherRootView = [[UIView alloc] init];
+    [otherRootView setValue:@"OtherTable" forKey:@"locTable"];
+    [otherRootView setValue:HLSDynamicLocalizationTestBundleName forKey:@"locBundle"];
+
+    // Settings resolved before must not be used once a label has been moved with its ancestors into another hierarchy
+    UILabel *label = [[UILabel alloc] init];
+    [view addSubview:label];
+    [otherRootView addSubview:view.superview];
+    label.text = @"LS/Greeting";
+    XCTAssertEqualObjects(label.text, @"Hi");
+}
+
+- (void)testLocalizationChangeWithDisplayedLabel
+{
+    UIWindow *window = [[UIWindow alloc] initWithFrame:CGRectMake(0.f, 0.f, 320.f, 480.f)];
+    UILabel *label = [self localizedLabel];
+    [window addSubview:label];
+    XCTAssertEqualObjects(label.text, @"Hello");
+
+    // Displayed labels are updated immediately
+    [NSBundle setLocalization:@"fr"];
+    XCTAssertEqualObjects(label.text, @"Bonjour");
+
+    // And not again when they reappear
+    [label removeFromSuperview];
+    [window addSubview:label];
+    XCTAssertEqualObjects(label.text, @"Bonjour");
+}
+
+- (void)testLocalizationChangeWithHiddenLabel
+{
+    UIWindow *window = [[UIWindow alloc] initWithFrame:CGRectMake(0.f, 0.f, 320.f, 480.f)];
+    UILabel *label = [self localizedLabel];
+    XCTAssertEqualObjects(label.text, @"Hello");
+
+    // Labels which are not displayed are not updated, however many times the localization changes
+    [NSBundle setLocalization:@"fr"];
+    XCTAssertEqualObjects(label.text, @"Hello");
+    [NSBundle setLocalization:@"en"];
+    [NSBundle setLocalization:@"fr"];
+    XCTAssertEqualObjects(label.text, @"Hello");
+
+    // They are updated once when they appear, with the current localization
+    [window addSubview:label];
+    XCTAssertEqualObjects(label.text, @"Bonjour");
+
+    // Labels removed from display before a localization change are updated when they appear again
+    [label removeFromSuperview];
+    [NSBundle setLocalization:@"en"];
+    XCTAssertEqualObjects(label.text, @"Bonjour");
+    [window addSubview:label];
+    XCTAssertEqualObjects(label.text, @"Hello");
+}
+
+#pragma mark Benchmarks
+
+- (void)testDeepHierarchyLocalizationPerformance
+{
+    // Localizing N labels at the bottom of a deep hierarchy must not visit the whole hierarchy N times
+    [self measureBlock:^{
+        UIView *rootView = [self rootViewOfHierarchyWithDepth:500];
+        UIView *view = [self deepestViewInView:rootView];
+        for (NSUInteger i = 0; i < 2000; ++i) {
+            [self labelInView:view];
+        }
+    }];
+}
+
+@end
@@ -0,0 +1,37 @@
+//
+//  Copyright (c) Samuel Défago. All rights reserved.
+//
+//  License information is available from the LICENSE file.
+//
+
+#import "HLSLoggerDecoder.h"
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Decode HLSLogger binary log files to the standard output, e.g. after having retrieved them from a device:
+ *   HLSLoggerDecoder MyApp_1-0_20170101_120000.hlslog > MyApp.txt
+ */
+int main(int argc, const char *argv[])
+{
+    @autoreleasepool {
+        if (argc < 2) {
+            fprintf(stderr, "usage: %s file.%s [...]\n", getprogname(), HLSLoggerBinaryLogFileExtension.UTF8String);
+            return EXIT_FAILURE;
+        }
+
+        int status = EXIT_SUCCESS;
+        for (int i = 1; i < argc; ++i) {
+            NSString *filePath = @(argv[i]);
+            NSError *error = nil;
+            BOOL decoded = HLSLoggerDecodeBinaryLogFile(filePath, ^(NSString *line, BOOL *pStop) {
+                puts(line.UTF8String);
+            }, &error);
+            if (! decoded) {
+                fprintf(stderr, "%s: %s\n", argv[i], error.localizedDescription.UTF8String);
+                status = EXIT_FAILURE;
+            }
+        }
+        return status;
+    }
+}